@@ -0,0 +1,575 @@
+/**
+ * Micro-benchmarks for the public big integer operations. Every operation is
+ * timed on pseudo-random operands whose sizes grow by a factor of ten up to a
+ * maximum number of bits, and the results are written to standard output as
+ * CSV or as JSON with one object per line. The digit width is the one the
+ * program was compiled with; "bench.sh" builds and runs the benchmarks for
+ * every supported width.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bigint.h"
+
+/**
+ * Number of bits by which values are shifted in the shift benchmarks. This is
+ * deliberately not a multiple of any digit width.
+ */
+#define SHIFT_BITS 13
+
+/**
+ * Exponent used by the exponentiation benchmark. The base has this many
+ * times fewer bits than the other operands, so the result is about as large
+ * as them.
+ */
+#define POW_EXPONENT 16
+
+/**
+ * Operands shared by the benchmarks of one operand size.
+ */
+typedef struct {
+    /**
+     * A value with the full number of bits.
+     */
+    bigint_st *a;
+    /**
+     * A second value with the full number of bits.
+     */
+    bigint_st *b;
+    /**
+     * A value with half the number of bits used as a divisor.
+     */
+    bigint_st *half;
+    /**
+     * The multiple of "half" nearest to "a" in the direction of zero, used as
+     * a dividend that it divides exactly.
+     */
+    bigint_st *multiple;
+    /**
+     * Base of the exponentiation benchmark.
+     */
+    bigint_st *root;
+    /**
+     * Exponent of the exponentiation benchmark.
+     */
+    bigint_st *exponent;
+    /**
+     * Destination of most operations.
+     */
+    bigint_st *dest;
+    /**
+     * Destination of remainders.
+     */
+    bigint_st *remainder;
+    /**
+     * Decimal representation of "a".
+     */
+    char *decimal;
+} operands_st;
+
+/**
+ * A benchmarked operation.
+ */
+typedef struct {
+    /**
+     * Name used to select the operation and to label its results.
+     */
+    const char *name;
+    /**
+     * Function that performs the operation once. It returns 0 if the
+     * operation succeeds and -1 otherwise.
+     */
+    int (*run)(operands_st *);
+} operation_st;
+
+/**
+ * Settings parsed from the command line.
+ */
+typedef struct {
+    /**
+     * Value that indicates whether JSON is written instead of CSV.
+     */
+    bool json;
+    /**
+     * Largest operand size in bits.
+     */
+    size_t max_bits;
+    /**
+     * Minimum number of seconds spent timing each operation and size.
+     */
+    double min_time;
+    /**
+     * Number of seconds after which a single call is considered too slow for
+     * an operation to be timed at larger sizes.
+     */
+    double cutoff;
+} settings_st;
+
+static int run_add(operands_st *o)
+{
+    return bigint_add(o->dest, o->a, o->b) ? 0 : -1;
+}
+
+static int run_sub(operands_st *o)
+{
+    return bigint_sub(o->dest, o->a, o->b) ? 0 : -1;
+}
+
+static int run_mul(operands_st *o)
+{
+    return bigint_mul(o->dest, o->a, o->b) ? 0 : -1;
+}
+
+static int run_addmul(operands_st *o)
+{
+    return bigint_addmul(o->dest, o->a, o->b) ? 0 : -1;
+}
+
+static int run_div(operands_st *o)
+{
+    return bigint_div(o->dest, &o->remainder, o->a, o->half) ? 0 : -1;
+}
+
+static int run_divexact(operands_st *o)
+{
+    return bigint_divexact(o->dest, o->multiple, o->half) ? 0 : -1;
+}
+
+static int run_mod(operands_st *o)
+{
+    return bigint_mod(o->remainder, o->a, o->half) ? 0 : -1;
+}
+
+static int run_pow(operands_st *o)
+{
+    return bigint_pow(o->dest, o->root, o->exponent) ? 0 : -1;
+}
+
+static int run_gcd(operands_st *o)
+{
+    return bigint_gcd(o->dest, o->a, o->b) ? 0 : -1;
+}
+
+static int run_shli(operands_st *o)
+{
+    return bigint_shli(o->dest, o->a, SHIFT_BITS) ? 0 : -1;
+}
+
+static int run_shri(operands_st *o)
+{
+    return bigint_shri(o->dest, o->a, SHIFT_BITS) ? 0 : -1;
+}
+
+static int run_strtobi(operands_st *o)
+{
+    bigint_st *x = bigint_strtobi(o->decimal);
+
+    if (!x) {
+        return -1;
+    }
+
+    bigint_free(x);
+    return 0;
+}
+
+static int run_tostr(operands_st *o)
+{
+    char *str = bigint_tostr(o->a);
+
+    if (!str) {
+        return -1;
+    }
+
+    free(str);
+    return 0;
+}
+
+/**
+ * Operations in the order they are benchmarked.
+ */
+static const operation_st operations[] = {
+    {"add", run_add},
+    {"sub", run_sub},
+    {"mul", run_mul},
+    {"addmul", run_addmul},
+    {"div", run_div},
+    {"divexact", run_divexact},
+    {"mod", run_mod},
+    {"pow", run_pow},
+    {"gcd", run_gcd},
+    {"shli", run_shli},
+    {"shri", run_shri},
+    {"strtobi", run_strtobi},
+    {"tostr", run_tostr},
+};
+
+#define OPERATION_COUNT (sizeof(operations) / sizeof(operations[0]))
+
+/**
+ * Get the value of a monotonic clock.
+ *
+ * Return: The time in seconds.
+ */
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+/**
+ * Generate the next value of a xorshift pseudo-random number generator. The
+ * benchmarks use a fixed seed so runs are comparable.
+ *
+ * Arguments:
+ * - state: The state of the generator which must not be 0.
+ *
+ * Return: A pseudo-random number.
+ */
+static uint64_t next_random(uint64_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+ * Create a pseudo-random big integer with an exact number of bits.
+ *
+ * Arguments:
+ * - bits: The number of bits which must be at least 1.
+ * - state: The state of the pseudo-random number generator.
+ *
+ * Return: The new big integer or NULL if it could not be created.
+ */
+static bigint_st *random_value(size_t bits, uint64_t *state)
+{
+    char *hex;
+    bigint_st *x;
+
+    size_t length = (bits + 3) / 4;
+    unsigned top = (unsigned) (bits - 1) % 4;
+
+    if (!(hex = malloc(length + 1))) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        hex[i] = "0123456789abcdef"[next_random(state) & 15];
+    }
+
+    // The most significant numeral has its highest bit set so the value has
+    // exactly the requested number of bits.
+    hex[0] = "0123456789abcdef"[
+        (1u << top) | (unsigned) (next_random(state) & ((1u << top) - 1))
+    ];
+    hex[length] = '\0';
+
+    x = bigint_strtobib(hex, 16);
+    free(hex);
+    return x;
+}
+
+/**
+ * Release the operands of one operand size.
+ *
+ * Arguments:
+ * - o: The operands. Members that are NULL are ignored.
+ */
+static void free_operands(operands_st *o)
+{
+    bigint_st **values[] = {
+        &o->a, &o->b, &o->half, &o->multiple, &o->root, &o->exponent,
+        &o->dest, &o->remainder,
+    };
+
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        if (*values[i]) {
+            bigint_free(*values[i]);
+            *values[i] = NULL;
+        }
+    }
+
+    free(o->decimal);
+    o->decimal = NULL;
+}
+
+/**
+ * Create the operands of one operand size.
+ *
+ * Arguments:
+ * - o: Output pointer for the operands.
+ * - bits: The operand size in bits.
+ * - state: The state of the pseudo-random number generator.
+ *
+ * Return: 0 if the operation succeeds and -1 if it fails.
+ */
+static int make_operands(operands_st *o, size_t bits, uint64_t *state)
+{
+    memset(o, 0, sizeof(*o));
+
+    if (
+        !(o->a = random_value(bits, state)) ||
+        !(o->b = random_value(bits, state)) ||
+        !(o->half = random_value(bits > 1 ? bits / 2 : 1, state)) ||
+        !(o->remainder = bigint_mod(NULL, o->a, o->half)) ||
+        !(o->multiple = bigint_sub(NULL, o->a, o->remainder)) ||
+        !(o->root = random_value(
+            bits > POW_EXPONENT ? bits / POW_EXPONENT : 1, state
+        )) ||
+        !(o->exponent = bigint_from_int(POW_EXPONENT)) ||
+        !(o->dest = bigint_from_int(0)) ||
+        !(o->decimal = bigint_tostr(o->a))
+    ) {
+        free_operands(o);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Time an operation. The operation is run in batches that double in size
+ * until the total time reaches the minimum.
+ *
+ * Arguments:
+ * - seconds: Output pointer for the total time spent.
+ * - iterations: Output pointer for the number of times the operation ran.
+ * - operation: The operation.
+ * - o: The operands.
+ * - min_time: The minimum time in seconds.
+ *
+ * Return: 0 if the operation succeeds and -1 if it fails.
+ */
+static int measure(
+    double *seconds,
+    size_t *iterations,
+    const operation_st *operation,
+    operands_st *o,
+    double min_time
+)
+{
+    double start;
+
+    size_t batch = 1;
+
+    *seconds = 0;
+    *iterations = 0;
+
+    while (*seconds < min_time) {
+        start = now();
+
+        for (size_t i = 0; i < batch; i++) {
+            if (operation->run(o)) {
+                return -1;
+            }
+        }
+
+        *seconds += now() - start;
+        *iterations += batch;
+        batch *= 2;
+    }
+
+    return 0;
+}
+
+/**
+ * Write one result.
+ *
+ * Arguments:
+ * - settings: The settings which determine the format.
+ * - name: Name of the operation.
+ * - bits: The operand size in bits.
+ * - iterations: Number of times the operation ran.
+ * - seconds: Total time spent.
+ */
+static void report(
+    const settings_st *settings,
+    const char *name,
+    size_t bits,
+    size_t iterations,
+    double seconds
+)
+{
+    size_t digits = (bits + DIGIT_WIDTH - 1) / DIGIT_WIDTH;
+    double ns_per_op = seconds * 1e9 / (double) iterations;
+    double digits_per_s = (double) digits * 1e9 / ns_per_op;
+
+    if (settings->json) {
+        printf(
+            "{\"width\": %d, \"op\": \"%s\", \"bits\": %zu, \"digits\": %zu, "
+            "\"iterations\": %zu, \"ns_per_op\": %.1f, "
+            "\"digits_per_s\": %.1f}\n",
+            DIGIT_WIDTH, name, bits, digits, iterations, ns_per_op,
+            digits_per_s
+        );
+    } else {
+        printf(
+            "%d,%s,%zu,%zu,%zu,%.1f,%.1f\n",
+            DIGIT_WIDTH, name, bits, digits, iterations, ns_per_op,
+            digits_per_s
+        );
+    }
+
+    fflush(stdout);
+}
+
+/**
+ * Determine whether an operation was selected on the command line.
+ *
+ * Arguments:
+ * - name: Name of the operation.
+ * - argc: Number of operation names.
+ * - argv: Operation names. No names selects every operation.
+ *
+ * Return: Value indicating whether the operation is selected.
+ */
+static bool selected(const char *name, int argc, char **argv)
+{
+    for (int i = 0; i < argc; i++) {
+        if (!strcmp(name, argv[i])) {
+            return true;
+        }
+    }
+
+    return argc == 0;
+}
+
+static void usage(FILE *stream, const char *self)
+{
+    fprintf(
+        stream,
+        "Usage: %s [-j] [-m MAX_BITS] [-t MIN_TIME] [-c CUTOFF] [-p THREADS]\n"
+        "       [OP...]\n"
+        "\n"
+        "Time big integer operations on operands of 1, 10, 100... bits.\n"
+        "\n"
+        "  -j           Write JSON with one object per line instead of CSV.\n"
+        "  -m MAX_BITS  Largest operand size in bits. Default: 10000000.\n"
+        "  -t MIN_TIME  Seconds spent timing each operation and size.\n"
+        "               Default: 0.1.\n"
+        "  -c CUTOFF    Stop timing an operation at larger sizes once a\n"
+        "               single call takes longer than this many seconds.\n"
+        "               Default: 0.25.\n"
+        "  -p THREADS   Threads that may work on a single multiplication.\n"
+        "               Default: 1.\n"
+        "  OP           Only time the named operations.\n",
+        self
+    );
+}
+
+int main(int argc, char **argv)
+{
+    size_t iterations;
+    int option;
+    operands_st operands;
+    double seconds;
+
+    bool stopped[OPERATION_COUNT] = {false};
+    settings_st settings = {false, 10000000, 0.1, 0.25};
+    uint64_t state = 0x9e3779b97f4a7c15u;
+    unsigned threads = 1;
+
+    while ((option = getopt(argc, argv, "hjm:t:c:p:")) != -1) {
+        switch (option) {
+          case 'h':
+            usage(stdout, argv[0]);
+            return 0;
+
+          case 'j':
+            settings.json = true;
+            break;
+
+          case 'm':
+            settings.max_bits = strtoul(optarg, NULL, 10);
+            break;
+
+          case 't':
+            settings.min_time = strtod(optarg, NULL);
+            break;
+
+          case 'c':
+            settings.cutoff = strtod(optarg, NULL);
+            break;
+
+          case 'p':
+            threads = (unsigned) strtoul(optarg, NULL, 10);
+            break;
+
+          default:
+            usage(stderr, argv[0]);
+            return 1;
+        }
+    }
+
+    for (int i = optind; i < argc; i++) {
+        bool known = false;
+
+        for (size_t k = 0; k < OPERATION_COUNT; k++) {
+            known |= !strcmp(argv[i], operations[k].name);
+        }
+
+        if (!known) {
+            fprintf(stderr, "%s: unknown operation: %s\n", argv[0], argv[i]);
+            return 1;
+        }
+    }
+
+    if (bigint_init() || bigint_set_threads(threads)) {
+        perror(argv[0]);
+        return 1;
+    }
+
+    if (!settings.json) {
+        puts("width,op,bits,digits,iterations,ns_per_op,digits_per_s");
+    }
+
+    for (size_t bits = 1; bits <= settings.max_bits; bits *= 10) {
+        if (make_operands(&operands, bits, &state)) {
+            perror(argv[0]);
+            return 1;
+        }
+
+        for (size_t k = 0; k < OPERATION_COUNT; k++) {
+            const operation_st *operation = &operations[k];
+
+            if (
+                stopped[k] ||
+                !selected(operation->name, argc - optind, argv + optind)
+            ) {
+                continue;
+            }
+
+            errno = 0;
+
+            if (measure(
+                &seconds, &iterations, operation, &operands, settings.min_time
+            )) {
+                fprintf(
+                    stderr, "%s: %s at %zu bits: %s\n", argv[0],
+                    operation->name, bits, strerror(errno)
+                );
+                stopped[k] = true;
+                continue;
+            }
+
+            report(&settings, operation->name, bits, iterations, seconds);
+            stopped[k] = seconds / (double) iterations > settings.cutoff;
+        }
+
+        free_operands(&operands);
+    }
+
+    bigint_cleanup();
+    return 0;
+}
@@ -0,0 +1,46 @@
+#!/bin/sh
+# Usage: bench.sh [-j] [-m MAX_BITS] [-t MIN_TIME] [-c CUTOFF] [-p THREADS]
+#                 [OP...]
+#
+# Build the benchmarks once for every digit width and run them. The results
+# of every width are combined into one CSV table or, with "-j", one JSON
+# array on standard output. The options are the same as those of "bench.c".
+# The compiler and its flags can be changed with CC and CFLAGS.
+set -eu
+
+cd "$(dirname "$0")"
+
+CC="${CC:-cc}"
+CFLAGS="${CFLAGS:--O2}"
+
+json=
+for argument in "$@"; do
+    if [ "$argument" = "-j" ]; then
+        json=1
+    fi
+done
+
+workspace="$(mktemp -d)"
+trap 'rm -rf "$workspace"' EXIT
+
+for width in 8 16 32 64; do
+    $CC $CFLAGS -std=c11 -DDIGIT_WIDTH="$width" \
+        -o "$workspace/bench$width" bench.c bigint.c -pthread -lm
+done
+
+for width in 8 16 32 64; do
+    if [ "$json" ]; then
+        "$workspace/bench$width" "$@"
+    elif [ "$width" = 8 ]; then
+        "$workspace/bench$width" "$@"
+    else
+        # Only the first table keeps its header.
+        "$workspace/bench$width" "$@" | sed 1d
+    fi
+done > "$workspace/results"
+
+if [ "$json" ]; then
+    sed -e '1s/^/[\n/' -e '$!s/$/,/' -e '$s/$/\n]/' "$workspace/results"
+else
+    cat "$workspace/results"
+fi
@@ -2,16 +2,21 @@
  * This library provides structures and calculation interfaces for arbitrary
  * length ("big") integers. The implementation internally uses sign-magnitude.
  */
+#define _POSIX_C_SOURCE 200809L
+
 #include <errno.h>
 #include <float.h>
 #include <inttypes.h>
 #include <limits.h>
 #include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include "bigint.h"
 
@@ -43,9 +48,323 @@
 #define DIGITS_FOR_INTMAX CEIL_DIV(sizeof(intmax_t), sizeof(digit_tt))
 
 /**
- * Maximum value stored in the small number cache.
+ * Number of values of a vector that its kernels process together. One digit
+ * of every value in a block fills a 64-byte cache line, which is also the
+ * size of the widest vector registers, so the loops over the values of a
+ * block compile to a few vector instructions per digit.
+ */
+#define VEC_LANES (64 / sizeof(digit_tt))
+
+/**
+ * Number of digits in each slab of a "bigint_array_st". Values that do not
+ * fit in a slab get one of their own.
+ */
+#define ARRAY_SLAB_DIGITS (65536 / sizeof(digit_tt))
+
+/**
+ * Number of values below which "bigint_sort" stops distributing values into
+ * buckets by their next byte and finishes with an insertion sort.
+ */
+#define SORT_RADIX_MIN 32
+
+/**
+ * Number of digits hashed together as one 64-bit word by "bigint_hash".
+ */
+#define HASH_WORD_DIGITS (64 / DIGIT_BITS)
+
+/**
+ * Maximum value stored in the small number table. This is large enough to
+ * cover every byte value and every supported numeric base.
+ */
+#define SMALL_NUMBERS_MAX 256
+
+/**
+ * Number of entries in the table of `10^(2^k)` values. Each entry is twice
+ * the size of the one before it, so lowering this value trades the memory
+ * used by the table for additional multiplications when large powers of ten
+ * are needed. The table has at most 10 entries, the last being `10^512`.
+ */
+#ifndef POWER_OF_TEN_TABLE_SIZE
+#define POWER_OF_TEN_TABLE_SIZE 10
+#endif
+
+#if POWER_OF_TEN_TABLE_SIZE < 1 || POWER_OF_TEN_TABLE_SIZE > 10
+#error POWER_OF_TEN_TABLE_SIZE must be between 1 and 10
+#endif
+
+/**
+ * Default limit in bytes for the memory used by the cache of powers. This can
+ * be changed at runtime with "bigint_set_power_cache_limit".
+ */
+#ifndef POWER_CACHE_LIMIT
+#define POWER_CACHE_LIMIT (16 * 1024 * 1024)
+#endif
+
+/**
+ * Header generated by "tune.c" that defines thresholds measured on the build
+ * machine. Thresholds it does not define keep the defaults below.
+ */
+#ifdef TUNED_THRESHOLDS
+#include TUNED_THRESHOLDS
+#endif
+
+/**
+ * Default number of digits above which parsing splits a run of numerals in
+ * half using a cached power of the base instead of processing it one digit
+ * at a time. This can be changed at runtime with "bigint_set_threshold".
+ */
+#ifndef PARSE_DC_THRESHOLD
+#define PARSE_DC_THRESHOLD 32
+#endif
+
+/**
+ * Default number of digits above which printing splits a value in half by
+ * dividing it by a cached power of the base instead of dividing it by a
+ * single digit repeatedly. This can be changed at runtime with
+ * "bigint_set_threshold".
+ */
+#ifndef PRINT_DC_THRESHOLD
+#define PRINT_DC_THRESHOLD 32
+#endif
+
+/**
+ * Default number of digits in the smaller operand above which multiplication
+ * splits its operands in half with the Karatsuba algorithm instead of using
+ * the schoolbook algorithm. This can be changed at runtime with
+ * "bigint_set_threshold".
+ */
+#ifndef MUL_KARATSUBA_THRESHOLD
+#define MUL_KARATSUBA_THRESHOLD 32
+#endif
+
+/**
+ * Default number of digits in the smaller operand above which the Karatsuba
+ * algorithm hands its subproducts to the threads started with
+ * "bigint_set_threads". The default corresponds to operands of 128 KiB. This
+ * can be changed at runtime with "bigint_set_threshold".
+ */
+#ifndef MUL_PARALLEL_THRESHOLD
+#define MUL_PARALLEL_THRESHOLD (1024 * 1024 / DIGIT_BITS)
+#endif
+
+/**
+ * Default number of digits in the smaller operand above which multiplication
+ * uses a number-theoretic transform instead of the Karatsuba algorithm. The
+ * transform works on 16-bit pieces whatever the digit width, so the crossover
+ * is much higher for wide digits, where each Karatsuba digit product does more
+ * work. This can be changed at runtime with "bigint_set_threshold".
+ */
+#ifndef MUL_NTT_THRESHOLD
+#if DIGIT_WIDTH <= 16
+#define MUL_NTT_THRESHOLD (32768 / DIGIT_BITS)
+#else
+#define MUL_NTT_THRESHOLD (262144 / DIGIT_BITS)
+#endif
+#endif
+
+/**
+ * Default number of digits above which divide-and-conquer parsing and
+ * printing hand one half of every split to the threads started with
+ * "bigint_set_threads". This can be changed at runtime with
+ * "bigint_set_threshold".
+ */
+#ifndef CONVERT_PARALLEL_THRESHOLD
+#define CONVERT_PARALLEL_THRESHOLD (65536 / DIGIT_BITS)
+#endif
+
+/**
+ * Smallest number of digits in both operands for which the Karatsuba
+ * algorithm is used regardless of the threshold. Below this, splitting the
+ * operands does not make the subproducts smaller.
+ */
+#define MUL_KARATSUBA_MIN 4
+
+/**
+ * Number of bits of the operands in each coefficient of the polynomials
+ * multiplied by the number-theoretic transform. The coefficients of the
+ * product must stay below the product of the primes of the transform.
+ */
+#define NTT_PIECE_BITS 16
+
+/**
+ * Number of primes modulo which the number-theoretic transform is computed.
+ */
+#define NTT_PRIMES 2
+
+/**
+ * Base 2 logarithm of the largest number-theoretic transform, which is the
+ * largest power of 2 that divides one less than every prime of the
+ * transform.
+ */
+#define NTT_LOG_MAX 28
+
+/**
+ * Number of values along each side of the tiles in which the matrices of
+ * the number-theoretic transform are transposed, so that both the rows that
+ * are read and the rows that are written stay in the cache.
+ */
+#define NTT_TILE 32
+
+/**
+ * Inverse of the first prime of the number-theoretic transform modulo the
+ * second, used to combine the results computed modulo each prime.
+ */
+#define NTT_GARNER_INVERSE 13
+
+/**
+ * Number of coefficients of the number-theoretic transform needed for a
+ * number of digits.
+ *
+ * Arguments:
+ * - n: The number of digits.
+ */
+#if DIGIT_WIDTH == 8
+#define NTT_PIECES(n) CEIL_DIV(n, 2)
+#else
+#define NTT_PIECES(n) ((n) * (DIGIT_BITS / NTT_PIECE_BITS))
+#endif
+
+/**
+ * Minimum number of bytes of text parsed or written by each thread used by
+ * "bigint_strntobiv", "bigint_snbprintv" and "bigint_tostrbv".
+ */
+#ifndef BATCH_RANGE_MIN
+#define BATCH_RANGE_MIN 65536
+#endif
+
+/**
+ * Largest base supported by conversions between big integers and strings.
+ */
+#define NUMERAL_BASE_MAX 62
+
+/**
+ * Add an amount to one of the counters of the calling thread. Unless the
+ * library is built with COLLECT_STATS, this expands to nothing, and the amount
+ * is not evaluated.
+ *
+ * Arguments:
+ * - counter: The name of a member of "bigint_stats_st".
+ * - amount: The amount to add.
+ */
+#ifdef COLLECT_STATS
+#define STATS_ADD(counter, amount) ((void) (stats.counter += (amount)))
+#else
+#define STATS_ADD(counter, amount) ((void) 0)
+#endif
+
+/**
+ * Count a call of an operation.
+ *
+ * Arguments:
+ * - name: The name of the operation in `BIGINT_STATS_OPERATIONS`.
+ * - count: The number of digits in the operands.
+ */
+#define STATS_OPERATION(name, count) ( \
+    STATS_ADD(name.calls, 1), STATS_ADD(name.digits, (count)) \
+)
+
+/**
+ * Add the counters of a task to the counters of the thread that joins it.
+ *
+ * Arguments:
+ * - source: Pointer to a "bigint_stats_st" structure.
+ */
+#ifdef COLLECT_STATS
+#define STATS_MERGE(source) stats_merge(source)
+#else
+#define STATS_MERGE(source) ((void) 0)
+#endif
+
+/**
+ * Generate the initializer for the digits of a 64-bit value in the order they
+ * are stored in a big integer.
+ *
+ * Arguments:
+ * - x: A 64-bit value.
+ */
+#if DIGIT_WIDTH == 8
+#define DIGITS_OF_U64(x) \
+    (digit_tt) (x), (digit_tt) ((x) >> 8), \
+    (digit_tt) ((x) >> 16), (digit_tt) ((x) >> 24), \
+    (digit_tt) ((x) >> 32), (digit_tt) ((x) >> 40), \
+    (digit_tt) ((x) >> 48), (digit_tt) ((x) >> 56)
+#elif DIGIT_WIDTH == 16
+#define DIGITS_OF_U64(x) \
+    (digit_tt) (x), (digit_tt) ((x) >> 16), \
+    (digit_tt) ((x) >> 32), (digit_tt) ((x) >> 48)
+#elif DIGIT_WIDTH == 32
+#define DIGITS_OF_U64(x) (digit_tt) (x), (digit_tt) ((x) >> 32)
+#else
+#define DIGITS_OF_U64(x) (digit_tt) (x)
+#endif
+
+/**
+ * Expand a macro for 4, 16, 64 or 256 consecutive integers. This is used to
+ * generate the contents of the small number table.
+ *
+ * Arguments:
+ * - m: Name of the macro to expand.
+ * - n: First value passed to the macro.
+ */
+#define REPEAT_4(m, n) m(n), m((n) + 1), m((n) + 2), m((n) + 3)
+#define REPEAT_16(m, n) \
+    REPEAT_4(m, n), REPEAT_4(m, (n) + 4), \
+    REPEAT_4(m, (n) + 8), REPEAT_4(m, (n) + 12)
+#define REPEAT_64(m, n) \
+    REPEAT_16(m, n), REPEAT_16(m, (n) + 16), \
+    REPEAT_16(m, (n) + 32), REPEAT_16(m, (n) + 48)
+#define REPEAT_256(m, n) \
+    REPEAT_64(m, n), REPEAT_64(m, (n) + 64), \
+    REPEAT_64(m, (n) + 128), REPEAT_64(m, (n) + 192)
+
+/**
+ * Get the second least significant digit of a value in the small number
+ * table. No value in the table needs more than two digits.
+ *
+ * Arguments:
+ * - n: Value of the entry.
+ */
+#define SMALL_NUMBER_HIGH_DIGIT(n) ((uintmax_t) (n) >> 8 >> (DIGIT_WIDTH - 8))
+
+/**
+ * Generate the initializer for the digits of an entry in the small number
+ * table.
+ *
+ * Arguments:
+ * - n: Value of the entry.
+ */
+#define SMALL_NUMBER_DIGITS(n) { \
+    (digit_tt) (n), (digit_tt) SMALL_NUMBER_HIGH_DIGIT(n) \
+}
+
+/**
+ * Generate the initializer for an entry in the small number table.
+ *
+ * Arguments:
+ * - n: Value of the entry.
+ */
+#define SMALL_NUMBER_ENTRY(n) { \
+    (digit_tt *) small_number_digits[n], \
+    2, \
+    (n) == 0 ? 0 : SMALL_NUMBER_HIGH_DIGIT(n) ? 2 : 1, \
+    false, \
+    true \
+}
+
+/**
+ * Generate the initializer for an entry in the table of powers of ten.
+ *
+ * Arguments:
+ * - digits: Array containing the digits of the value.
+ * - bits: Number of significant bits in the value.
  */
-#define SMALL_NUMBER_CACHE_MAX 16
+#define POWER_OF_TEN_ENTRY(digits, bits) { \
+    (digit_tt *) digits, \
+    sizeof(digits) / sizeof(digit_tt), \
+    CEIL_DIV(bits, DIGIT_BITS), \
+    false, \
+    true \
+}
 
 /**
  * Compute `a - b` and assign the result to "a". This can never fail because
@@ -79,9 +398,40 @@
 #define POWER_OF_2(x) ((((x) - 1) & (x)) == 0)
 
 /**
- * Big integer representing the value of 10.
+ * Mask for the bits of a 64-bit integer that are discarded when it is
+ * converted to a double.
+ */
+#define TOD_ROUNDING_MASK ((UINT64_C(1) << (64 - DBL_MANT_DIG)) - 1)
+
+/**
+ * Value of the discarded bits of a 64-bit integer that is exactly halfway
+ * between two representable doubles.
+ */
+#define TOD_ROUNDING_HALF (UINT64_C(1) << (64 - DBL_MANT_DIG - 1))
+
+/**
+ * Get a pointer to the big integer in the small number table with the given
+ * value. The structure is stored in read-only memory, so it must only ever be
+ * used as an input.
+ *
+ * Arguments:
+ * - n: A value no greater than `SMALL_NUMBERS_MAX`.
+ *
+ * Return: A pointer to a big integer.
+ */
+#define SMALL_NUMBER(n) ((bigint_st *) &small_numbers[n])
+
+/**
+ * Get a pointer to the big integer representing `10^(2^k)` from the table of
+ * powers of ten. Like the values in the small number table, it must only ever
+ * be used as an input.
+ *
+ * Arguments:
+ * - k: A value less than `POWER_OF_TEN_TABLE_SIZE`.
+ *
+ * Return: A pointer to a big integer.
  */
-#define TEN small_number_cache[10]
+#define POWER_OF_TEN(k) ((bigint_st *) &powers_of_ten[k])
 
 /**
  * Sign-magnitude representation of arbitrary-length ("big") integers.
@@ -107,2649 +457,9783 @@ struct bigint_st {
      * non-negative.
      */
     bool negative;
+    /**
+     * Value that indicates whether the digits are stored in memory owned by
+     * something else such as the slab of a batch of parsed numbers. Borrowed
+     * digits are copied to new memory instead of being reallocated when more
+     * space is needed, and they are never freed with the number.
+     */
+    bool borrowed;
 };
 
 /**
- * Cache of pointers to pre-generated structures for small numbers. This is
- * populated by "bigint_init".
+ * Unsigned integers of the same width stored in digit-major order: digit `d`
+ * of value `i` is `digits[d * stride + i]`. The same digit of consecutive
+ * values is contiguous, so an operation applied to every value works on
+ * whole rows of digits instead of following one pointer per value.
  */
-static bigint_st* small_number_cache[SMALL_NUMBER_CACHE_MAX + 1];
+struct bigint_vec_st {
+    /**
+     * The digits of the values.
+     */
+    digit_tt *digits;
+    /**
+     * Number of values.
+     */
+    size_t count;
+    /**
+     * Number of digits in each row, which is the number of values rounded up
+     * to a multiple of `VEC_LANES`. The digits of the padding are always 0.
+     */
+    size_t stride;
+    /**
+     * Number of digits in each value.
+     */
+    size_t length;
+    /**
+     * Number of bits in each value. Every value is kept modulo 2 raised to
+     * this number.
+     */
+    size_t bits;
+};
 
 /**
- * Variable used to track whether the library's internal state has been
- * initialized.
+ * A block of memory from which a "bigint_array_st" hands out the digits of
+ * its values.
  */
-static bool init_done = false;
+typedef struct array_slab_st array_slab_st;
+
+struct array_slab_st {
+    /**
+     * The digits.
+     */
+    digit_tt *digits;
+    /**
+     * Number of digits in the slab.
+     */
+    size_t size;
+    /**
+     * Number of digits that have been handed out.
+     */
+    size_t used;
+    /**
+     * The next slab of the array.
+     */
+    array_slab_st *next;
+};
 
-#ifndef DIGIT_SUPER_TYPE
 /**
- * Compute the sum of two unsigned, 64-bit integers.
- *
- * Arguments:
- * - msb: Pointer where the upper 64 bits of the existing value and the result
- *   are stored.
- * - lsb: Pointer where the lower 64 bits of the existing value and the result
- *   are stored.
+ * An array of big integers whose digits are packed into a few large slabs.
+ * The values borrow their digits from the slabs, so they never own memory of
+ * their own, and the whole array is released by freeing the slabs and the
+ * array of values.
  */
-static void u128add64(uint64_t *msb, uint64_t *lsb, uint64_t addend)
-{
-    uint64_t new_lsb;
-
-    if (addend != 0) {
-        new_lsb = *lsb + addend;
-        *msb += new_lsb < *lsb;
-        *lsb = new_lsb;
-    }
-}
+struct bigint_array_st {
+    /**
+     * The values, which are referred to by their index because the array is
+     * reallocated as it grows.
+     */
+    bigint_st *values;
+    /**
+     * Number of values.
+     */
+    size_t count;
+    /**
+     * Number of values that fit in the allocated array.
+     */
+    size_t capacity;
+    /**
+     * The slabs of digits. The first slab is the one new digits are taken
+     * from, and slabs that were filled or that hold a single large value
+     * follow it.
+     */
+    array_slab_st *slabs;
+};
 
 /**
- * Compute the product of two unsigned, 64-bit integers summed with an
- * additional value.
- *
- * Arguments:
- * - msb: Pointer where the upper 64 bits of the existing value and the result
- *   are stored.
- * - lsb: Pointer where the lower 64 bits of the existing value and the result
- *   are stored.
- * - a: Multiplicand.
- * - b: Multiplicand.
- * - c: Addend.
+ * Settings a multiplication reads once before it starts, so every step of
+ * it agrees on the algorithms to use even if they are changed concurrently.
  */
-static void u128fma64(
-    uint64_t *msb, uint64_t *lsb, uint64_t a, uint64_t b, uint64_t c
-)
-{
-    uint64_t al = a & (uint32_t) -1;
-    uint64_t ah = a >> 32;
-    uint64_t bl = b & (uint32_t) -1;
-    uint64_t bh = b >> 32;
-
-    uint64_t al_bl = al * bl;
-    uint64_t ah_bl = ah * bl;
-    uint64_t al_bh = al * bh;
-    uint64_t ah_bh = ah * bh;
-
-    uint64_t cross = (al_bl >> 32) + (ah_bl & (uint32_t) -1) + al_bh;
-
-    *msb = (ah_bl >> 32) + (cross >> 32) + ah_bh;
-    *lsb = (cross << 32) | (al_bl & (uint32_t) -1);
-
-    u128add64(msb, lsb, c);
-}
-#endif
+typedef struct {
+    /**
+     * Value of the "mul_karatsuba" threshold.
+     */
+    size_t karatsuba;
+    /**
+     * Value of the "mul_parallel" threshold.
+     */
+    size_t parallel;
+    /**
+     * Value of the "mul_ntt" threshold.
+     */
+    size_t ntt;
+    /**
+     * Number of threads that may work on the multiplication.
+     */
+    unsigned threads;
+    /**
+     * Number of levels of the recursion that may hand subproducts to other
+     * threads.
+     */
+    unsigned levels;
+} mul_plan_st;
 
 /**
- * This function works like _calloc(3)_, but when the total number of bytes
- * would lead to an integer overflow, the allocation fails.
- *
- * Arguments:
- * - nmemb: Number of members for which space should be allocated.
+ * A product of two arrays of digits computed by "digits_mul", possibly on
+ * another thread.
+ */
+typedef struct {
+    /**
+     * Destination of the product.
+     */
+    digit_tt *r;
+    /**
+     * Digits of the multiplicand.
+     */
+    const digit_tt *a;
+    /**
+     * Number of digits in the multiplicand.
+     */
+    size_t an;
+    /**
+     * Digits of the multiplier.
+     */
+    const digit_tt *b;
+    /**
+     * Number of digits in the multiplier.
+     */
+    size_t bn;
+    /**
+     * Temporary space reserved for this product.
+     */
+    digit_tt *scratch;
+    /**
+     * Settings of the multiplication the product is part of.
+     */
+    const mul_plan_st *plan;
+    /**
+     * Number of levels below this one that may hand subproducts to other
+     * threads.
+     */
+    unsigned levels;
+} mul_job_st;
+
+/**
+ * A unit of work queued for the threads started with "bigint_set_threads".
+ */
+typedef struct pool_task_st pool_task_st;
+
+struct pool_task_st {
+    /**
+     * Function that performs the work.
+     */
+    void (*run)(void *);
+    /**
+     * Argument passed to the function.
+     */
+    void *arg;
+    /**
+     * The task that was queued before this one.
+     */
+    pool_task_st *next;
+    /**
+     * Value that indicates whether the work is done. This is guarded by the
+     * lock of the pool.
+     */
+    bool done;
+};
+
+/**
+ * A range of indices split between the threads of the pool, where each part
+ * is processed by the same function.
+ */
+typedef struct {
+    /**
+     * Function that processes the indices from `first` up to but not
+     * including `last`.
+     */
+    void (*body)(void *, size_t, size_t);
+    /**
+     * Argument passed to the function.
+     */
+    void *context;
+    /**
+     * The first index of the range.
+     */
+    size_t first;
+    /**
+     * One past the last index of the range.
+     */
+    size_t last;
+    /**
+     * Largest number of indices that are not split further.
+     */
+    size_t grain;
+} pool_range_st;
+
+/**
+ * A prime modulus of the number-theoretic transform. Products modulo the
+ * prime use Montgomery reduction with `R = 2^32`.
+ */
+typedef struct {
+    /**
+     * The prime which must be less than `2^32`.
+     */
+    uint32_t modulus;
+    /**
+     * Inverse of the prime modulo `2^32`.
+     */
+    uint32_t inverse;
+    /**
+     * The value of `R^2` modulo the prime, which converts values to the
+     * Montgomery form.
+     */
+    uint32_t r2;
+    /**
+     * A generator of the multiplicative group modulo the prime.
+     */
+    uint32_t generator;
+} ntt_prime_st;
+
+/**
+ * Roots of unity used by transforms of one length modulo one prime. These
+ * are shared by every thread and never change once they are computed.
+ */
+typedef struct {
+    /**
+     * Number of transforms currently using the table. Tables that are in use
+     * are never freed.
+     */
+    size_t references;
+    /**
+     * The roots used by the forward transform in Montgomery form. The roots
+     * of the butterflies that span `2m` values are the `m` powers of the
+     * primitive `2m`-th root of unity starting at `forward[m]`.
+     */
+    uint32_t *forward;
+    /**
+     * The inverses of the forward roots laid out the same way.
+     */
+    uint32_t *inverse;
+    /**
+     * The index of each value with its bits reversed.
+     */
+    uint32_t *reversed;
+} ntt_table_st;
+
+/**
+ * A number-theoretic transform modulo one prime. The values are processed as
+ * a matrix with `rows * columns` entries using the six-step algorithm, which
+ * replaces one large transform with many short transforms that fit in the
+ * cache and transposes the matrix between them. The spectrum is left in a
+ * permuted order that the inverse transform undoes, which is all a
+ * convolution needs.
+ */
+typedef struct {
+    /**
+     * The prime of the transform.
+     */
+    const ntt_prime_st *prime;
+    /**
+     * Roots for transforms over a row of the matrix.
+     */
+    ntt_table_st *row_table;
+    /**
+     * Roots for transforms over a column of the matrix.
+     */
+    ntt_table_st *column_table;
+    /**
+     * Space for the transposed matrix.
+     */
+    uint32_t *spare;
+    /**
+     * Number of rows of the matrix in its natural order.
+     */
+    size_t rows;
+    /**
+     * Number of columns of the matrix in its natural order.
+     */
+    size_t columns;
+    /**
+     * Primitive root of unity of the order of the whole transform in
+     * Montgomery form.
+     */
+    uint32_t root;
+    /**
+     * Inverse of the root in Montgomery form.
+     */
+    uint32_t inverse_root;
+    /**
+     * Number of threads that may work on the transform.
+     */
+    unsigned threads;
+} ntt_st;
+
+/**
+ * A pass of the number-theoretic transform over rows of a matrix.
+ */
+typedef struct {
+    /**
+     * The transform.
+     */
+    const ntt_st *ntt;
+    /**
+     * The matrix.
+     */
+    uint32_t *data;
+    /**
+     * Number of values in each row.
+     */
+    size_t length;
+    /**
+     * Roots for transforms of that length.
+     */
+    const ntt_table_st *table;
+    /**
+     * Value that indicates whether the inverse transform is computed.
+     */
+    bool inverse;
+    /**
+     * Value that indicates whether the value in row `i` and column `k` of
+     * the transformed rows is multiplied by the root of the whole transform
+     * raised to the power `i * k`.
+     */
+    bool twiddle;
+} ntt_rows_st;
+
+/**
+ * A transpose of a matrix of the number-theoretic transform.
+ */
+typedef struct {
+    /**
+     * The matrix to transpose.
+     */
+    const uint32_t *in;
+    /**
+     * Destination of the transposed matrix.
+     */
+    uint32_t *out;
+    /**
+     * Number of rows of the matrix that is transposed.
+     */
+    size_t rows;
+    /**
+     * Number of columns of the matrix that is transposed.
+     */
+    size_t columns;
+} ntt_transpose_st;
+
+/**
+ * Pointwise products of two spectra of the number-theoretic transform.
+ */
+typedef struct {
+    /**
+     * The prime of the transform.
+     */
+    const ntt_prime_st *prime;
+    /**
+     * The first spectrum which receives the products.
+     */
+    uint32_t *a;
+    /**
+     * The second spectrum.
+     */
+    const uint32_t *b;
+} ntt_pointwise_st;
+
+/**
+ * Digits of the values in the small number table.
+ */
+static const digit_tt small_number_digits[SMALL_NUMBERS_MAX + 1][2] = {
+    REPEAT_256(SMALL_NUMBER_DIGITS, 0), SMALL_NUMBER_DIGITS(256),
+};
+
+/**
+ * Pre-generated structures for small numbers. The table is constant, so it
+ * lives in read-only memory, needs no initialization and can be shared by any
+ * number of threads.
+ */
+static const bigint_st small_numbers[SMALL_NUMBERS_MAX + 1] = {
+    REPEAT_256(SMALL_NUMBER_ENTRY, 0), SMALL_NUMBER_ENTRY(256),
+};
+
+static const digit_tt power_of_ten_0_digits[] = {
+    DIGITS_OF_U64(UINT64_C(0x000000000000000a)),
+};
+
+#if POWER_OF_TEN_TABLE_SIZE > 1
+static const digit_tt power_of_ten_1_digits[] = {
+    DIGITS_OF_U64(UINT64_C(0x0000000000000064)),
+};
+#endif
+
+#if POWER_OF_TEN_TABLE_SIZE > 2
+static const digit_tt power_of_ten_2_digits[] = {
+    DIGITS_OF_U64(UINT64_C(0x0000000000002710)),
+};
+#endif
+
+#if POWER_OF_TEN_TABLE_SIZE > 3
+static const digit_tt power_of_ten_3_digits[] = {
+    DIGITS_OF_U64(UINT64_C(0x0000000005f5e100)),
+};
+#endif
+
+#if POWER_OF_TEN_TABLE_SIZE > 4
+static const digit_tt power_of_ten_4_digits[] = {
+    DIGITS_OF_U64(UINT64_C(0x002386f26fc10000)),
+};
+#endif
+
+#if POWER_OF_TEN_TABLE_SIZE > 5
+static const digit_tt power_of_ten_5_digits[] = {
+    DIGITS_OF_U64(UINT64_C(0x85acef8100000000)),
+    DIGITS_OF_U64(UINT64_C(0x000004ee2d6d415b)),
+};
+#endif
+
+#if POWER_OF_TEN_TABLE_SIZE > 6
+static const digit_tt power_of_ten_6_digits[] = {
+    DIGITS_OF_U64(UINT64_C(0x0000000000000000)),
+    DIGITS_OF_U64(UINT64_C(0x6e38ed64bf6a1f01)),
+    DIGITS_OF_U64(UINT64_C(0xe93ff9f4daa797ed)),
+    DIGITS_OF_U64(UINT64_C(0x0000000000184f03)),
+};
+#endif
+
+#if POWER_OF_TEN_TABLE_SIZE > 7
+static const digit_tt power_of_ten_7_digits[] = {
+    DIGITS_OF_U64(UINT64_C(0x0000000000000000)),
+    DIGITS_OF_U64(UINT64_C(0x0000000000000000)),
+    DIGITS_OF_U64(UINT64_C(0x03df99092e953e01)),
+    DIGITS_OF_U64(UINT64_C(0x2374e42f0f1538fd)),
+    DIGITS_OF_U64(UINT64_C(0xc404dc08d3cff5ec)),
+    DIGITS_OF_U64(UINT64_C(0xa6337f19bccdb0da)),
+    DIGITS_OF_U64(UINT64_C(0x0000024ee91f2603)),
+};
+#endif
+
+#if POWER_OF_TEN_TABLE_SIZE > 8
+static const digit_tt power_of_ten_8_digits[] = {
+    DIGITS_OF_U64(UINT64_C(0x0000000000000000)),
+    DIGITS_OF_U64(UINT64_C(0x0000000000000000)),
+    DIGITS_OF_U64(UINT64_C(0x0000000000000000)),
+    DIGITS_OF_U64(UINT64_C(0x0000000000000000)),
+    DIGITS_OF_U64(UINT64_C(0xbed3875b982e7c01)),
+    DIGITS_OF_U64(UINT64_C(0x12152f87d8d99f72)),
+    DIGITS_OF_U64(UINT64_C(0xcf4a6e706bde50c6)),
+    DIGITS_OF_U64(UINT64_C(0x26b2716ed595d80f)),
+    DIGITS_OF_U64(UINT64_C(0x1d153624adc666b0)),
+    DIGITS_OF_U64(UINT64_C(0x63ff540e3c42d35a)),
+    DIGITS_OF_U64(UINT64_C(0x65f9ef17cc5573c0)),
+    DIGITS_OF_U64(UINT64_C(0x80dcc7f755bc28f2)),
+    DIGITS_OF_U64(UINT64_C(0x5fdcefcef46eeddc)),
+    DIGITS_OF_U64(UINT64_C(0x00000000000553f7)),
+};
+#endif
+
+#if POWER_OF_TEN_TABLE_SIZE > 9
+static const digit_tt power_of_ten_9_digits[] = {
+    DIGITS_OF_U64(UINT64_C(0x0000000000000000)),
+    DIGITS_OF_U64(UINT64_C(0x0000000000000000)),
+    DIGITS_OF_U64(UINT64_C(0x0000000000000000)),
+    DIGITS_OF_U64(UINT64_C(0x0000000000000000)),
+    DIGITS_OF_U64(UINT64_C(0x0000000000000000)),
+    DIGITS_OF_U64(UINT64_C(0x0000000000000000)),
+    DIGITS_OF_U64(UINT64_C(0x0000000000000000)),
+    DIGITS_OF_U64(UINT64_C(0x0000000000000000)),
+    DIGITS_OF_U64(UINT64_C(0x77f27267fc6cf801)),
+    DIGITS_OF_U64(UINT64_C(0x5d96976f8f9546dc)),
+    DIGITS_OF_U64(UINT64_C(0xc31e1ad9b83a8a97)),
+    DIGITS_OF_U64(UINT64_C(0x94e6574746c40513)),
+    DIGITS_OF_U64(UINT64_C(0x4475b579c88976c1)),
+    DIGITS_OF_U64(UINT64_C(0xaa1da1bf28f8733b)),
+    DIGITS_OF_U64(UINT64_C(0x1e25cfea703ed321)),
+    DIGITS_OF_U64(UINT64_C(0xbc51fb2eb21a2f22)),
+    DIGITS_OF_U64(UINT64_C(0xbfa3edac96e14f5d)),
+    DIGITS_OF_U64(UINT64_C(0xe7fc7153329c57ae)),
+    DIGITS_OF_U64(UINT64_C(0x85a91924c3fc0695)),
+    DIGITS_OF_U64(UINT64_C(0xb2908ee0f95f635e)),
+    DIGITS_OF_U64(UINT64_C(0x1366732a93abade4)),
+    DIGITS_OF_U64(UINT64_C(0x69be5b0e9449775c)),
+    DIGITS_OF_U64(UINT64_C(0xb099bc817343afac)),
+    DIGITS_OF_U64(UINT64_C(0xa269974845a71d46)),
+    DIGITS_OF_U64(UINT64_C(0x8a0b1f138cb07303)),
+    DIGITS_OF_U64(UINT64_C(0xc1d238d98cab8a97)),
+    DIGITS_OF_U64(UINT64_C(0x0000001c633415d4)),
+};
+#endif
+/**
+ * Pre-generated structures for `10^(2^k)` where "k" is the index into the
+ * table. Like the small number table, this is generated at compile time and
+ * stored in read-only memory.
+ */
+static const bigint_st powers_of_ten[POWER_OF_TEN_TABLE_SIZE] = {
+    POWER_OF_TEN_ENTRY(power_of_ten_0_digits, 4),
+#if POWER_OF_TEN_TABLE_SIZE > 1
+    POWER_OF_TEN_ENTRY(power_of_ten_1_digits, 7),
+#endif
+#if POWER_OF_TEN_TABLE_SIZE > 2
+    POWER_OF_TEN_ENTRY(power_of_ten_2_digits, 14),
+#endif
+#if POWER_OF_TEN_TABLE_SIZE > 3
+    POWER_OF_TEN_ENTRY(power_of_ten_3_digits, 27),
+#endif
+#if POWER_OF_TEN_TABLE_SIZE > 4
+    POWER_OF_TEN_ENTRY(power_of_ten_4_digits, 54),
+#endif
+#if POWER_OF_TEN_TABLE_SIZE > 5
+    POWER_OF_TEN_ENTRY(power_of_ten_5_digits, 107),
+#endif
+#if POWER_OF_TEN_TABLE_SIZE > 6
+    POWER_OF_TEN_ENTRY(power_of_ten_6_digits, 213),
+#endif
+#if POWER_OF_TEN_TABLE_SIZE > 7
+    POWER_OF_TEN_ENTRY(power_of_ten_7_digits, 426),
+#endif
+#if POWER_OF_TEN_TABLE_SIZE > 8
+    POWER_OF_TEN_ENTRY(power_of_ten_8_digits, 851),
+#endif
+#if POWER_OF_TEN_TABLE_SIZE > 9
+    POWER_OF_TEN_ENTRY(power_of_ten_9_digits, 1701),
+#endif
+};
+
+/**
+ * Entry in the cache of powers used by conversions.
+ */
+typedef struct power_cache_entry_st power_cache_entry_st;
+
+struct power_cache_entry_st {
+    /**
+     * The base of the power.
+     */
+    unsigned base;
+    /**
+     * The exponent of the power.
+     */
+    uintmax_t exponent;
+    /**
+     * The value of the power.
+     */
+    bigint_st *value;
+    /**
+     * Number of bytes of memory accounted to this entry.
+     */
+    size_t bytes;
+    /**
+     * Number of callers currently using the value. Entries that are in use
+     * are never evicted.
+     */
+    size_t references;
+    /**
+     * The entry that was used more recently than this one.
+     */
+    power_cache_entry_st *newer;
+    /**
+     * The entry that was used less recently than this one.
+     */
+    power_cache_entry_st *older;
+};
+
+/**
+ * Cache of powers shared by the functions that convert numbers to and from
+ * strings. Entries are kept in a list ordered by how recently they were used
+ * so the least recently used ones can be evicted when the memory limit is
+ * reached.
+ */
+static struct {
+    /**
+     * Lock that must be held when accessing the other members.
+     */
+    pthread_mutex_t lock;
+    /**
+     * The most recently used entry.
+     */
+    power_cache_entry_st *newest;
+    /**
+     * The least recently used entry.
+     */
+    power_cache_entry_st *oldest;
+    /**
+     * Total number of bytes accounted to the entries.
+     */
+    size_t bytes;
+    /**
+     * Maximum number of bytes the entries may use.
+     */
+    size_t limit;
+} power_cache = {PTHREAD_MUTEX_INITIALIZER, NULL, NULL, 0, POWER_CACHE_LIMIT};
+
+/**
+ * Threads that multiplication hands independent subproducts to. Every thread
+ * takes the most recently queued task from a single stack, and a thread that
+ * waits for a task it queued runs other queued tasks in the meantime, so
+ * nested subproducts cannot deadlock and no thread sits idle while there is
+ * work it could take.
+ */
+static struct {
+    /**
+     * Lock that must be held when accessing the queue, the flag that stops
+     * the workers and the state of the tasks.
+     */
+    pthread_mutex_t lock;
+    /**
+     * Lock held while the workers are replaced by "bigint_set_threads".
+     */
+    pthread_mutex_t configure;
+    /**
+     * Condition signaled when a task is queued or the workers must stop.
+     */
+    pthread_cond_t queued;
+    /**
+     * Condition signaled when a task is done.
+     */
+    pthread_cond_t finished;
+    /**
+     * The most recently queued task that no thread has taken yet.
+     */
+    pool_task_st *queue;
+    /**
+     * The worker threads.
+     */
+    pthread_t *workers;
+    /**
+     * Number of worker threads. It is read without locking by every large
+     * multiplication, so it is atomic.
+     */
+    atomic_uint count;
+    /**
+     * Value that indicates whether the workers must stop.
+     */
+    bool stopping;
+} pool = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+    PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER, NULL, NULL, 0, false
+};
+
+/**
+ * Primes of the number-theoretic transform. Their product is greater than
+ * `2^63`, which bounds the coefficients of any product of transforms up to
+ * `2^NTT_LOG_MAX` values.
+ */
+static const ntt_prime_st ntt_primes[NTT_PRIMES] = {
+    {UINT32_C(3221225473), UINT32_C(0x40000001), UINT32_C(1789569709), 5},
+    {UINT32_C(3489660929), UINT32_C(0x30000001), UINT32_C(1961643719), 3},
+};
+
+/**
+ * Tables of roots of unity of the number-theoretic transform indexed by
+ * prime and by the base 2 logarithm of their length. Transforms only use
+ * tables of up to half the logarithm of their length.
+ */
+static ntt_table_st *ntt_tables[NTT_PRIMES][NTT_LOG_MAX / 2 + 1];
+
+/**
+ * Lock that must be held when accessing "ntt_tables".
+ */
+static pthread_mutex_t ntt_tables_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Indices of the entries in the table of thresholds.
+ */
+enum {
+    THRESHOLD_PARSE_DC,
+    THRESHOLD_PRINT_DC,
+    THRESHOLD_MUL_KARATSUBA,
+    THRESHOLD_MUL_PARALLEL,
+    THRESHOLD_MUL_NTT,
+    THRESHOLD_CONVERT_PARALLEL,
+    THRESHOLD_COUNT
+};
+
+/**
+ * A crossover point between two algorithms for the same operation.
+ */
+typedef struct {
+    /**
+     * Name used to refer to the threshold in "bigint_set_threshold" and
+     * "bigint_get_threshold".
+     */
+    const char *name;
+    /**
+     * The value the threshold had when the library was built.
+     */
+    size_t initial;
+    /**
+     * The current value. It is read without locking on every call of the
+     * operations that depend on it, so it is atomic rather than guarded by a
+     * mutex.
+     */
+    atomic_size_t value;
+} threshold_st;
+
+/**
+ * Thresholds that may be changed at runtime.
+ */
+static threshold_st thresholds[THRESHOLD_COUNT] = {
+    [THRESHOLD_PARSE_DC] = {"parse_dc", PARSE_DC_THRESHOLD, PARSE_DC_THRESHOLD},
+    [THRESHOLD_PRINT_DC] = {"print_dc", PRINT_DC_THRESHOLD, PRINT_DC_THRESHOLD},
+    [THRESHOLD_MUL_KARATSUBA] = {
+        "mul_karatsuba", MUL_KARATSUBA_THRESHOLD, MUL_KARATSUBA_THRESHOLD
+    },
+    [THRESHOLD_MUL_PARALLEL] = {
+        "mul_parallel", MUL_PARALLEL_THRESHOLD, MUL_PARALLEL_THRESHOLD
+    },
+    [THRESHOLD_MUL_NTT] = {"mul_ntt", MUL_NTT_THRESHOLD, MUL_NTT_THRESHOLD},
+    [THRESHOLD_CONVERT_PARALLEL] = {
+        "convert_parallel", CONVERT_PARALLEL_THRESHOLD,
+        CONVERT_PARALLEL_THRESHOLD
+    },
+};
+
+/**
+ * Counters that are all 0, used to initialize the counters of helper threads.
+ */
+static const bigint_stats_st no_stats;
+
+#ifdef COLLECT_STATS
+/**
+ * Counters of the calling thread.
+ */
+static _Thread_local bigint_stats_st stats;
+
+/**
+ * Add the counters of a helper thread to those of the calling thread.
+ *
+ * Arguments:
+ * - other: The counters of the helper thread.
+ */
+static void stats_merge(const bigint_stats_st *other)
+{
+#define MERGE_OPERATION(name) \
+    stats.name.calls += other->name.calls; \
+    stats.name.digits += other->name.digits;
+
+    BIGINT_STATS_OPERATIONS(MERGE_OPERATION)
+#undef MERGE_OPERATION
+
+    stats.allocations += other->allocations;
+    stats.reallocations += other->reallocations;
+    stats.bytes += other->bytes;
+    stats.frees += other->frees;
+    stats.resizes += other->resizes;
+}
+#endif
+
+/**
+ * Settings of the trace hook of a thread.
+ */
+typedef struct {
+    /**
+     * Function called when a traced operation is slow or large, or NULL if
+     * tracing is disabled.
+     */
+    bigint_trace_ft hook;
+    /**
+     * Value passed to the hook.
+     */
+    void *context;
+    /**
+     * Number of digits at which an operation is reported or 0 if operations
+     * are not reported based on their size.
+     */
+    size_t min_digits;
+    /**
+     * Duration in seconds at which an operation is reported or 0 if
+     * operations are not reported based on their duration.
+     */
+    double min_seconds;
+    /**
+     * Number of traced operations in progress. Only the outermost one is
+     * reported, so an operation implemented with other traced operations is
+     * reported under its own name, and calls made by the hook itself are
+     * never reported.
+     */
+    unsigned depth;
+} tracer_st;
+
+/**
+ * A traced operation in progress.
+ */
+typedef struct {
+    /**
+     * The event passed to the hook.
+     */
+    bigint_trace_st event;
+    /**
+     * The time at which the operation started.
+     */
+    struct timespec start;
+    /**
+     * Value that indicates whether the operation was counted in the depth of
+     * the tracer.
+     */
+    bool counted;
+    /**
+     * Value that indicates whether the operation is reported if it is slow or
+     * large enough.
+     */
+    bool active;
+} trace_span_st;
+
+/**
+ * Trace hook of the calling thread.
+ */
+static _Thread_local tracer_st tracer;
+
+/**
+ * Memory held by the digits of the big integers of a thread.
+ */
+typedef struct {
+    /**
+     * Number of bytes allocated for digits by the thread less the number of
+     * bytes freed by it. This never drops below 0 even when the thread frees
+     * values allocated by other threads.
+     */
+    size_t used;
+    /**
+     * Maximum number of bytes that may be used or 0 if there is no limit.
+     */
+    size_t limit;
+} memory_st;
+
+/**
+ * Memory accounting of the calling thread.
+ */
+static _Thread_local memory_st memory;
+
+/**
+ * Thread-local state of a task that a conversion hands to the threads of the
+ * pool. The task runs with the memory accounting the forking thread had when
+ * the task was forked, and the memory it leaves allocated and its counters
+ * are added to the forking thread once the task is joined.
+ */
+typedef struct {
+    /**
+     * Memory accounting of the task.
+     */
+    memory_st memory;
+    /**
+     * Memory used by the forking thread when the task was forked.
+     */
+    size_t used;
+    /**
+     * Counters of the task when the library is built with COLLECT_STATS.
+     */
+    bigint_stats_st stats;
+    /**
+     * The value of "errno" if the task failed.
+     */
+    int error;
+} task_state_st;
+
+/**
+ * A range of a buffer of delimited numbers that is parsed by
+ * "bigint_strntobiv". Each range may be parsed by a different thread.
+ */
+typedef struct {
+    /**
+     * First character of the range.
+     */
+    const char *start;
+    /**
+     * Character following the last character of the range.
+     */
+    const char *end;
+    /**
+     * Character that separates the values.
+     */
+    char delimiter;
+    /**
+     * Number of values in the range.
+     */
+    size_t values;
+    /**
+     * Number of digits reserved in the slab for the values in the range.
+     */
+    size_t digits;
+    /**
+     * Location of the pointer to the first value of the range in the array
+     * that is returned to the caller.
+     */
+    bigint_st **output;
+    /**
+     * Structures used for the values of the range.
+     */
+    bigint_st *structs;
+    /**
+     * Digits reserved for the values of the range.
+     */
+    digit_tt *slab;
+    /**
+     * Number of values that have been parsed.
+     */
+    size_t parsed;
+    /**
+     * Value that indicates whether the range is being parsed by a thread
+     * that must be joined.
+     */
+    bool threaded;
+    /**
+     * State of the range, which holds the value of "errno" if the parsing
+     * failed.
+     */
+    task_state_st state;
+} batch_range_st;
+
+/**
+ * A group of consecutive values written by "bigint_snbprintv" or
+ * "bigint_tostrbv". Each group may be written by a different thread.
+ */
+typedef struct {
+    /**
+     * Destination of the first value in the group.
+     */
+    char *buf;
+    /**
+     * The values in the group.
+     */
+    bigint_st **values;
+    /**
+     * The length of the representation of each value.
+     */
+    const size_t *lengths;
+    /**
+     * The number of values in the group.
+     */
+    size_t count;
+    /**
+     * Text written after each value other than the last one overall.
+     */
+    const char *separator;
+    /**
+     * Length of the separator.
+     */
+    size_t separator_length;
+    /**
+     * The base in which the values are written.
+     */
+    unsigned char base;
+    /**
+     * Value that indicates whether the group contains the last value.
+     */
+    bool last;
+    /**
+     * Value that indicates whether the group is being written by a thread
+     * that must be joined.
+     */
+    bool threaded;
+    /**
+     * State of the group, which holds the value of "errno" if writing the
+     * group failed.
+     */
+    task_state_st state;
+} format_group_st;
+
+/**
+ * Settings shared by every level of a divide-and-conquer conversion.
+ */
+typedef struct {
+    /**
+     * The base of the numerals.
+     */
+    unsigned char base;
+    /**
+     * Number of numerals that fit in a single digit.
+     */
+    size_t per_digit;
+    /**
+     * Powers of the base used to split the numerals when the conversion
+     * hands work to other threads, or NULL if it runs on the calling thread
+     * only. Every split is the number of numerals per digit times a power of
+     * two, and the entry at index `k` is the base raised to `per_digit << k`.
+     * The powers are computed by the calling thread before any work is
+     * handed out, so the threads only ever read them.
+     */
+    bigint_st **powers;
+    /**
+     * Number of entries in "powers".
+     */
+    size_t levels;
+} conversion_st;
+
+/**
+ * The least significant half of a run of numerals that is parsed by a task
+ * of the pool.
+ */
+typedef struct {
+    /**
+     * Destination of the value of the numerals, which is initially 0.
+     */
+    bigint_st *x;
+    /**
+     * Numerals to parse.
+     */
+    const char *numerals;
+    /**
+     * Number of numerals.
+     */
+    size_t count;
+    /**
+     * The conversion the numerals belong to.
+     */
+    const conversion_st *conversion;
+    /**
+     * Thread-local state of the task.
+     */
+    task_state_st state;
+    /**
+     * 0 if the parsing succeeded and -1 if it failed.
+     */
+    int result;
+} parse_job_st;
+
+/**
+ * The most significant half of a value that is written by a task of the
+ * pool.
+ */
+typedef struct {
+    /**
+     * Destination of the numerals.
+     */
+    char *buf;
+    /**
+     * The maximum number of numerals that can be written.
+     */
+    size_t buflen;
+    /**
+     * The value to write, which is destroyed.
+     */
+    bigint_st *x;
+    /**
+     * Minimum number of numerals to write.
+     */
+    size_t width;
+    /**
+     * The conversion the value belongs to.
+     */
+    const conversion_st *conversion;
+    /**
+     * Thread-local state of the task.
+     */
+    task_state_st state;
+    /**
+     * Number of numerals written or `SIZE_MAX` if the writing failed.
+     */
+    size_t written;
+} print_job_st;
+
+/**
+ * Start tracing an operation. This does nothing beyond a single comparison
+ * unless a hook is set for the calling thread.
+ *
+ * Arguments:
+ * - span: Structure that tracks the operation until "trace_end" is called.
+ * - operation: The name of the operation.
+ * - first: Number of digits in the first operand.
+ * - second: Number of digits in the second operand or 0 if there is none.
+ */
+static void trace_begin(
+    trace_span_st *span, const char *operation, size_t first, size_t second
+)
+{
+    span->counted = tracer.hook != NULL;
+    span->active = span->counted && tracer.depth == 0;
+
+    if (!span->counted) {
+        return;
+    }
+
+    tracer.depth++;
+
+    if (span->active) {
+        span->event = (bigint_trace_st) {operation, {first, second}, 0, 0};
+        clock_gettime(CLOCK_MONOTONIC, &span->start);
+    }
+}
+
+/**
+ * Finish tracing an operation and call the hook if the operation reached the
+ * size or duration set with "bigint_set_trace". This function preserves
+ * errno.
+ *
+ * Arguments:
+ * - span: The structure passed to "trace_begin".
+ * - result: The result of the operation or NULL if there is none.
+ */
+static void trace_end(trace_span_st *span, const bigint_st *result)
+{
+    size_t digits;
+    struct timespec end;
+
+    int saved_errno = errno;
+
+    if (!span->counted) {
+        return;
+    }
+
+    if (span->active && tracer.hook) {
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        span->event.result = result ? result->length : 0;
+        span->event.seconds = (double) (end.tv_sec - span->start.tv_sec) +
+            (double) (end.tv_nsec - span->start.tv_nsec) / 1e9;
+
+        digits = span->event.operands[0] + span->event.operands[1];
+        digits = digits > span->event.result ? digits : span->event.result;
+
+        if (
+            (tracer.min_digits && digits >= tracer.min_digits) || (
+                tracer.min_seconds > 0 &&
+                span->event.seconds >= tracer.min_seconds
+            )
+        ) {
+            tracer.hook(&span->event, tracer.context);
+        }
+    }
+
+    tracer.depth--;
+    errno = saved_errno;
+}
+
+#ifndef DIGIT_SUPER_TYPE
+/**
+ * Compute the sum of two unsigned, 64-bit integers.
+ *
+ * Arguments:
+ * - msb: Pointer where the upper 64 bits of the existing value and the result
+ *   are stored.
+ * - lsb: Pointer where the lower 64 bits of the existing value and the result
+ *   are stored.
+ */
+static void u128add64(uint64_t *msb, uint64_t *lsb, uint64_t addend)
+{
+    uint64_t new_lsb;
+
+    if (addend != 0) {
+        new_lsb = *lsb + addend;
+        *msb += new_lsb < *lsb;
+        *lsb = new_lsb;
+    }
+}
+
+/**
+ * Compute the product of two unsigned, 64-bit integers summed with an
+ * additional value.
+ *
+ * Arguments:
+ * - msb: Pointer where the upper 64 bits of the existing value and the result
+ *   are stored.
+ * - lsb: Pointer where the lower 64 bits of the existing value and the result
+ *   are stored.
+ * - a: Multiplicand.
+ * - b: Multiplicand.
+ * - c: Addend.
+ */
+static void u128fma64(
+    uint64_t *msb, uint64_t *lsb, uint64_t a, uint64_t b, uint64_t c
+)
+{
+    uint64_t al = a & (uint32_t) -1;
+    uint64_t ah = a >> 32;
+    uint64_t bl = b & (uint32_t) -1;
+    uint64_t bh = b >> 32;
+
+    uint64_t al_bl = al * bl;
+    uint64_t ah_bl = ah * bl;
+    uint64_t al_bh = al * bh;
+    uint64_t ah_bh = ah * bh;
+
+    uint64_t cross = (al_bl >> 32) + (ah_bl & (uint32_t) -1) + al_bh;
+
+    *msb = (ah_bl >> 32) + (cross >> 32) + ah_bh;
+    *lsb = (cross << 32) | (al_bl & (uint32_t) -1);
+
+    u128add64(msb, lsb, c);
+}
+
+/**
+ * Divide an unsigned, 128-bit integer by an unsigned, 64-bit integer. This is
+ * the "divlu" routine from _Hacker's Delight_: the quotient is computed as two
+ * 32-bit halves, each estimated from the upper half of the divisor and then
+ * corrected.
+ *
+ * Arguments:
+ * - msb: Upper 64 bits of the dividend. This must be less than the divisor.
+ * - lsb: Lower 64 bits of the dividend.
+ * - divisor: Divisor. Its most significant bit must be set.
+ * - remainder: Output pointer for the remainder.
+ *
+ * Return: The quotient.
+ */
+static uint64_t u128div64(
+    uint64_t msb, uint64_t lsb, uint64_t divisor, uint64_t *remainder
+)
+{
+    uint64_t partial;
+    uint64_t quotient_high;
+    uint64_t quotient_low;
+    uint64_t rest;
+
+    const uint64_t half = (uint64_t) 1 << 32;
+    uint64_t divisor_high = divisor >> 32;
+    uint64_t divisor_low = divisor & (uint32_t) -1;
+    uint64_t lsb_high = lsb >> 32;
+    uint64_t lsb_low = lsb & (uint32_t) -1;
+
+    quotient_high = msb / divisor_high;
+    rest = msb - quotient_high * divisor_high;
+
+    while (
+        quotient_high >= half ||
+        quotient_high * divisor_low > (rest << 32 | lsb_high)
+    ) {
+        quotient_high--;
+
+        if ((rest += divisor_high) >= half) {
+            break;
+        }
+    }
+
+    partial = (msb << 32 | lsb_high) - quotient_high * divisor;
+    quotient_low = partial / divisor_high;
+    rest = partial - quotient_low * divisor_high;
+
+    while (
+        quotient_low >= half ||
+        quotient_low * divisor_low > (rest << 32 | lsb_low)
+    ) {
+        quotient_low--;
+
+        if ((rest += divisor_high) >= half) {
+            break;
+        }
+    }
+
+    *remainder = (partial << 32 | lsb_low) - quotient_low * divisor;
+    return quotient_high << 32 | quotient_low;
+}
+#endif
+
+/**
+ * Compute the product of two digits summed with a third.
+ *
+ * Arguments:
+ * - a: Multiplicand.
+ * - b: Multiplicand.
+ * - c: Addend.
+ * - high: Output pointer for the most significant digit of the result.
+ *
+ * Return: The least significant digit of the result.
+ */
+static inline digit_tt digit_muladd(
+    digit_tt a, digit_tt b, digit_tt c, digit_tt *high
+)
+{
+#ifdef DIGIT_SUPER_TYPE
+    digit_super_tt result = (digit_super_tt) a * b + c;
+
+    *high = (digit_tt) (result >> DIGIT_BITS);
+    return (digit_tt) (DIGIT_MAX & result);
+#else
+    digit_tt low;
+
+    u128fma64(high, &low, a, b, c);
+    return low;
+#endif
+}
+
+/**
+ * Divide a two-digit value by a digit.
+ *
+ * Arguments:
+ * - high: Most significant digit of the dividend. This must be less than the
+ *   divisor so the quotient fits in a single digit.
+ * - low: Least significant digit of the dividend.
+ * - divisor: Divisor. Its most significant bit must be set.
+ * - remainder: Output pointer for the remainder.
+ *
+ * Return: The quotient.
+ */
+static inline digit_tt digit_divide(
+    digit_tt high, digit_tt low, digit_tt divisor, digit_tt *remainder
+)
+{
+#ifdef DIGIT_SUPER_TYPE
+    digit_super_tt dividend = (digit_super_tt) high << DIGIT_BITS | low;
+
+    *remainder = (digit_tt) (dividend % divisor);
+    return (digit_tt) (dividend / divisor);
+#else
+    return u128div64(high, low, divisor, remainder);
+#endif
+}
+
+/**
+ * This function works like _calloc(3)_, but when the total number of bytes
+ * would lead to an integer overflow, the allocation fails.
+ *
+ * Arguments:
+ * - nmemb: Number of members for which space should be allocated.
+ * - size: The size of each member for which space should be allocated.
+ *
+ * Return: A pointer to the allocated memory if the allocation succeeds.
+ */
+static void *safe_calloc(size_t nmemb, size_t size)
+{
+    void *ptr;
+
+    if (nmemb > SIZE_MAX / size) {
+        errno = EOVERFLOW;
+        return NULL;
+    }
+
+    if ((ptr = malloc(nmemb * size))) {
+        STATS_ADD(allocations, 1);
+        STATS_ADD(bytes, nmemb * size);
+    }
+
+    return ptr;
+}
+
+/**
+ * This function works like _reallocarray(3)_, but when the total number of
+ * bytes would lead to an integer overflow, the allocation fails.
+ *
+ * Arguments:
+ * - nmemb: Number of members for which space should be allocated.
  * - size: The size of each member for which space should be allocated.
  *
- * Return: A pointer to the allocated memory if the allocation succeeds.
+ * Return: A pointer to the allocated memory if the allocation succeeds.
+ */
+static void *safe_reallocarray(void *ptr, size_t nmemb, size_t size)
+{
+    void *new;
+
+    if (nmemb > SIZE_MAX / size) {
+        errno = EOVERFLOW;
+        return NULL;
+    }
+
+    if ((new = realloc(ptr, nmemb * size))) {
+        STATS_ADD(reallocations, 1);
+        STATS_ADD(bytes, nmemb * size);
+    }
+
+    return new;
+}
+
+/**
+ * Get the amount of memory the calling thread may still allocate for digits.
+ *
+ * Return: The number of bytes or `SIZE_MAX` if the thread has no limit.
+ */
+static size_t memory_available(void)
+{
+    if (!memory.limit) {
+        return SIZE_MAX;
+    }
+
+    return memory.used < memory.limit ? memory.limit - memory.used : 0;
+}
+
+/**
+ * Check whether the calling thread may allocate more digits without going
+ * over its memory limit.
+ *
+ * Arguments:
+ * - count: The number of digits.
+ *
+ * Return: 0 if the digits may be allocated and -1 with "errno" set to
+ * `ENOMEM` if they may not.
+ */
+static int memory_check(size_t count)
+{
+    if (count > memory_available() / sizeof(digit_tt)) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Allocate the digits of a big integer and charge them to the calling thread.
+ *
+ * Arguments:
+ * - count: The number of digits.
+ *
+ * Return: A pointer to the uninitialized digits or `NULL` if the allocation
+ * fails or would go over the memory limit of the thread.
+ */
+static digit_tt *digits_alloc(size_t count)
+{
+    digit_tt *digits;
+
+    if (memory_check(count)) {
+        return NULL;
+    }
+
+    if ((digits = safe_calloc(count, sizeof(digit_tt)))) {
+        memory.used += count * sizeof(digit_tt);
+    }
+
+    return digits;
+}
+
+/**
+ * Grow the digits of a big integer and charge the difference to the calling
+ * thread.
+ *
+ * Arguments:
+ * - digits: The digits to reallocate.
+ * - original: The number of digits that are currently allocated.
+ * - count: The new number of digits which must be greater than the original
+ *   number.
+ *
+ * Return: A pointer to the reallocated digits or `NULL` if the allocation
+ * fails or would go over the memory limit of the thread, in which case the
+ * original digits are left unchanged.
+ */
+static digit_tt *digits_grow(digit_tt *digits, size_t original, size_t count)
+{
+    if (memory_check(count - original)) {
+        return NULL;
+    }
+
+    if ((digits = safe_reallocarray(digits, count, sizeof(digit_tt)))) {
+        memory.used += (count - original) * sizeof(digit_tt);
+    }
+
+    return digits;
+}
+
+/**
+ * Change the length of a number and reallocate the space available for the
+ * digits as necessary.
+ *
+ * Arguments:
+ * - x: A big integer.
+ * - length: The new length.
+ *
+ * Return: 0 if the operation succeeds and -1 if it fails.
+ */
+static int resize(bigint_st *x, size_t length)
+{
+    size_t original_allocated = x->allocated;
+
+    while (length >= x->allocated) {
+        x->allocated *= 2;
+
+        // If doubling causes an overflow, just use the exact length provided.
+        if (x->allocated <= original_allocated) {
+            x->allocated = length;
+            break;
+        }
+    }
+
+    if (x->allocated > original_allocated) {
+        digit_tt *new;
+
+        STATS_ADD(resizes, 1);
+
+        // When doubling would go over the memory limit of the thread, only
+        // grow as much as needed.
+        if (
+            x->allocated > length + 1 &&
+            x->allocated - original_allocated >
+                memory_available() / sizeof(digit_tt)
+        ) {
+            x->allocated = length + 1;
+        }
+
+        if (!x->borrowed) {
+            new = digits_grow(x->digits, original_allocated, x->allocated);
+        } else if ((new = digits_alloc(x->allocated))) {
+            memcpy(new, x->digits, original_allocated * sizeof(digit_tt));
+        }
+
+        if (!new) {
+            x->allocated = original_allocated;
+            return -1;
+        }
+
+        x->digits = new;
+        x->borrowed = false;
+        memset(
+            x->digits + original_allocated,
+            0,
+            sizeof(digit_tt) * (x->allocated - original_allocated)
+        );
+    }
+
+    x->length = length;
+    return 0;
+}
+
+/**
+ * Change the length of a number and reallocate the space available for the
+ * digits as necessary to be the sum of two values. If that sum results in an
+ * overflow, this function will fail.
+ *
+ * Arguments:
+ * - x: A big integer.
+ * - a: Addend.
+ * - b: Addend.
+ *
+ * Return: 0 if the operation succeeds and -1 if it fails.
+ */
+static int resize_sum(bigint_st *x, size_t a, size_t b)
+{
+    size_t sum = a + b;
+
+    if (sum < a) {
+        errno = EOVERFLOW;
+        return -1;
+    }
+
+    return resize(x, sum);
+}
+
+/**
+ * A thin wrapper around _free(3)_ that ensures errno is preserved when the
+ * call returns. See also: <https://www.austingroupbugs.net/view.php?id=385>.
+ *
+ * Arguments:
+ *- ptr: Pointer to free.
+ */
+static void xfree(void *ptr)
+{
+    int saved_errno = errno;
+
+    if (ptr) {
+        STATS_ADD(frees, 1);
+    }
+
+    free(ptr);
+
+    errno = saved_errno;
+}
+
+/**
+ * Free the digits of a big integer unless they are borrowed, and credit them
+ * to the calling thread. This function preserves errno.
+ *
+ * Arguments:
+ * - x: A big integer.
+ */
+static void digits_free(bigint_st *x)
+{
+    size_t bytes = x->allocated * sizeof(digit_tt);
+
+    if (!x->borrowed && x->digits) {
+        xfree(x->digits);
+        memory.used = memory.used > bytes ? memory.used - bytes : 0;
+    }
+}
+
+/**
+ * Get the initial thread-local state of a task that the calling thread is
+ * about to fork.
+ *
+ * Return: The state.
+ */
+static task_state_st task_state_fork(void)
+{
+    return (task_state_st) {memory, memory.used, no_stats, 0};
+}
+
+/**
+ * Exchange the thread-local state of the calling thread with that of a task.
+ * This is called once before the task runs, which installs the state of the
+ * task, and once after, which restores that of the thread and leaves the
+ * final state of the task in its structure.
+ *
+ * Arguments:
+ * - state: The state of the task.
+ */
+static void task_state_swap(task_state_st *state)
+{
+    memory_st saved = memory;
+#ifdef COLLECT_STATS
+    bigint_stats_st counters = stats;
+#endif
+
+    memory = state->memory;
+    state->memory = saved;
+
+#ifdef COLLECT_STATS
+    stats = state->stats;
+    state->stats = counters;
+#endif
+}
+
+/**
+ * Add the memory a joined task left allocated and its counters to the
+ * calling thread, which must be the thread that forked it.
+ *
+ * Arguments:
+ * - state: The final state of the task.
+ */
+static void task_state_merge(const task_state_st *state)
+{
+    size_t freed;
+
+    if (state->memory.used >= state->used) {
+        memory.used += state->memory.used - state->used;
+    } else {
+        freed = state->used - state->memory.used;
+        memory.used = memory.used > freed ? memory.used - freed : 0;
+    }
+
+    STATS_MERGE(&state->stats);
+}
+
+/**
+ * Get the current value of a threshold.
+ *
+ * Arguments:
+ * - index: The index of the threshold in the table of thresholds.
+ *
+ * Return: The value of the threshold.
+ */
+static size_t threshold(unsigned index)
+{
+    return atomic_load_explicit(&thresholds[index].value, memory_order_relaxed);
+}
+
+/**
+ * Determines whether or not a big integer is a power of two.
+ *
+ * Arguments:
+ * - x: Big integer.
+ *
+ * Return: True if the number is a power of two or false otherwise.
+ */
+bool bigint_is_power_of_2(bigint_st *x)
+{
+    if (bigint_eqz(x)) {
+        return false;
+    }
+
+    for (size_t n = 0; n < x->length - 1; n++) {
+        if (x->digits[n] != 0) {
+            return false;
+        }
+    }
+
+    return POWER_OF_2(x->digits[x->length - 1]);
+}
+
+/**
+ * Release the resources associated with a big integer. This function is
+ * guaranteed to preserve errno.
+ *
+ * Arguments:
+ * - x: A big integer.
+ */
+void bigint_free(bigint_st *x)
+{
+    digits_free(x);
+    xfree(x);
+}
+
+/**
+ * Duplicate a big integer. The caller is responsible for calling "bigint_free"
+ * when the structure is no longer needed.
+ *
+ * Arguments:
+ * - x: Value to duplicate.
+ *
+ * Return: A pointer to the duplicated structure or `NULL` if it could not be
+ * duplicated in which case "errno" will be set appropriately.
+ */
+bigint_st *bigint_dup(bigint_st *x)
+{
+    bigint_st *new = safe_calloc(1, sizeof(*x));
+
+    STATS_OPERATION(dup, x->length);
+
+    if (!new) {
+        return NULL;
+    }
+
+    *new = *x;
+    new->borrowed = false;
+    new->digits = digits_alloc(x->allocated);
+
+    if (!new->digits) {
+        xfree(new);
+        return NULL;
+    }
+    memset(new->digits, 0, x->allocated * sizeof(digit_tt));
+
+    if (x->length != 0) {
+        memcpy(new->digits, x->digits, x->length * sizeof(digit_tt));
+    }
+
+    return new;
+}
+
+/**
+ * Return a value indicating whether the argument equals zero.
+ *
+ * Arguments:
+ * - x: Big integer.
+ *
+ * Return: 0 if the value equals zero, and a non-zero value otherwise.
+ */
+bool bigint_eqz(const bigint_st *x)
+{
+    return x->length == 0;
+}
+
+/**
+ * Return a value indicating whether the argument is not equal zero.
+ *
+ * Arguments:
+ * - x: Big integer.
+ *
+ * Return: 0 if the value equals zero, and a non-zero value otherwise.
+ */
+bool bigint_nez(const bigint_st *x)
+{
+    return x->length != 0;
+}
+
+/**
+ * Return a value indicating whether the argument is less than zero.
+ *
+ * Arguments:
+ * - x: Big integer.
+ *
+ * Return: A boolean value indicating whether the condition is true.
+ */
+bool bigint_ltz(const bigint_st *x)
+{
+    return x->negative;
+}
+
+/**
+ * Return a value indicating whether the argument is less than or equal to
+ * zero.
+ *
+ * Arguments:
+ * - x: Big integer.
+ *
+ * Return: A boolean value indicating whether the condition is true.
+ */
+bool bigint_lez(const bigint_st *x)
+{
+    return x->length == 0 || x->negative;
+}
+
+/**
+ * Return a value indicating whether the argument is greater than zero.
+ *
+ * Arguments:
+ * - x: Big integer.
+ *
+ * Return: A boolean value indicating whether the condition is true.
+ */
+bool bigint_gtz(const bigint_st *x)
+{
+    return !x->negative && x->length;
+}
+
+/**
+ * Return a value indicating whether the argument is greater than or equal to
+ * zero.
+ *
+ * Arguments:
+ * - x: Big integer.
+ *
+ * Return: A boolean value indicating whether the condition is true.
+ */
+bool bigint_gez(const bigint_st *x)
+{
+    return !x->negative;
+}
+
+/**
+ * Return the least of two big integers.
+ *
+ * Arguments:
+ * - a: A big integer.
+ * - b: A big integer.
+ *
+ * Return: The smaller of the two values.
+ */
+bigint_st *bigint_min(bigint_st *a, bigint_st *b)
+{
+    return bigint_cmp(a, b) <= 0 ? a : b;
+}
+
+/**
+ * Return the greatest of two big integers.
+ *
+ * Arguments:
+ * - a: A big integer.
+ * - b: A big integer.
+ *
+ * Return: The larger of the two values.
+ */
+bigint_st *bigint_max(bigint_st *a, bigint_st *b)
+{
+    return bigint_cmp(a, b) >= 0 ? a : b;
+}
+
+/**
+ * Assign the value of one big integer to another.
+ *
+ * Arguments:
+ * - dest: Destination value.
+ * - src: Source value.
+ *
+ * Return: 0 if the operation succeeds and -1 if it fails.
+ */
+int bigint_mov(bigint_st *dest, bigint_st *src)
+{
+    STATS_OPERATION(mov, src->length);
+
+    if (dest == src) {
+        return 0;
+    }
+
+    if (src->length > dest->allocated && resize(dest, src->length)) {
+        return -1;
+    }
+
+    memcpy(dest->digits, src->digits, src->length * sizeof(digit_tt));
+    dest->length = src->length;
+    dest->negative = src->negative;
+    return 0;
+}
+
+/**
+ * Assign the value of a standard integer to an existing big integer.
+ *
+ * Arguments:
+ * - dest: Destination value.
+ * - src: Source value.
+ */
+void bigint_movi(bigint_st *dest, intmax_t src)
+{
+    uintmax_t magnitude;
+    size_t offset;
+
+    dest->negative = src < 0;
+
+    if (src == 0) {
+        dest->length = 0;
+        return;
+    }
+
+    if (src > 0) {
+        magnitude = (uintmax_t) src;
+    } else {
+#if (INTMAX_MIN + INTMAX_MAX) >= 0
+        magnitude = (uintmax_t) -src;
+#else
+        if (src == INTMAX_MIN) {
+            magnitude = INTMAX_MIN_MAGNITUDE;
+        } else {
+            magnitude = (uintmax_t) -src;
+        }
+#endif
+    }
+
+    if (DIGIT_BITS >= sizeof(magnitude) * CHAR_BIT) {
+        dest->length = 1;
+        dest->digits[0] = (digit_tt) magnitude;
+    } else {
+        offset = 0;
+
+        while (magnitude != 0) {
+            dest->digits[offset++] = magnitude & DIGIT_MAX;
+            magnitude >>= DIGIT_BITS;
+        }
+
+        dest->length = offset;
+    }
+}
+
+/**
+ * Assign the value of an unsigned integer to an existing big integer.
+ *
+ * Arguments:
+ * - dest: Destination value.
+ * - src: Source value.
+ */
+void bigint_movui(bigint_st *dest, uintmax_t src)
+{
+    size_t offset;
+
+    dest->negative = false;
+
+    if (src == 0) {
+        dest->length = 0;
+    } else if (DIGIT_BITS >= sizeof(src) * CHAR_BIT) {
+        dest->length = 1;
+        dest->digits[0] = (digit_tt) src;
+    } else {
+        offset = 0;
+
+        while (src != 0) {
+            dest->digits[offset++] = src & DIGIT_MAX;
+            src >>= DIGIT_BITS;
+        }
+
+        dest->length = offset;
+    }
+}
+
+/**
+ * Create a big integer from a standard unsigned integer.
+ *
+ * Arguments:
+ * - value: Value of integer.
+ *
+ * Return: A pointer to a big integer if the instantiation succeeds and `NULL`
+ * otherwise.
+ */
+bigint_st *bigint_from_uint(uintmax_t value)
+{
+    bigint_st *x;
+
+    x = safe_calloc(1, sizeof(bigint_st));
+
+    if (!x) {
+        return NULL;
+    }
+
+    // The minimum allocation is enough to for two intmax_t reducing the
+    // likelihood of reallocations when working with smaller values.
+    x->allocated = 2 * DIGITS_FOR_INTMAX;
+    x->borrowed = false;
+    x->digits = digits_alloc(x->allocated);
+
+    if (!x->digits) {
+        xfree(x);
+        return NULL;
+    }
+
+    bigint_movui(x, value);
+    return x;
+}
+
+/**
+ * Create a big integer from a standard integer.
+ *
+ * Arguments:
+ * - value: Value of integer.
+ *
+ * Return: A pointer to a big integer if the instantiation succeeds and `NULL`
+ * otherwise.
+ */
+bigint_st *bigint_from_int(intmax_t value)
+{
+    bigint_st *x;
+
+    x = safe_calloc(1, sizeof(bigint_st));
+
+    if (!x) {
+        return NULL;
+    }
+
+    // The minimum allocation is enough to for two intmax_t reducing the
+    // likelihood of reallocations when working with smaller values.
+    x->allocated = 2 * DIGITS_FOR_INTMAX;
+    x->borrowed = false;
+    x->digits = digits_alloc(x->allocated);
+
+    if (!x->digits) {
+        xfree(x);
+        return NULL;
+    }
+
+    bigint_movi(x, value);
+    return x;
+}
+
+/**
+ * Create a big integer from a double. Any fractional part of the value is
+ * discarded, so the result is rounded towards zero.
+ *
+ * Arguments:
+ * - value: A finite double.
+ *
+ * Return: A pointer to a big integer if the instantiation succeeds and `NULL`
+ * otherwise. If the value is infinite or not a number, "errno" is set to
+ * `EDOM`.
+ */
+bigint_st *bigint_from_double(double value)
+{
+    int exponent;
+    uint64_t mantissa;
+    bigint_st *x;
+
+    if (isnan(value) || isinf(value)) {
+        errno = EDOM;
+        return NULL;
+    }
+
+    // Scaling the fraction returned by frexp(3) by the width of the double's
+    // mantissa always produces an integer that can be stored without loss.
+    mantissa = (uint64_t) ldexp(
+        frexp(fabs(trunc(value)), &exponent), DBL_MANT_DIG
+    );
+    exponent -= DBL_MANT_DIG;
+
+    if (exponent < 0) {
+        mantissa >>= -exponent;
+        exponent = 0;
+    }
+
+    if (!(x = bigint_from_uint(mantissa))) {
+        return NULL;
+    }
+
+    if (!bigint_shli(x, x, (size_t) exponent)) {
+        bigint_free(x);
+        return NULL;
+    }
+
+    x->negative = value < 0 && bigint_nez(x);
+    return x;
+}
+
+/**
+ * Count the number of leading zeroes in the bits of the most significant digit
+ * of a big integer.
+ *
+ * Arguments:
+ * - x: A big integer.
+ *
+ * Return: The number of leading zeroes.
+ */
+static inline size_t clz(bigint_st *x)
+{
+    size_t result = 0;
+    digit_tt msd = x->digits[x->length - 1];
+    digit_tt mask = (digit_tt) 1 << (DIGIT_BITS - 1);
+
+    while ((mask & msd) == 0) {
+        mask >>= 1;
+        result++;
+    }
+
+    return result;
+}
+
+/**
+ * Count the number of trailing zeroes of a big integer.
+ *
+ * Arguments:
+ * - x: A big integer.
+ *
+ * Return: The number of leading zeroes.
+ */
+static inline size_t ctz(bigint_st *x)
+{
+    digit_tt digit;
+
+    size_t result = 0;
+
+    for (size_t n = 0; n < x->length; n++) {
+        digit = x->digits[n];
+
+        if (x->digits[n] == 0) {
+            result += DIGIT_BITS;
+        } else {
+            while ((digit & 1) == 0) {
+                result++;
+                digit >>= 1;
+            }
+
+            break;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Get the number of bits needed to represent the magnitude of a big integer.
+ *
+ * Arguments:
+ * - x: A big integer.
+ *
+ * Return: The position of the most significant non-zero bit plus one or 0 if
+ * the value is 0.
+ */
+static inline size_t bit_length(bigint_st *x)
+{
+    return bigint_eqz(x) ? 0 : DIGIT_BITS * x->length - clz(x);
+}
+
+/**
+ * Extract a run of consecutive bits from the magnitude of a big integer. Bits
+ * beyond the most significant digit are treated as zeroes.
+ *
+ * Arguments:
+ * - x: A big integer.
+ * - from: Index of the least significant bit to extract.
+ * - count: Number of bits to extract. This must not be more than 64.
+ *
+ * Return: The extracted bits with the bit at index "from" stored in the least
+ * significant position.
+ */
+static uint64_t magnitude_bits(bigint_st *x, size_t from, size_t count)
+{
+    size_t index = from / DIGIT_BITS;
+    size_t offset = from % DIGIT_BITS;
+    uint64_t result = 0;
+    size_t filled = 0;
+
+    while (filled < count && index < x->length) {
+        result |= (uint64_t) (x->digits[index++] >> offset) << filled;
+        filled += DIGIT_BITS - offset;
+        offset = 0;
+    }
+
+    if (count < 64) {
+        result &= ((uint64_t) 1 << count) - 1;
+    }
+
+    return result;
+}
+
+/**
+ * Determine whether any of the least significant bits of a big integer are
+ * set.
+ *
+ * Arguments:
+ * - x: A big integer.
+ * - count: The number of bits to examine.
+ *
+ * Return: True if any of the bits are set and false otherwise.
+ */
+static bool magnitude_any_bits(bigint_st *x, size_t count)
+{
+    size_t n;
+
+    for (n = 0; n < count / DIGIT_BITS && n < x->length; n++) {
+        if (x->digits[n] != 0) {
+            return true;
+        }
+    }
+
+    return (
+        n < x->length && count % DIGIT_BITS != 0 &&
+        (x->digits[n] & (((digit_tt) 1 << count % DIGIT_BITS) - 1)) != 0
+    );
+}
+
+/**
+ * Reduce the length of the big integer to exclude any leading zeroes and
+ * ensure the "negative" struct value is set to false if the value of the
+ * integer is 0.
+ *
+ * Arguments:
+ * - x: Big integer.
+ */
+static void normalize(bigint_st *x)
+{
+    while (x->length && !x->digits[x->length - 1]) {
+        x->length--;
+    }
+
+    if (x->length == 0) {
+        x->negative = false;
+    }
+}
+
+/**
+ * Decrement the magnitude of a non-zero number by 1.
+ *
+ * Arguments:
+ * - x: A non-zero big integer.
+ *
+ * Return: 0 if the operation succeeds or a negative value otherwise.
+ */
+static int magnitude_dec(bigint_st *x)
+{
+    x->digits[0]--;
+
+    if (x->digits[0] == DIGIT_MAX) {
+        for (size_t i = 1; i < x->length; i++) {
+            if (x->digits[i] != 0) {
+                x->digits[i]--;
+                break;
+            }
+
+            x->digits[i] = DIGIT_MAX;
+        }
+    }
+
+    normalize(x);
+    return 0;
+}
+
+/**
+ * Increment the magnitude of a number by 1.
+ *
+ * Arguments:
+ * - x: A big integer.
+ *
+ * Return: 0 if the operation succeeds or a negative value otherwise.
+ */
+static int magnitude_inc(bigint_st *x)
+{
+    digit_tt sum;
+
+    digit_tt carry = 1;
+
+    for (size_t i = 0; i < x->length; i++) {
+        sum = x->digits[i] + carry;
+        carry = sum < x->digits[i];
+        x->digits[i] = sum & DIGIT_MAX;
+    }
+
+    if (carry != 0) {
+        if (resize_sum(x, x->length, 1)) {
+            return -1;
+        }
+
+        x->digits[x->length - 1] = carry;
+    }
+
+    normalize(x);
+    return 0;
+}
+
+/**
+ * Compare the magnitude value of two big integers to determine if the first
+ * argument is greater than, equal to or less than the second argument.
+ *
+ * Arguments:
+ * - a: A big integer.
+ * - b: A big integer.
+ *
+ * Return: A positive number if "a" has a greater magnitude than "b", 0 if the
+ * magnitude of "a" equals "b" and a negative number if the magnitude "a" is
+ * less than "b".
+ */
+static int magnitude_cmp(const bigint_st *a, const bigint_st *b)
+{
+    digit_tt a_digit;
+    digit_tt b_digit;
+
+    int cmp = 0;
+
+    if (a->length != 0 && a->length == b->length) {
+        // We can't use memcmp here because the digits are stored with the
+        // least significant digit at index 0 and, for digits with a width of
+        // more than one character, due to differences in endianess on
+        // different architectures.
+        size_t index = a->length - 1;
+
+        while (1) {
+            a_digit = a->digits[index];
+            b_digit = b->digits[index];
+            cmp = (a_digit > b_digit) - (a_digit < b_digit);
+
+            if (cmp != 0 || index-- == 0) {
+                break;
+            }
+        }
+    } else {
+        cmp = (a->length > b->length) - (a->length < b->length);
+    }
+
+    return cmp;
+}
+
+/**
+ * Compute the difference in magnitude of two big integers.
+ *
+ * **WARNING:** The minuend must be greater than or equal the subtrahend or
+ * this function will not work correctly.
+ *
+ * Arguments:
+ * - dest: Pointer to the output destination.
+ * - m: Minuend.
+ * - s: Subtrahend.
+ *
+ * Return: A big integer containing the difference in the magnitudes.
+ */
+static bigint_st *magnitude_delta(bigint_st *dest, bigint_st *m, bigint_st *s)
+{
+    bool copied_minuend = false;
+
+    // If either input is also the output, the length will be mutated, so we
+    // need to save the original values.
+    size_t m_length = m->length;
+    size_t s_length = s->length;
+
+    if (resize(dest, m->length)) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < m_length; i++) {
+        if (i < s_length) {
+            // If the minuend's digit is less than the subtrahend's, borrow
+            // from the following digits of the minuend. The borrow logic
+            // mutates the minuend, so we first make a copy of the original
+            // minuend if the output pointer is not also the minuend.
+            //
+            // Note that we do not modify the subtrahend's digit. When doing
+            // this on paper with base 10, the subtrahend's digit would have 10
+            // added to it. In this library, that would be analogous to
+            // `DIGIT_MAX + 1`. However, unsigned integers use two's complement
+            // making adding `DIGIT_MAX + 1` a no-op.
+            if (m->digits[i] < s->digits[i]) {
+                if (m != dest && !copied_minuend) {
+                    if (!(m = bigint_dup(m))) {
+                        return NULL;
+                    }
+
+                    copied_minuend = true;
+                }
+
+                for (size_t j = i + 1; j < m_length; j++) {
+                    if (m->digits[j] != 0) {
+                        m->digits[j]--;
+                        break;
+                    }
+
+                    m->digits[j] = DIGIT_MAX;
+                }
+            }
+
+            dest->digits[i] = m->digits[i] - s->digits[i];
+        } else {
+            dest->digits[i] = m->digits[i];
+        }
+    }
+
+    if (copied_minuend) {
+        bigint_free(m);
+    }
+
+    normalize(dest);
+    return dest;
+}
+
+/**
+ * Compute the sum of the magnitude of two big integers.
+ *
+ * Arguments:
+ * - dest: Pointer to the output destination.
+ * - a: Addend.
+ * - b: Addend.
+ *
+ * Return: A big integer containing the sums of the magnitudes.
+ */
+static bigint_st *magnitude_sum(bigint_st *dest, bigint_st *a, bigint_st *b)
+{
+    digit_tt sum;
+
+    // We store these separately in case one of the inputs is the dest.
+    size_t a_length = a->length;
+    size_t b_length = b->length;
+    size_t max_length = a_length > b_length ? a_length : b_length;
+
+    bool carry = false;
+
+    if (bigint_eqz(a) && bigint_eqz(b)) {
+        bigint_movui(dest, 0);
+        goto done;
+    }
+
+    if (resize(dest, max_length)) {
+        return NULL;
+    }
+
+    for (size_t offset = 0; offset < max_length; offset++) {
+        if (offset >= a_length) {
+            sum = b->digits[offset] + carry;
+            carry = sum < b->digits[offset];
+        } else if (offset >= b_length) {
+            sum = a->digits[offset] + carry;
+            carry = sum < a->digits[offset];
+        } else {
+            sum = a->digits[offset] + carry;
+            carry = sum < a->digits[offset];
+            sum += b->digits[offset];
+            carry |= sum < b->digits[offset];
+        }
+
+        dest->digits[offset] = sum;
+    }
+
+    if (carry != 0) {
+        if (resize_sum(dest, dest->length, 1)) {
+            return NULL;
+        }
+
+        dest->digits[max_length] = carry;
+    }
+
+done:
+    normalize(dest);
+    return dest;
+}
+
+/**
+ * Verify that the library was built with a usable configuration. Calling this
+ * function is optional: all of the constant data used by the library is
+ * generated at compile time, so there is nothing to initialize, and this
+ * function is thread safe.
+ *
+ * Return: 0 if the operation succeeds and a negative number if it fails. When
+ * specified, the digit super type must be at least twice the width of the base
+ * digit type. If this is not the case, this function will set "errno" to
+ * `ENOTRECOVERABLE` when it fails.
+ */
+int bigint_init(void)
+{
+#ifdef DIGIT_SUPER_TYPE
+    if (sizeof(digit_super_tt) / sizeof(digit_tt) < 2) {
+        errno = ENOTRECOVERABLE;
+        return -1;
+    }
+#endif
+
+    return 0;
+}
+
+/**
+ * Convert a big integer to a standard unsigned integer. If the big integer
+ * cannot be represented as an uintmax_t value, "errno" will be set to
+ * `ERANGE`.
+ *
+ * Arguments:
+ * - x: Big integer.
+ *
+ * Return: A normal integer representing the value.
+ */
+uintmax_t bigint_toui(bigint_st *x)
+{
+    uintmax_t accumulator = 0;
+    uintmax_t previous_accumulator = 0;
+
+    if (x->negative) {
+        errno = ERANGE;
+        return 0;
+    }
+
+    if (x->length > DIGITS_FOR_INTMAX) {
+        errno = ERANGE;
+        return UINTMAX_MAX;
+    }
+
+    for (size_t n = 0; n < x->length; n++) {
+        if (!x->digits[n]) {
+            continue;
+        }
+
+        accumulator |= (uintmax_t) x->digits[n] << (n * DIGIT_BITS);
+
+        if (accumulator <= previous_accumulator) {
+            errno = ERANGE;
+            return UINTMAX_MAX;
+        }
+
+        previous_accumulator = accumulator;
+    }
+
+    return accumulator;
+}
+
+/**
+ * Convert a big integer to a standard integer. If the big integer cannot be
+ * represented as an intmax_t value, "errno" will be set to `ERANGE`.
+ *
+ * Arguments:
+ * - x: Big integer.
+ *
+ * Return: A normal integer representing the value.
+ */
+intmax_t bigint_toi(bigint_st *x)
+{
+    uintmax_t accumulator = 0;
+
+    for (size_t n = 0; n < x->length; n++) {
+        if (!x->digits[n]) {
+            continue;
+        }
+
+        // Shifting by the width of the type is undefined, so any non-zero
+        // digit beyond the ones that fit is reported as an overflow.
+        if (n >= DIGITS_FOR_INTMAX) {
+            errno = ERANGE;
+            return x->negative ? INTMAX_MIN : INTMAX_MAX;
+        }
+
+        accumulator |= (uintmax_t) x->digits[n] << (n * DIGIT_BITS);
+    }
+
+    if (!x->negative) {
+        if (accumulator > (uintmax_t) INTMAX_MAX) {
+            errno = ERANGE;
+            return INTMAX_MAX;
+        }
+
+        return (intmax_t) accumulator;
+    }
+
+    if (accumulator > INTMAX_MIN_MAGNITUDE) {
+        errno = ERANGE;
+        return INTMAX_MIN;
+    }
+
+#if (INTMAX_MIN + INTMAX_MAX) >= 0
+    return -((intmax_t) accumulator);
+#else
+    if (accumulator <= INTMAX_MAX) {
+        return -((intmax_t) accumulator);
+    } else {
+        // This works even if signed integers don't use two's complement.
+        return -INTMAX_MAX - (intmax_t) (accumulator - INTMAX_MAX);
+    }
+#endif
+}
+
+/**
+ * Convert the magnitude of a big integer to a double that still needs to be
+ * scaled by a power of two. The result is correctly rounded to the nearest
+ * representable value with ties going to the even value. Only the most
+ * significant 64 bits are inspected unless they describe an exact tie, so
+ * this function runs in constant time for practically every input.
+ *
+ * Arguments:
+ * - shift: Output pointer for the power of two the returned value must be
+ *   multiplied by to produce the magnitude.
+ * - x: A non-zero big integer.
+ *
+ * Return: An integral double representing the most significant bits of the
+ * magnitude.
+ */
+static double magnitude_tod(size_t *shift, bigint_st *x)
+{
+    uint64_t mantissa;
+
+    size_t bits = bit_length(x);
+
+    if (bits <= 64) {
+        *shift = 0;
+        return (double) magnitude_bits(x, 0, bits);
+    }
+
+    *shift = bits - 64;
+    mantissa = magnitude_bits(x, *shift, 64);
+
+    // Converting the 64-bit value to a double already rounds to the nearest
+    // even value, but the conversion cannot see the bits that were truncated.
+    // They only change the outcome when the discarded part of the mantissa is
+    // exactly half of the last place, in which case any non-zero truncated bit
+    // means the value must be rounded up instead of to even.
+    if ((mantissa & TOD_ROUNDING_MASK) == TOD_ROUNDING_HALF &&
+      magnitude_any_bits(x, *shift)) {
+        mantissa |= 1;
+    }
+
+    return (double) mantissa;
+}
+
+/**
+ * Convert a big integer to a double. If the big integer cannot be represented
+ * as a double, generally because the exponent is too large, "errno" will be
+ * set to `EOVERFLOW` and a value representing infinity is returned. When the
+ * integer exceeds the precision of the double's mantissa, the result is
+ * rounded to the nearest representable value with ties rounded to even.
+ *
+ * Arguments:
+ * - x: Big integer.
+ *
+ * Return: A double representing the value.
+ */
+double bigint_tod(bigint_st *x)
+{
+    size_t shift;
+    double value;
+
+    STATS_OPERATION(tod, x->length);
+
+    if (bigint_eqz(x)) {
+        return 0.0;
+    }
+
+    value = magnitude_tod(&shift, x);
+
+    if (shift > DBL_MAX_EXP || (value = ldexp(value, (int) shift)) > DBL_MAX) {
+        errno = EOVERFLOW;
+        value = HUGE_VAL;
+    }
+
+    return x->negative ? -value : value;
+}
+
+/**
+ * Convert a big integer to a double in the range [0.5, 1) and a power of two
+ * it must be multiplied by to get the original value. Unlike "bigint_tod",
+ * this cannot overflow. The fraction is rounded the same way "bigint_tod"
+ * rounds its results.
+ *
+ * Arguments:
+ * - exponent: Output pointer for the power of two. When "x" is 0, this is set
+ *   to 0.
+ * - x: Big integer.
+ *
+ * Return: A double whose magnitude is in the range [0.5, 1) or 0.0 if "x" is
+ * 0. The sign of the double matches the sign of the big integer.
+ */
+double bigint_tod_2exp(size_t *exponent, bigint_st *x)
+{
+    int scale;
+    size_t shift;
+    double value;
+
+    STATS_OPERATION(tod, x->length);
+
+    if (bigint_eqz(x)) {
+        *exponent = 0;
+        return 0.0;
+    }
+
+    // Rounding may carry into the next power of two, so the scale is taken
+    // from the rounded value rather than from the bit length of "x".
+    value = frexp(magnitude_tod(&shift, x), &scale);
+    *exponent = shift + (size_t) scale;
+    return x->negative ? -value : value;
+}
+
+/**
+ * Perform a left shift on a big integer with the number of bits specified as
+ * a standard integer.
+ *
+ * Arguments:
+ * - x: A big integer.
+ * - n: Number of bits to shift left.
+ *
+ * Return: The result of the calculation or `NULL` if there was an error.
+ */
+bigint_st *bigint_shli(bigint_st *dest, bigint_st *x, size_t n)
+{
+    int from;
+    digit_tt lsb;
+    digit_tt msb;
+    size_t msb_shift;
+    size_t offset;
+    size_t original_length;
+    size_t new_digits;
+
+    bool free_on_error = false;
+
+    STATS_OPERATION(shli, x->length);
+
+    if (!dest) {
+        if (!(dest = bigint_dup(x))) {
+            return NULL;
+        }
+
+        free_on_error = true;
+    }
+
+    // If the shift is 0 or the value is 0, this function is a no-op.
+    if (n == 0 || bigint_eqz(x)) {
+        if (bigint_mov(dest, x)) {
+            if (free_on_error) {
+                bigint_free(dest);
+            }
+
+            return NULL;
+        }
+
+        goto done;
+    }
+
+    offset = n % DIGIT_BITS;
+    original_length = x->length;
+    new_digits = n / DIGIT_BITS + (offset != 0);
+
+    if (resize_sum(dest, x->length, new_digits)) {
+        if (free_on_error) {
+            bigint_free(dest);
+        }
+
+        return NULL;
+    }
+
+    if (offset == 0) {
+        for (size_t i = 0; i < original_length; i++) {
+            dest->digits[original_length - 1 - i + new_digits] = (
+                x->digits[original_length - 1 - i]
+            );
+        }
+    } else {
+        // When the shifts are not aligned with digit boundaries, "n" bits come
+        // from one digit and a complementary number of bits (`DIGIT_BITS - n`)
+        // come from another.
+        msb_shift = DIGIT_BITS - offset;
+
+        for (size_t i = 0; i <= original_length; i++) {
+            from = (int) (original_length - i);
+            msb = from < 1 ? 0 : x->digits[from - 1];
+            lsb = from >= (int) original_length ? 0 : x->digits[from];
+            dest->digits[(size_t) from + new_digits - 1] = (
+                (lsb << offset | msb >> msb_shift) & DIGIT_MAX
+            );
+        }
+    }
+
+    // Zero out any holes that were created.
+    memset(dest->digits, 0, sizeof(digit_tt) * (new_digits - (offset != 0)));
+
+done:
+    dest->negative = x->negative;
+    normalize(dest);
+    return dest;
+}
+
+/**
+ * Perform a left shift with big integers.
+ *
+ * Arguments:
+ * - x: A big integer.
+ * - n: Number of bits to shift left.
+ *
+ * Return: The result of the calculation or `NULL` if there was an error.
+ */
+bigint_st *bigint_shl(bigint_st *dest, bigint_st *x, bigint_st* n)
+{
+    uintmax_t bits;
+
+    if (bigint_ltz(n)) {
+        errno = EDOM;
+    } else {
+        errno = 0;
+        bits = bigint_toui(n);
+
+        if (errno == 0) {
+            return bigint_shli(dest, x, (size_t) bits);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Perform a right shift on a big integer with the number of bits specified as
+ * a standard integer.
+ *
+ * Arguments:
+ * - x: A big integer.
+ * - n: Number of bits to shift right.
+ *
+ * Return: The result of the calculation or `NULL` if there was an error.
+ */
+bigint_st *bigint_shri(bigint_st *dest, bigint_st *x, size_t n)
+{
+    digit_tt lsb;
+    digit_tt msb;
+    size_t offset;
+    size_t shifted_digits;
+
+    bool free_on_error = false;
+    bool negative = x->negative;
+    size_t length = x->length;
+
+    STATS_OPERATION(shri, x->length);
+
+    if (!dest) {
+        if (!(dest = bigint_from_int(0))) {
+            return NULL;
+        }
+
+        free_on_error = true;
+    }
+
+    // If the shift is 0 or the value is 0, this function is a no-op.
+    if (n == 0 || bigint_eqz(x)) {
+        if (bigint_mov(dest, x)) {
+            goto error;
+        }
+
+        goto done;
+    }
+
+    if (n / DIGIT_BITS >= length) {
+        bigint_movui(dest, 0);
+        goto done;
+    }
+
+    offset = n % DIGIT_BITS;
+    shifted_digits = n / DIGIT_BITS;
+
+    // Shrinking never reallocates, so when the destination is also the
+    // source, its digits stay where they are.
+    if (resize(dest, length - shifted_digits)) {
+        goto error;
+    }
+
+    // Every digit of the result is read from the same position or a higher
+    // one in the source, so the source can be overwritten in place.
+    for (size_t from, i = 0; i < length - shifted_digits; i++) {
+        from = i + shifted_digits;
+        lsb = x->digits[from];
+
+        if (offset == 0) {
+            dest->digits[i] = lsb;
+        } else {
+            // As with the left shift logic, shifts for unaligned offsets
+            // depend on two digits instead of one.
+            msb = from + 1 < length ? x->digits[from + 1] : 0;
+            dest->digits[i] = DIGIT_MAX & (
+                msb << (DIGIT_BITS - offset) | lsb >> offset
+            );
+        }
+    }
+
+done:
+    dest->negative = negative;
+    normalize(dest);
+    return dest;
+
+error:
+    if (free_on_error) {
+        bigint_free(dest);
+    }
+
+    return NULL;
+}
+
+/**
+ * Perform a right shift with big integers.
+ *
+ * Arguments:
+ * - x: A big integer.
+ * - n: Number of bits to shift right.
+ *
+ * Return: The result of the calculation or `NULL` if there was an error.
+ */
+bigint_st *bigint_shr(bigint_st *dest, bigint_st *x, bigint_st* n)
+{
+    uintmax_t bits;
+
+    if (bigint_ltz(n)) {
+        errno = EDOM;
+    } else {
+        errno = 0;
+        bits = bigint_toui(n);
+
+        if (errno == 0) {
+            return bigint_shri(dest, x, bits);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Compare two big integers to determine if the first argument is greater than,
+ * equal to or less than the second argument.
+ *
+ * Arguments:
+ * - a: A big integer.
+ * - b: A big integer.
+ *
+ * Return: A positive number if "a" is greater than "b", 0 if "a" equals "b"
+ * and a negative number if "a" is less than "b".
+ */
+int bigint_cmp(const bigint_st *a, const bigint_st *b)
+{
+    int cmp;
+
+    STATS_OPERATION(cmp, a->length + b->length);
+
+    if (a->negative == b->negative) {
+        cmp = magnitude_cmp(a, b);
+        return a->negative ? -cmp : cmp;
+    }
+
+    return a->negative ? -1 : 1;
+}
+
+/**
+ * Get a byte of the sort key of a magnitude. The key is the number of digits
+ * followed by the digits from the most significant, both with their most
+ * significant byte first, so comparing keys byte by byte orders magnitudes.
+ *
+ * Arguments:
+ * - x: A big integer.
+ * - index: Index of the byte, which must be less than the length of the key.
+ *
+ * Return: The byte.
+ */
+static unsigned char sort_key_byte(const bigint_st *x, size_t index)
+{
+    digit_tt digit;
+
+    if (index < sizeof(size_t)) {
+        return x->length >> (CHAR_BIT * (sizeof(size_t) - 1 - index));
+    }
+
+    index -= sizeof(size_t);
+    digit = x->digits[x->length - 1 - index / sizeof(digit_tt)];
+    index = sizeof(digit_tt) - 1 - index % sizeof(digit_tt);
+    return digit >> (CHAR_BIT * index);
+}
+
+/**
+ * Sort big integers by magnitude with a most significant byte first radix
+ * sort of their keys, which only reads the digits that tell values apart.
+ * Buckets other than the largest are sorted recursively and the largest in
+ * the same call, which bounds the depth of the recursion by the logarithm of
+ * the number of values.
+ *
+ * Arguments:
+ * - values: Values whose keys are equal before the given byte.
+ * - scratch: Space for as many pointers as there are values.
+ * - bytes: Space for as many bytes as there are values, which holds the
+ *   current byte of each key so every value is only read once per pass.
+ * - count: Number of values.
+ * - index: Index of the first byte of the keys that may differ.
+ */
+static void sort_magnitudes(
+    bigint_st **values, bigint_st **scratch, unsigned char *bytes,
+    size_t count, size_t index
+)
+{
+    size_t counts[UCHAR_MAX + 1];
+    size_t largest;
+    size_t offsets[UCHAR_MAX + 1];
+    size_t start;
+    bigint_st *value;
+
+    while (count >= SORT_RADIX_MIN) {
+        // Keys are equal up to here, so they all end at the same byte once
+        // the lengths have been compared.
+        if (index >= sizeof(size_t) + values[0]->length * sizeof(digit_tt)) {
+            return;
+        }
+
+        memset(counts, 0, sizeof(counts));
+
+        for (size_t i = 0; i < count; i++) {
+            bytes[i] = sort_key_byte(values[i], index);
+            counts[bytes[i]]++;
+        }
+
+        largest = 0;
+        start = 0;
+
+        for (size_t i = 0; i <= UCHAR_MAX; i++) {
+            offsets[i] = start;
+            start += counts[i];
+            largest = counts[i] > counts[largest] ? i : largest;
+        }
+
+        if (counts[largest] < count) {
+            for (size_t i = 0; i < count; i++) {
+                scratch[offsets[bytes[i]]++] = values[i];
+            }
+
+            memcpy(values, scratch, count * sizeof(*values));
+
+            for (size_t i = 0; i <= UCHAR_MAX; i++) {
+                if (i != largest && counts[i] > 1) {
+                    sort_magnitudes(
+                        values + offsets[i] - counts[i], scratch, bytes,
+                        counts[i], index + 1
+                    );
+                }
+            }
+
+            values += offsets[largest] - counts[largest];
+            count = counts[largest];
+        }
+
+        index++;
+    }
+
+    for (size_t i = 1; i < count; i++) {
+        value = values[i];
+        start = i;
+
+        while (start > 0 && magnitude_cmp(values[start - 1], value) > 0) {
+            values[start] = values[start - 1];
+            start--;
+        }
+
+        values[start] = value;
+    }
+}
+
+/**
+ * Find the first byte of the sort keys of a group of magnitudes that is not
+ * zero in every key. The lengths of most groups fit in a byte or two, so
+ * this skips the passes over the leading bytes of the lengths.
+ *
+ * Arguments:
+ * - lengths: Bitwise OR of the lengths of the magnitudes.
+ *
+ * Return: Index of the byte.
+ */
+static size_t sort_key_start(size_t lengths)
+{
+    size_t index = 0;
+
+    while (
+        index < sizeof(size_t) &&
+        !(lengths >> (CHAR_BIT * (sizeof(size_t) - 1 - index)))
+    ) {
+        index++;
+    }
+
+    return index;
+}
+
+/**
+ * Sort big integers in ascending order. Values are grouped by sign and
+ * ordered by their number of digits and then by a radix sort of the digits,
+ * which reads each digit at most once per pass and only as far as is needed
+ * to tell values apart, instead of comparing pairs of values.
+ *
+ * Arguments:
+ * - values: Pointers to the values to sort, which are reordered in place.
+ * - count: Number of values.
+ *
+ * Return: 0 if the operation succeeds and -1 if the memory for the sort
+ * could not be allocated.
+ */
+int bigint_sort(bigint_st **values, size_t count)
+{
+    unsigned char *bytes;
+    size_t nonnegatives;
+    bigint_st **scratch;
+
+    size_t lengths[2] = {0, 0};
+    size_t negatives = 0;
+
+    if (count < 2) {
+        return 0;
+    }
+
+    scratch = safe_calloc(count, sizeof(*scratch));
+    bytes = safe_calloc(count, sizeof(*bytes));
+
+    if (!scratch || !bytes) {
+        xfree(scratch);
+        xfree(bytes);
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        negatives += values[i]->negative;
+        lengths[values[i]->negative] |= values[i]->length;
+    }
+
+    nonnegatives = negatives;
+
+    for (size_t i = 0, j = 0; i < count; i++) {
+        if (values[i]->negative) {
+            scratch[j++] = values[i];
+        } else {
+            scratch[nonnegatives++] = values[i];
+        }
+    }
+
+    memcpy(values, scratch, count * sizeof(*values));
+    sort_magnitudes(
+        values, scratch, bytes, negatives, sort_key_start(lengths[1])
+    );
+    sort_magnitudes(
+        values + negatives, scratch, bytes, count - negatives,
+        sort_key_start(lengths[0])
+    );
+
+    // Negative values were sorted by magnitude, which is the reverse order.
+    for (size_t i = 0; i < negatives / 2; i++) {
+        scratch[0] = values[i];
+        values[i] = values[negatives - 1 - i];
+        values[negatives - 1 - i] = scratch[0];
+    }
+
+    xfree(bytes);
+    xfree(scratch);
+    return 0;
+}
+
+/**
+ * Mix the bits of a 64-bit value so every bit of the input affects every bit
+ * of the output.
+ *
+ * Arguments:
+ * - x: The value to mix.
+ *
+ * Return: The mixed value.
+ */
+static uint64_t hash_mix(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= UINT64_C(0xff51afd7ed558ccd);
+    x ^= x >> 33;
+    x *= UINT64_C(0xc4ceb9fe1a85ec53);
+    return x ^ (x >> 33);
+}
+
+/**
+ * Compute a non-cryptographic hash of a big integer for use in hash tables.
+ * Equal values have equal hashes, and the hash of a value depends only on
+ * the value and the seed, so it is the same for every digit width and
+ * platform. The digits are read as 64-bit words with one multiplication per
+ * word.
+ *
+ * Arguments:
+ * - x: A big integer.
+ * - seed: A value that changes every hash, which tables exposed to untrusted
+ *   keys should choose at random.
+ *
+ * Return: The hash.
+ */
+uint64_t bigint_hash(const bigint_st *x, uint64_t seed)
+{
+    uint64_t word;
+
+    uint64_t hash = hash_mix(seed);
+    size_t words = 0;
+
+    for (size_t i = 0; i < x->length; i += HASH_WORD_DIGITS, words++) {
+        word = 0;
+
+        for (size_t j = 0; j < HASH_WORD_DIGITS && i + j < x->length; j++) {
+            word |= (uint64_t) x->digits[i + j] << (j * DIGIT_BITS);
+        }
+
+        hash = (hash ^ word) * UINT64_C(0x9e3779b97f4a7c15);
+        hash ^= hash >> 29;
+    }
+
+    return hash_mix(hash ^ ((uint64_t) words << 1 | x->negative));
+}
+
+/**
+ * Increment the value of a big integer by 1.
+ *
+ * Arguments:
+ * - x: A big integer.
+ *
+ * Return: 0 if the operation succeeds and a negative value otherwise.
+ */
+int bigint_inc(bigint_st *x)
+{
+    STATS_OPERATION(inc, x->length);
+
+    return bigint_ltz(x) ? magnitude_dec(x) : magnitude_inc(x);
+}
+
+/**
+ * Decrement the value of a big integer by 1.
+ *
+ * Arguments:
+ * - x: A big integer.
+ *
+ * Return: 0 if the operation succeeds and a negative value otherwise.
+ */
+int bigint_dec(bigint_st *x)
+{
+    STATS_OPERATION(dec, x->length);
+
+    if (bigint_eqz(x)) {
+        x->length = 1;
+        x->digits[0] = 1;
+        x->negative = true;
+        return 0;
+    }
+
+    return bigint_ltz(x) ? magnitude_inc(x) : magnitude_dec(x);
+}
+
+/**
+ * Add two big integers.
+ *
+ * Arguments:
+ * - dest: Pointer to the output destination. If this is NULL, a heap pointer
+ *   is returned that the caller is responsible for freeing with "bigint_free".
+ * - a: Addend.
+ * - b: Addend.
+ *
+ * Return: A pointer to the result of the calculation.
+ */
+bigint_st *bigint_add(bigint_st *dest, bigint_st *a, bigint_st *b)
+{
+    int cmp;
+    bigint_st *result;
+
+    bool free_dest_on_error = false;
+
+    STATS_OPERATION(add, a->length + b->length);
+
+    if (!dest) {
+        if (!(dest = bigint_from_int(0))) {
+            return NULL;
+        }
+
+        free_dest_on_error = true;
+    }
+
+    cmp = magnitude_cmp(a, b);
+
+    // TODO: check return value of magnitude_sum, *_delta; free dest if allocated.
+    if (a->negative == b->negative) {
+        dest->negative = a->negative;
+        result = magnitude_sum(dest, a, b);
+    } else if (cmp > 0) {
+        dest->negative = a->negative;
+        result = magnitude_delta(dest, a, b);
+    } else if (cmp < 0) {
+        dest->negative = b->negative;
+        result = magnitude_delta(dest, b, a);
+    } else {
+        bigint_movui(dest, 0);
+        result = dest;
+    }
+
+    if (!result && free_dest_on_error) {
+        bigint_free(dest);
+    }
+
+    return result;
+}
+
+/**
+ * Subtract one big integer from another.
+ *
+ * Arguments:
+ * - out: Pointer to the output destination. If this is NULL, a heap pointer is
+ *   returned that the caller is responsible for freeing with "bigint_free".
+ * - a: Minuend.
+ * - b: Subtrahend.
+ *
+ * Return: A pointer to the result of the calculation.
+ */
+bigint_st *bigint_sub(bigint_st *dest, bigint_st *a, bigint_st *b)
+{
+    int cmp;
+    bigint_st* result;
+
+    bool free_dest_on_error = false;
+
+    STATS_OPERATION(sub, a->length + b->length);
+
+    if (dest) {
+        if (dest != a && dest != b) {
+            bigint_movui(dest, 0);
+        }
+    } else if ((dest = bigint_from_int(0))) {
+        free_dest_on_error = true;
+    } else {
+        return NULL;
+    }
+
+    cmp = magnitude_cmp(a, b);
+
+    // +a, +b
+    if (!a->negative && !b->negative) {
+        if (cmp >= 0) {
+            result = magnitude_delta(dest, a, b);
+            dest->negative = false;
+        } else {
+            result = magnitude_delta(dest, b, a);
+            dest->negative = true;
+        }
+    // +a, -b
+    } else if (!a->negative && b->negative) {
+        result = magnitude_sum(dest, a, b);
+        dest->negative = false;
+    // -a, +b
+    } else if (a->negative && !b->negative) {
+        result = magnitude_sum(dest, a, b);
+        dest->negative = (bool) dest->length;
+    // -a, -b
+    } else if (cmp >= 0) {
+        result = magnitude_delta(dest, a, b);
+        dest->negative = (bool) dest->length;
+    } else {
+        result = magnitude_delta(dest, b, a);
+        dest->negative = false;
+    }
+
+    if (!result && free_dest_on_error) {
+        bigint_free(dest);
+    }
+
+    return result;
+}
+
+/**
+ * Run a queued task on the calling thread and mark it as done. The lock of
+ * the pool must be held when this is called, and it is released while the
+ * task runs.
+ *
+ * Arguments:
+ * - task: A task that was removed from the queue.
+ */
+static void pool_run(pool_task_st *task)
+{
+    pthread_mutex_unlock(&pool.lock);
+    task->run(task->arg);
+    pthread_mutex_lock(&pool.lock);
+    task->done = true;
+    pthread_cond_broadcast(&pool.finished);
+}
+
+/**
+ * Run queued tasks until the pool is stopped.
+ *
+ * Arguments:
+ * - arg: Unused.
+ *
+ * Return: Always NULL. This signature allows the function to be used as the
+ * start routine of a thread.
+ */
+static void *pool_worker(void *arg)
+{
+    pool_task_st *task;
+
+    (void) arg;
+    pthread_mutex_lock(&pool.lock);
+
+    while (!pool.stopping) {
+        if ((task = pool.queue)) {
+            pool.queue = task->next;
+            pool_run(task);
+        } else {
+            pthread_cond_wait(&pool.queued, &pool.lock);
+        }
+    }
+
+    pthread_mutex_unlock(&pool.lock);
+    return NULL;
+}
+
+/**
+ * Queue work that may be done by any thread of the pool. The work is done
+ * even if the pool has no workers because "pool_join" runs queued tasks.
+ *
+ * Arguments:
+ * - task: Storage for the task which must remain valid until it is joined.
+ * - run: Function that performs the work.
+ * - arg: Argument passed to the function.
+ */
+static void pool_fork(pool_task_st *task, void (*run)(void *), void *arg)
+{
+    *task = (pool_task_st) {run, arg, NULL, false};
+    pthread_mutex_lock(&pool.lock);
+    task->next = pool.queue;
+    pool.queue = task;
+    pthread_cond_signal(&pool.queued);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+/**
+ * Wait until a queued task is done, running other queued tasks in the
+ * meantime.
+ *
+ * Arguments:
+ * - task: A task queued with "pool_fork".
+ */
+static void pool_join(pool_task_st *task)
+{
+    pool_task_st *other;
+
+    pthread_mutex_lock(&pool.lock);
+
+    while (!task->done) {
+        if ((other = pool.queue)) {
+            pool.queue = other->next;
+            pool_run(other);
+        } else {
+            pthread_cond_wait(&pool.finished, &pool.lock);
+        }
+    }
+
+    pthread_mutex_unlock(&pool.lock);
+}
+
+/**
+ * Stop and join the worker threads of the pool. The lock that guards the
+ * configuration of the pool must be held when this is called.
+ */
+static void pool_stop(void)
+{
+    unsigned count = atomic_load(&pool.count);
+
+    pthread_mutex_lock(&pool.lock);
+    pool.stopping = true;
+    atomic_store(&pool.count, 0);
+    pthread_cond_broadcast(&pool.queued);
+    pthread_mutex_unlock(&pool.lock);
+
+    for (unsigned i = 0; i < count; i++) {
+        pthread_join(pool.workers[i], NULL);
+    }
+
+    xfree(pool.workers);
+    pool.workers = NULL;
+    pool.stopping = false;
+}
+
+static void pool_range(pool_range_st *range);
+
+/**
+ * Process a range that was queued for the threads of the pool.
+ *
+ * Arguments:
+ * - arg: The range.
+ */
+static void pool_range_run(void *arg)
+{
+    pool_range(arg);
+}
+
+/**
+ * Process a range by splitting it in half until the parts are no larger than
+ * its grain and queuing one half of every split for the threads of the pool.
+ *
+ * Arguments:
+ * - range: The range.
+ */
+static void pool_range(pool_range_st *range)
+{
+    pool_range_st lower;
+    size_t middle;
+    pool_task_st task;
+    pool_range_st upper;
+
+    if (range->last - range->first <= range->grain) {
+        range->body(range->context, range->first, range->last);
+        return;
+    }
+
+    middle = range->first + (range->last - range->first) / 2;
+    lower = *range;
+    lower.last = middle;
+    upper = *range;
+    upper.first = middle;
+
+    pool_fork(&task, pool_range_run, &upper);
+    pool_range(&lower);
+    pool_join(&task);
+}
+
+/**
+ * Call a function on every part of a range of indices, using up to a given
+ * number of threads. The range is split into about twice as many parts as
+ * there are threads so threads that finish early can take over some of the
+ * work.
+ *
+ * Arguments:
+ * - body: Function that processes the indices from its second argument up to
+ *   but not including its third.
+ * - context: Argument passed to the function.
+ * - count: The number of indices.
+ * - threads: The number of threads.
+ */
+static void pool_for(
+    void (*body)(void *, size_t, size_t),
+    void *context,
+    size_t count,
+    unsigned threads
+)
+{
+    size_t grain = count;
+
+    if (threads > 1) {
+        grain = CEIL_DIV(count, 2 * (size_t) threads);
+    }
+
+    pool_range(&(pool_range_st) {body, context, 0, count, grain ? grain : 1});
+}
+
+/**
+ * Add two magnitudes stored as arrays of digits.
+ *
+ * Arguments:
+ * - r: Destination of the `an` least significant digits of the sum. This may
+ *   be the same as either addend.
+ * - a: Digits of the first addend.
+ * - an: Number of digits in the first addend.
+ * - b: Digits of the second addend.
+ * - bn: Number of digits in the second addend which must not be more than
+ *   `an`.
+ *
+ * Return: The carry out of the most significant digit.
+ */
+static digit_tt digits_add(
+    digit_tt *r, const digit_tt *a, size_t an, const digit_tt *b, size_t bn
+)
+{
+    digit_tt sum;
+
+    digit_tt carry = 0;
+    size_t i = 0;
+
+    for (; i < bn; i++) {
+        sum = (digit_tt) (a[i] + carry);
+        carry = sum < carry;
+        sum = (digit_tt) (sum + b[i]);
+        carry += sum < b[i];
+        r[i] = sum;
+    }
+
+    for (; i < an; i++) {
+        sum = (digit_tt) (a[i] + carry);
+        carry = sum < carry;
+        r[i] = sum;
+    }
+
+    return carry;
+}
+
+/**
+ * Subtract two magnitudes stored as arrays of digits.
+ *
+ * Arguments:
+ * - r: Destination of the `an` digits of the difference. This may be the
+ *   same as either operand.
+ * - a: Digits of the minuend.
+ * - an: Number of digits in the minuend.
+ * - b: Digits of the subtrahend.
+ * - bn: Number of digits in the subtrahend which must not be more than `an`.
+ *
+ * Return: The borrow out of the most significant digit, which is 0 when the
+ * subtrahend is not greater than the minuend.
+ */
+static digit_tt digits_sub(
+    digit_tt *r, const digit_tt *a, size_t an, const digit_tt *b, size_t bn
+)
+{
+    digit_tt difference;
+    digit_tt minuend;
+
+    digit_tt borrow = 0;
+    size_t i = 0;
+
+    for (; i < bn; i++) {
+        minuend = a[i];
+        difference = (digit_tt) (minuend - borrow);
+        borrow = difference > minuend;
+        minuend = difference;
+        difference = (digit_tt) (minuend - b[i]);
+        borrow += difference > minuend;
+        r[i] = difference;
+    }
+
+    for (; i < an; i++) {
+        minuend = a[i];
+        difference = (digit_tt) (minuend - borrow);
+        borrow = difference > minuend;
+        r[i] = difference;
+    }
+
+    return borrow;
+}
+
+/**
+ * Add the product of an array of digits and a digit to another array of
+ * digits. This is the inner loop of schoolbook multiplication.
+ *
+ * Arguments:
+ * - r: Digits of the addend, which are replaced with the `n` least
+ *   significant digits of the sum. This must not overlap the multiplicand
+ *   unless it is the same array.
+ * - a: Digits of the multiplicand.
+ * - n: Number of digits in both arrays.
+ * - b: Multiplier.
+ *
+ * Return: The most significant digit of the sum.
+ */
+static inline digit_tt digits_addmul_1(
+    digit_tt *r, const digit_tt *a, size_t n, digit_tt b
+)
+{
+#ifdef DIGIT_SUPER_TYPE
+    digit_super_tt carry;
+    digit_super_tt product;
+#else
+    digit_tt carry;
+    digit_tt product;
+#endif
+
+    carry = 0;
+
+    for (size_t i = 0; i < n; i++) {
+#ifdef DIGIT_SUPER_TYPE
+        product = (digit_super_tt) a[i] * b;
+        product += r[i] + carry;
+        carry = DIGIT_MAX & (product >> DIGIT_BITS);
+        product = DIGIT_MAX & product;
+#else
+        u128fma64(&carry, &product, a[i], b, carry);
+        u128add64(&carry, &product, r[i]);
+#endif
+        r[i] = (digit_tt) product;
+    }
+
+    return (digit_tt) carry;
+}
+
+/**
+ * Subtract the product of an array of digits and a digit from another array
+ * of digits.
+ *
+ * Arguments:
+ * - r: Digits of the minuend, which are replaced with the `n` digits of the
+ *   difference modulo `2^(n * DIGIT_BITS)`.
+ * - a: Digits of the multiplicand.
+ * - n: Number of digits in both arrays.
+ * - b: Multiplier.
+ *
+ * Return: The amount that must be subtracted from the digits that follow
+ * the `n` digits of the minuend.
+ */
+static inline digit_tt digits_submul_1(
+    digit_tt *r, const digit_tt *a, size_t n, digit_tt b
+)
+{
+    digit_tt difference;
+    digit_tt high;
+    digit_tt low;
+
+    digit_tt borrow = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        low = digit_muladd(a[i], b, borrow, &high);
+        difference = (digit_tt) (r[i] - low);
+        borrow = (digit_tt) (high + (difference > r[i]));
+        r[i] = difference;
+    }
+
+    return borrow;
+}
+
+/**
+ * Multiply two arrays of digits with the schoolbook algorithm.
+ *
+ * Arguments:
+ * - r: Destination of the `an + bn` digits of the product. This must not
+ *   overlap either operand.
+ * - a: Digits of the multiplicand.
+ * - an: Number of digits in the multiplicand.
+ * - b: Digits of the multiplier.
+ * - bn: Number of digits in the multiplier.
+ */
+static void digits_mul_schoolbook(
+    digit_tt *r, const digit_tt *a, size_t an, const digit_tt *b, size_t bn
+)
+{
+    // The digits of the destination are used as accumulators.
+    memset(r, 0, (an + bn) * sizeof(digit_tt));
+
+    for (size_t i = 0; i < an; i++) {
+        r[i + bn] = digits_addmul_1(r + i, b, bn, a[i]);
+    }
+}
+
+/**
+ * Get the number of digits of temporary space "digits_mul" needs to multiply
+ * operands whose larger one has a given number of digits. The result is an
+ * upper bound that never decreases as the size grows, so a product may give
+ * each of its subproducts the space needed for the largest one.
+ *
+ * Arguments:
+ * - n: The number of digits in the larger operand.
+ * - plan: Settings of the multiplication.
+ * - levels: Number of levels that may hand subproducts to other threads.
+ *
+ * Return: The number of digits.
+ */
+static size_t digits_mul_scratch(
+    size_t n, const mul_plan_st *plan, unsigned levels
+)
+{
+    size_t share;
+
+    size_t half = CEIL_DIV(n, 2);
+
+    if (n <= plan->karatsuba || n < MUL_KARATSUBA_MIN) {
+        return 0;
+    }
+
+    // Each level needs two sums of halves and their product. Subproducts
+    // that run concurrently need separate space, and the others share it.
+    if (levels && n > plan->parallel) {
+        share = digits_mul_scratch(half + 1, plan, levels - 1);
+        return 4 * (half + 1) + 3 * share;
+    }
+
+    return 4 * (half + 1) + digits_mul_scratch(half + 1, plan, 0);
+}
+
+static void digits_mul(
+    digit_tt *r,
+    const digit_tt *a,
+    size_t an,
+    const digit_tt *b,
+    size_t bn,
+    digit_tt *scratch,
+    const mul_plan_st *plan,
+    unsigned levels
+);
+
+/**
+ * Compute a product described by a job. This allows products to be queued
+ * for the threads of the pool.
+ *
+ * Arguments:
+ * - arg: The job.
+ */
+static void mul_job_run(void *arg)
+{
+    mul_job_st *job = arg;
+
+    digits_mul(
+        job->r, job->a, job->an, job->b, job->bn, job->scratch, job->plan,
+        job->levels
+    );
+}
+
+/**
+ * Multiply an operand by another that has at most half as many digits by
+ * splitting the larger one into pieces the size of the smaller one.
+ *
+ * Arguments: See "digits_mul". The multiplicand must have more digits than
+ * the multiplier.
+ */
+static void digits_mul_unbalanced(
+    digit_tt *r,
+    const digit_tt *a,
+    size_t an,
+    const digit_tt *b,
+    size_t bn,
+    digit_tt *scratch,
+    const mul_plan_st *plan,
+    unsigned levels
+)
+{
+    size_t piece;
+
+    digit_tt *product = scratch;
+
+    scratch += 2 * bn;
+    digits_mul(r, a, bn, b, bn, scratch, plan, levels);
+    memset(r + 2 * bn, 0, (an - bn) * sizeof(digit_tt));
+
+    for (size_t offset = bn; offset < an; offset += bn) {
+        piece = an - offset < bn ? an - offset : bn;
+        digits_mul(product, a + offset, piece, b, bn, scratch, plan, levels);
+        digits_add(
+            r + offset, r + offset, an + bn - offset, product, piece + bn
+        );
+    }
+}
+
+/**
+ * Multiply two arrays of digits with the Karatsuba algorithm. With operands
+ * split into halves so that `a = a1 * B^h + a0` and `b = b1 * B^h + b0`, the
+ * product is `z2 * B^2h + (z1 - z2 - z0) * B^h + z0` where `z0 = a0 * b0`,
+ * `z2 = a1 * b1` and `z1 = (a0 + a1) * (b0 + b1)`. The three subproducts are
+ * independent, so large ones are handed to the threads of the pool.
+ *
+ * Arguments: See "digits_mul". The multiplier must have more digits than
+ * half of the multiplicand.
+ */
+static void digits_mul_karatsuba(
+    digit_tt *r,
+    const digit_tt *a,
+    size_t an,
+    const digit_tt *b,
+    size_t bn,
+    digit_tt *scratch,
+    const mul_plan_st *plan,
+    unsigned levels
+)
+{
+    size_t length;
+    size_t share;
+    mul_job_st jobs[2];
+    pool_task_st tasks[2];
+
+    size_t half = CEIL_DIV(an, 2);
+    digit_tt *a_sum = scratch;
+    digit_tt *b_sum = scratch + half + 1;
+    digit_tt *z1 = scratch + 2 * (half + 1);
+
+    scratch += 4 * (half + 1);
+    a_sum[half] = digits_add(a_sum, a, half, a + half, an - half);
+    b_sum[half] = digits_add(b_sum, b, half, b + half, bn - half);
+
+    // The low half of the destination receives z0 and the high half z2.
+    if (levels && bn > plan->parallel) {
+        share = digits_mul_scratch(half + 1, plan, levels - 1);
+        jobs[0] = (mul_job_st) {
+            r + 2 * half, a + half, an - half, b + half, bn - half,
+            scratch + share, plan, levels - 1
+        };
+        jobs[1] = (mul_job_st) {
+            z1, a_sum, half + 1, b_sum, half + 1, scratch + 2 * share, plan,
+            levels - 1
+        };
+        pool_fork(&tasks[0], mul_job_run, &jobs[0]);
+        pool_fork(&tasks[1], mul_job_run, &jobs[1]);
+        digits_mul(r, a, half, b, half, scratch, plan, levels - 1);
+        pool_join(&tasks[1]);
+        pool_join(&tasks[0]);
+    } else {
+        digits_mul(r, a, half, b, half, scratch, plan, 0);
+        digits_mul(
+            r + 2 * half, a + half, an - half, b + half, bn - half, scratch,
+            plan, 0
+        );
+        digits_mul(z1, a_sum, half + 1, b_sum, half + 1, scratch, plan, 0);
+    }
+
+    digits_sub(z1, z1, 2 * (half + 1), r, 2 * half);
+    digits_sub(z1, z1, 2 * (half + 1), r + 2 * half, an + bn - 2 * half);
+
+    // The middle term fits in the product, so its leading zeroes that would
+    // go past the end are dropped.
+    length = 2 * (half + 1);
+
+    while (length && !z1[length - 1]) {
+        length--;
+    }
+
+    digits_add(r + half, r + half, an + bn - half, z1, length);
+}
+
+/**
+ * Multiply two arrays of digits, choosing the algorithm based on their size.
+ *
+ * Arguments:
+ * - r: Destination of the `an + bn` digits of the product. This must not
+ *   overlap either operand.
+ * - a: Digits of the multiplicand.
+ * - an: Number of digits in the multiplicand.
+ * - b: Digits of the multiplier.
+ * - bn: Number of digits in the multiplier.
+ * - scratch: Temporary space of at least as many digits as
+ *   "digits_mul_scratch" returns for the larger operand.
+ * - plan: Settings of the multiplication.
+ * - levels: Number of levels that may hand subproducts to other threads.
+ */
+static void digits_mul(
+    digit_tt *r,
+    const digit_tt *a,
+    size_t an,
+    const digit_tt *b,
+    size_t bn,
+    digit_tt *scratch,
+    const mul_plan_st *plan,
+    unsigned levels
+)
+{
+    const digit_tt *swap_digits;
+    size_t swap_length;
+
+    if (an < bn) {
+        swap_digits = a;
+        a = b;
+        b = swap_digits;
+        swap_length = an;
+        an = bn;
+        bn = swap_length;
+    }
+
+    if (bn <= plan->karatsuba || bn < MUL_KARATSUBA_MIN) {
+        digits_mul_schoolbook(r, a, an, b, bn);
+    } else if (bn <= CEIL_DIV(an, 2)) {
+        digits_mul_unbalanced(
+            r, a, an, b, bn, scratch, plan, levels ? levels - 1 : 0
+        );
+    } else {
+        digits_mul_karatsuba(r, a, an, b, bn, scratch, plan, levels);
+    }
+}
+
+/**
+ * Reduce a product modulo a prime of the number-theoretic transform with
+ * Montgomery reduction.
+ *
+ * Arguments:
+ * - prime: The prime.
+ * - t: A value less than the prime multiplied by `2^32`.
+ *
+ * Return: The value of `t / 2^32` modulo the prime.
+ */
+static inline uint32_t ntt_reduce(const ntt_prime_st *prime, uint64_t t)
+{
+    uint32_t m = (uint32_t) t * prime->inverse;
+    uint32_t high = (uint32_t) (t >> 32);
+    uint32_t subtrahend = (uint32_t) (((uint64_t) m * prime->modulus) >> 32);
+
+    // The low halves of `t` and `m * modulus` are equal, so only the high
+    // halves are subtracted.
+    return high >= subtrahend ?
+        high - subtrahend : high - subtrahend + prime->modulus;
+}
+
+/**
+ * Multiply two values modulo a prime of the number-theoretic transform.
+ * When one of them is in Montgomery form, the product is not.
+ *
+ * Arguments:
+ * - prime: The prime.
+ * - a: A value less than the prime.
+ * - b: A value less than the prime.
+ *
+ * Return: The value of `a * b / 2^32` modulo the prime.
+ */
+static inline uint32_t ntt_mul(
+    const ntt_prime_st *prime, uint32_t a, uint32_t b
+)
+{
+    return ntt_reduce(prime, (uint64_t) a * b);
+}
+
+/**
+ * Add two values modulo a prime of the number-theoretic transform.
+ *
+ * Arguments:
+ * - prime: The prime.
+ * - a: A value less than the prime.
+ * - b: A value less than the prime.
+ *
+ * Return: The sum modulo the prime.
+ */
+static inline uint32_t ntt_add(
+    const ntt_prime_st *prime, uint32_t a, uint32_t b
+)
+{
+    uint64_t sum = (uint64_t) a + b;
+
+    return (uint32_t) (sum >= prime->modulus ? sum - prime->modulus : sum);
+}
+
+/**
+ * Subtract two values modulo a prime of the number-theoretic transform.
+ *
+ * Arguments:
+ * - prime: The prime.
+ * - a: A value less than the prime.
+ * - b: A value less than the prime.
+ *
+ * Return: The difference modulo the prime.
+ */
+static inline uint32_t ntt_sub(
+    const ntt_prime_st *prime, uint32_t a, uint32_t b
+)
+{
+    return a >= b ? a - b : a - b + prime->modulus;
+}
+
+/**
+ * Raise a value in Montgomery form to a power modulo a prime of the
+ * number-theoretic transform.
+ *
+ * Arguments:
+ * - prime: The prime.
+ * - base: The base in Montgomery form.
+ * - exponent: The exponent.
+ *
+ * Return: The power in Montgomery form.
+ */
+static uint32_t ntt_pow(
+    const ntt_prime_st *prime, uint32_t base, uint64_t exponent
+)
+{
+    // This is 1 in Montgomery form.
+    uint32_t result = ntt_mul(prime, 1, prime->r2);
+
+    for (; exponent; exponent >>= 1) {
+        if (exponent & 1) {
+            result = ntt_mul(prime, result, base);
+        }
+
+        base = ntt_mul(prime, base, base);
+    }
+
+    return result;
+}
+
+/**
+ * Get the primitive root of unity of a given order modulo a prime of the
+ * number-theoretic transform.
+ *
+ * Arguments:
+ * - prime: The prime.
+ * - order: The order which must be a power of 2 that divides one less than
+ *   the prime.
+ *
+ * Return: The root in Montgomery form.
+ */
+static uint32_t ntt_root(const ntt_prime_st *prime, size_t order)
+{
+    return ntt_pow(
+        prime,
+        ntt_mul(prime, prime->generator, prime->r2),
+        (prime->modulus - 1) / order
+    );
+}
+
+/**
+ * Get the table of roots of unity for transforms of a given length, computing
+ * it if no transform has needed it yet. The table must be returned with
+ * "ntt_table_release". This function is thread safe.
+ *
+ * Arguments:
+ * - index: The index of the prime in "ntt_primes".
+ * - log: The base 2 logarithm of the length.
+ *
+ * Return: The table or NULL if it could not be allocated.
+ */
+static ntt_table_st *ntt_table_get(unsigned index, unsigned log)
+{
+    uint32_t inverse;
+    uint32_t inverse_power;
+    uint32_t power;
+    uint32_t root;
+    ntt_table_st *table;
+
+    const ntt_prime_st *prime = &ntt_primes[index];
+    size_t length = (size_t) 1 << log;
+
+    pthread_mutex_lock(&ntt_tables_lock);
+
+    if ((table = ntt_tables[index][log])) {
+        table->references++;
+        pthread_mutex_unlock(&ntt_tables_lock);
+        return table;
+    }
+
+    if (!(table = safe_calloc(
+        1, sizeof(*table) + 3 * length * sizeof(uint32_t)
+    ))) {
+        pthread_mutex_unlock(&ntt_tables_lock);
+        return NULL;
+    }
+
+    table->references = 1;
+    table->forward = (uint32_t *) (table + 1);
+    table->inverse = table->forward + length;
+    table->reversed = table->inverse + length;
+
+    for (size_t m = 1; m < length; m *= 2) {
+        root = ntt_root(prime, 2 * m);
+        inverse = ntt_pow(prime, root, 2 * m - 1);
+        power = inverse_power = ntt_mul(prime, 1, prime->r2);
+
+        for (size_t j = 0; j < m; j++) {
+            table->forward[m + j] = power;
+            table->inverse[m + j] = inverse_power;
+            power = ntt_mul(prime, power, root);
+            inverse_power = ntt_mul(prime, inverse_power, inverse);
+        }
+    }
+
+    table->reversed[0] = 0;
+
+    for (size_t k = 1; k < length; k++) {
+        table->reversed[k] = (uint32_t) (
+            table->reversed[k >> 1] >> 1 | (k & 1) << (log - 1)
+        );
+    }
+
+    ntt_tables[index][log] = table;
+    pthread_mutex_unlock(&ntt_tables_lock);
+    return table;
+}
+
+/**
+ * Return a table of roots of unity obtained with "ntt_table_get". This
+ * function is thread safe.
+ *
+ * Arguments:
+ * - table: The table or NULL.
+ */
+static void ntt_table_release(ntt_table_st *table)
+{
+    if (table) {
+        pthread_mutex_lock(&ntt_tables_lock);
+        table->references--;
+        pthread_mutex_unlock(&ntt_tables_lock);
+    }
+}
+
+/**
+ * Get the size of the number-theoretic transform that multiplies two
+ * operands.
+ *
+ * Arguments:
+ * - an: The number of digits in the multiplicand.
+ * - bn: The number of digits in the multiplier.
+ *
+ * Return: The base 2 logarithm of the number of values in the transform or 0
+ * if the product is too large for the transform.
+ */
+static unsigned ntt_log(size_t an, size_t bn)
+{
+    size_t coefficients;
+
+    size_t limit = (size_t) 1 << NTT_LOG_MAX;
+    unsigned log = 2;
+
+    if (an >= limit || bn >= limit) {
+        return 0;
+    }
+
+    if ((coefficients = NTT_PIECES(an) + NTT_PIECES(bn) - 1) > limit) {
+        return 0;
+    }
+
+    while (((size_t) 1 << log) < coefficients) {
+        log++;
+    }
+
+    return log;
+}
+
+/**
+ * Apply the number-theoretic transform to rows of a matrix.
+ *
+ * Arguments:
+ * - arg: The pass of the transform.
+ * - first: The first row.
+ * - last: One past the last row.
+ */
+static void ntt_rows(void *arg, size_t first, size_t last)
+{
+    uint32_t factor;
+    size_t j;
+    uint32_t u;
+    uint32_t v;
+    uint32_t *x;
+
+    const ntt_rows_st *pass = arg;
+    // The constants are copied so that writes to the values cannot alias
+    // them, which would force the compiler to reload them.
+    const ntt_prime_st local = *pass->ntt->prime;
+    const ntt_prime_st *prime = &local;
+    const ntt_table_st *table = pass->table;
+    size_t length = pass->length;
+    uint32_t one = ntt_mul(prime, 1, prime->r2);
+    uint32_t root = pass->inverse ? pass->ntt->inverse_root : pass->ntt->root;
+    uint32_t step = pass->twiddle ? ntt_pow(prime, root, first) : 0;
+
+    for (size_t row = first; row < last; row++) {
+        x = pass->data + row * length;
+
+        // The forward transform uses decimation in frequency, which leaves
+        // the values of each row in bit-reversed order, and the inverse
+        // transform uses decimation in time, which expects that order.
+        if (!pass->inverse) {
+            for (size_t m = length / 2; m; m /= 2) {
+                for (size_t start = 0; start < length; start += 2 * m) {
+                    for (j = start; j < start + m; j++) {
+                        u = x[j];
+                        v = x[j + m];
+                        x[j] = ntt_add(prime, u, v);
+                        x[j + m] = ntt_mul(
+                            prime, ntt_sub(prime, u, v),
+                            table->forward[m + j - start]
+                        );
+                    }
+                }
+            }
+        }
+
+        if (pass->twiddle) {
+            factor = one;
+
+            for (size_t k = 0; k < length; k++) {
+                j = table->reversed[k];
+                x[j] = ntt_mul(prime, x[j], factor);
+                factor = ntt_mul(prime, factor, step);
+            }
+
+            step = ntt_mul(prime, step, root);
+        }
+
+        if (pass->inverse) {
+            for (size_t m = 1; m < length; m *= 2) {
+                for (size_t start = 0; start < length; start += 2 * m) {
+                    for (j = start; j < start + m; j++) {
+                        u = x[j];
+                        v = ntt_mul(
+                            prime, x[j + m], table->inverse[m + j - start]
+                        );
+                        x[j] = ntt_add(prime, u, v);
+                        x[j + m] = ntt_sub(prime, u, v);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Transpose rows of tiles of a matrix of the number-theoretic transform.
+ *
+ * Arguments:
+ * - arg: The transpose.
+ * - first: The first row of tiles.
+ * - last: One past the last row of tiles.
+ */
+static void ntt_transpose_tiles(void *arg, size_t first, size_t last)
+{
+    size_t column_end;
+    size_t row_end;
+
+    const ntt_transpose_st *transpose = arg;
+    size_t columns = transpose->columns;
+    size_t rows = transpose->rows;
+
+    for (size_t tile = first; tile < last; tile++) {
+        row_end = (tile + 1) * NTT_TILE < rows ? (tile + 1) * NTT_TILE : rows;
+
+        for (size_t c = 0; c < columns; c += NTT_TILE) {
+            column_end = c + NTT_TILE < columns ? c + NTT_TILE : columns;
+
+            for (size_t i = tile * NTT_TILE; i < row_end; i++) {
+                for (size_t j = c; j < column_end; j++) {
+                    transpose->out[j * rows + i] =
+                        transpose->in[i * columns + j];
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Transpose a matrix of the number-theoretic transform.
+ *
+ * Arguments:
+ * - ntt: The transform.
+ * - out: Destination of the transposed matrix.
+ * - in: The matrix.
+ * - rows: Number of rows of the matrix.
+ * - columns: Number of columns of the matrix.
+ */
+static void ntt_transpose(
+    const ntt_st *ntt, uint32_t *out, const uint32_t *in, size_t rows,
+    size_t columns
+)
+{
+    ntt_transpose_st transpose = {in, out, rows, columns};
+
+    pool_for(
+        ntt_transpose_tiles, &transpose, CEIL_DIV(rows, NTT_TILE),
+        ntt->threads
+    );
+}
+
+/**
+ * Apply the number-theoretic transform to every row of a matrix.
+ *
+ * Arguments:
+ * - ntt: The transform.
+ * - data: The matrix.
+ * - rows: Number of rows.
+ * - length: Number of values in each row.
+ * - table: Roots for transforms of that length.
+ * - inverse: Value that indicates whether the inverse transform is computed.
+ * - twiddle: Value that indicates whether the rows are multiplied by powers
+ *   of the root of the whole transform.
+ */
+static void ntt_pass(
+    const ntt_st *ntt,
+    uint32_t *data,
+    size_t rows,
+    size_t length,
+    const ntt_table_st *table,
+    bool inverse,
+    bool twiddle
+)
+{
+    ntt_rows_st pass = {ntt, data, length, table, inverse, twiddle};
+
+    pool_for(ntt_rows, &pass, rows, ntt->threads);
+}
+
+/**
+ * Compute the forward number-theoretic transform of a matrix in place with
+ * the six-step algorithm: transpose the matrix, transform its rows, multiply
+ * them by powers of the root of the whole transform, transpose it again and
+ * transform the rows once more. The final transpose that would restore the
+ * natural order of the spectrum is left out.
+ *
+ * Arguments:
+ * - ntt: The transform.
+ * - data: The values with `rows * columns` entries.
+ */
+static void ntt_forward(const ntt_st *ntt, uint32_t *data)
+{
+    ntt_transpose(ntt, ntt->spare, data, ntt->rows, ntt->columns);
+    ntt_pass(
+        ntt, ntt->spare, ntt->columns, ntt->rows, ntt->column_table, false,
+        true
+    );
+    ntt_transpose(ntt, data, ntt->spare, ntt->columns, ntt->rows);
+    ntt_pass(
+        ntt, data, ntt->rows, ntt->columns, ntt->row_table, false, false
+    );
+}
+
+/**
+ * Compute the inverse of "ntt_forward" in place. The values are left
+ * multiplied by the number of values in the transform.
+ *
+ * Arguments:
+ * - ntt: The transform.
+ * - data: The spectrum produced by "ntt_forward".
+ */
+static void ntt_inverse(const ntt_st *ntt, uint32_t *data)
+{
+    ntt_pass(ntt, data, ntt->rows, ntt->columns, ntt->row_table, true, false);
+    ntt_transpose(ntt, ntt->spare, data, ntt->rows, ntt->columns);
+    ntt_pass(
+        ntt, ntt->spare, ntt->columns, ntt->rows, ntt->column_table, true,
+        true
+    );
+    ntt_transpose(ntt, data, ntt->spare, ntt->columns, ntt->rows);
+}
+
+/**
+ * Multiply spectra of the number-theoretic transform value by value.
+ *
+ * Arguments:
+ * - arg: The spectra.
+ * - first: The first value.
+ * - last: One past the last value.
+ */
+static void ntt_pointwise(void *arg, size_t first, size_t last)
+{
+    const ntt_pointwise_st *pointwise = arg;
+
+    for (size_t i = first; i < last; i++) {
+        pointwise->a[i] = ntt_mul(
+            pointwise->prime, pointwise->a[i], pointwise->b[i]
+        );
+    }
+}
+
+/**
+ * Split the digits of an operand into the coefficients of a polynomial.
+ *
+ * Arguments:
+ * - values: Destination of the coefficients.
+ * - count: Number of coefficients. The ones past the end of the operand are
+ *   set to 0.
+ * - x: Digits of the operand.
+ * - n: Number of digits in the operand.
+ */
+static void ntt_load(
+    uint32_t *values, size_t count, const digit_tt *x, size_t n
+)
+{
+    size_t pieces = NTT_PIECES(n);
+
+    for (size_t i = 0; i < pieces; i++) {
+#if DIGIT_WIDTH == 8
+        values[i] = x[2 * i];
+
+        if (2 * i + 1 < n) {
+            values[i] |= (uint32_t) x[2 * i + 1] << 8;
+        }
+#else
+        values[i] = (uint32_t) (
+            x[i / (DIGIT_BITS / NTT_PIECE_BITS)] >>
+                NTT_PIECE_BITS * (i % (DIGIT_BITS / NTT_PIECE_BITS))
+        ) & 0xffff;
+#endif
+    }
+
+    memset(values + pieces, 0, (count - pieces) * sizeof(uint32_t));
+}
+
+/**
+ * Combine the coefficients of a product computed modulo each prime of the
+ * number-theoretic transform with Garner's algorithm, propagate the carries
+ * and write the digits of the product.
+ *
+ * Arguments:
+ * - r: Destination of the digits.
+ * - n: Number of digits in the product.
+ * - residues: The coefficients modulo each prime, still multiplied by the
+ *   scale of the transform of that prime.
+ * - scales: Factors that remove the scale from the coefficients.
+ * - count: Number of coefficients.
+ */
+static void ntt_store(
+    digit_tt *r,
+    size_t n,
+    uint32_t *residues[NTT_PRIMES],
+    const uint32_t scales[NTT_PRIMES],
+    size_t count
+)
+{
+    uint32_t first;
+    uint32_t piece;
+    uint32_t second;
+
+    const ntt_prime_st *p = &ntt_primes[0];
+    const ntt_prime_st *q = &ntt_primes[1];
+    uint64_t carry = 0;
+    uint32_t garner = ntt_mul(q, NTT_GARNER_INVERSE, q->r2);
+    size_t pieces = NTT_PIECES(n);
+
+    memset(r, 0, n * sizeof(digit_tt));
+
+    for (size_t i = 0; i < pieces; i++) {
+        if (i < count) {
+            // The coefficient is `first + p * t` where `t` is the
+            // difference of the residues divided by `p` modulo `q`. It is
+            // less than `p * q`, which is less than `2^64`.
+            first = ntt_mul(p, residues[0][i], scales[0]);
+            second = ntt_mul(q, residues[1][i], scales[1]);
+            second = ntt_mul(q, ntt_sub(q, second, first), garner);
+            carry += first + (uint64_t) p->modulus * second;
+        }
+
+        piece = (uint32_t) (carry & 0xffff);
+        carry >>= NTT_PIECE_BITS;
+
+#if DIGIT_WIDTH == 8
+        r[2 * i] = (digit_tt) piece;
+
+        if (2 * i + 1 < n) {
+            r[2 * i + 1] = (digit_tt) (piece >> 8);
+        }
+#else
+        r[i / (DIGIT_BITS / NTT_PIECE_BITS)] |= (digit_tt) piece <<
+            NTT_PIECE_BITS * (i % (DIGIT_BITS / NTT_PIECE_BITS));
+#endif
+    }
+}
+
+/**
+ * Multiply two arrays of digits with a number-theoretic transform. The
+ * operands are split into 16-bit coefficients, and the coefficients of the
+ * product are computed modulo two primes whose product exceeds them, so
+ * they are recovered exactly. The transforms, pointwise products and
+ * transposes are split between the threads of the multiplication.
+ *
+ * Arguments:
+ * - r: Destination of the `an + bn` digits of the product. This must not
+ *   overlap either operand.
+ * - a: Digits of the multiplicand.
+ * - an: Number of digits in the multiplicand.
+ * - b: Digits of the multiplier.
+ * - bn: Number of digits in the multiplier.
+ * - log: The value "ntt_log" returns for the operands, which must not be 0.
+ * - plan: Settings of the multiplication.
+ *
+ * Return: 0 if the operation succeeds and -1 if it fails.
+ */
+static int digits_mul_ntt(
+    digit_tt *r,
+    const digit_tt *a,
+    size_t an,
+    const digit_tt *b,
+    size_t bn,
+    unsigned log,
+    const mul_plan_st *plan
+)
+{
+    uint32_t *fa;
+    uint32_t *fb;
+    ntt_st ntt;
+    uint32_t *residues[NTT_PRIMES];
+    uint32_t scales[NTT_PRIMES];
+
+    bool square = a == b && an == bn;
+    bigint_st buffer = {NULL, 0, 0, false, false};
+    size_t length = (size_t) 1 << log;
+    size_t values = (NTT_PRIMES + (square ? 1 : 2)) * length;
+
+    buffer.allocated = CEIL_DIV(values * sizeof(uint32_t), sizeof(digit_tt));
+
+    if (!(buffer.digits = digits_alloc(buffer.allocated))) {
+        return -1;
+    }
+
+    // Each prime needs its own result, and the operands and the transposes
+    // share the rest of the buffer.
+    residues[0] = (uint32_t *) buffer.digits;
+    residues[1] = residues[0] + length;
+    ntt.spare = residues[1] + length;
+    fb = square ? NULL : ntt.spare + length;
+
+    for (unsigned i = 0; i < NTT_PRIMES; i++) {
+        ntt.prime = &ntt_primes[i];
+        ntt.rows = (size_t) 1 << (log - log / 2);
+        ntt.columns = (size_t) 1 << (log / 2);
+        ntt.root = ntt_root(ntt.prime, length);
+        ntt.inverse_root = ntt_pow(ntt.prime, ntt.root, length - 1);
+        ntt.threads = plan->threads;
+        ntt.column_table = ntt_table_get(i, log - log / 2);
+        ntt.row_table = ntt_table_get(i, log / 2);
+
+        if (!ntt.column_table || !ntt.row_table) {
+            ntt_table_release(ntt.column_table);
+            ntt_table_release(ntt.row_table);
+            digits_free(&buffer);
+            return -1;
+        }
+
+        // The pointwise products divide by `R` and the inverse transform
+        // multiplies by the length, so the results are multiplied by
+        // `R^2 / length`, which is the Montgomery form of `R / length`.
+        scales[i] = ntt_mul(
+            ntt.prime,
+            ntt_mul(ntt.prime, ntt.prime->r2, ntt.prime->r2),
+            ntt.prime->modulus - (ntt.prime->modulus - 1) / (uint32_t) length
+        );
+
+        fa = residues[i];
+        ntt_load(fa, length, a, an);
+        ntt_forward(&ntt, fa);
+
+        if (!square) {
+            ntt_load(fb, length, b, bn);
+            ntt_forward(&ntt, fb);
+        }
+
+        pool_for(
+            ntt_pointwise,
+            &(ntt_pointwise_st) {ntt.prime, fa, square ? fa : fb},
+            length,
+            ntt.threads
+        );
+        ntt_inverse(&ntt, fa);
+        ntt_table_release(ntt.column_table);
+        ntt_table_release(ntt.row_table);
+    }
+
+    ntt_store(
+        r, an + bn, residues, scales, NTT_PIECES(an) + NTT_PIECES(bn) - 1
+    );
+    digits_free(&buffer);
+    return 0;
+}
+
+/**
+ * Read the settings of a multiplication.
+ *
+ * Arguments:
+ * - plan: Output pointer for the settings.
+ * - n: The number of digits in the larger operand.
+ */
+static void mul_plan(mul_plan_st *plan, size_t n)
+{
+    unsigned subproducts;
+    unsigned threads;
+
+    plan->karatsuba = threshold(THRESHOLD_MUL_KARATSUBA);
+    plan->parallel = threshold(THRESHOLD_MUL_PARALLEL);
+    plan->ntt = threshold(THRESHOLD_MUL_NTT);
+    plan->threads = 1;
+    plan->levels = 0;
+
+    if (n <= plan->parallel || !(threads = atomic_load(&pool.count))) {
+        return;
+    }
+
+    // Split the work into at least twice as many subproducts as there are
+    // threads so that threads that finish early can take over some of it.
+    plan->threads = ++threads;
+
+    for (subproducts = 1; subproducts / 2 < threads; subproducts *= 3) {
+        plan->levels++;
+    }
+}
+
+/**
+ * Implementation of "bigint_mul" without tracing.
+ */
+static bigint_st *mul_untraced(bigint_st *dest, bigint_st *a, bigint_st *b)
+{
+    size_t larger;
+    unsigned log;
+    bigint_st *original_dest;
+    mul_plan_st plan;
+
+    bool negative = a->negative != b->negative;
+    bigint_st scratch = {NULL, 0, 0, false, false};
+
+    STATS_OPERATION(mul, a->length + b->length);
+
+    original_dest = dest;
+
+    if (!dest) {
+        dest = bigint_from_int(0);
+    } else if (dest == a || dest == b) {
+        // The destination value is written before the inputs have been fully
+        // read, so if the destination happens to also be one of the inputs,
+        // we first make a new structure which will be copied to the
+        // destination once the calculations are done.
+        if (!(dest = bigint_dup(dest))) {
+            return NULL;
+        }
+    }
+
+    if (!dest) {
+        return NULL;
+    }
+
+    if (bigint_eqz(a) || bigint_eqz(b)) {
+        bigint_movui(dest, 0);
+        goto done;
+    }
+
+    if (a->length > 1 && bigint_is_power_of_2(a)) {
+        if (!bigint_shli(dest, b, ctz(a))) {
+            goto error;
+        }
+
+        goto done;
+    }
+
+    if (b->length > 1 && bigint_is_power_of_2(b)) {
+        if (!bigint_shli(dest, a, ctz(b))) {
+            goto error;
+        }
+
+        goto done;
+    }
+
+    // Allocate as much space as we could possibly need up front.
+    if (resize_sum(dest, a->length, b->length)) {
+        goto error;
+    }
+
+    larger = a->length > b->length ? a->length : b->length;
+    mul_plan(&plan, larger);
+
+    // The transform handles operands of any shape, so only the smaller one
+    // decides whether it pays off.
+    if (
+        (a->length < b->length ? a->length : b->length) > plan.ntt &&
+        (log = ntt_log(a->length, b->length))
+    ) {
+        if (digits_mul_ntt(
+            dest->digits, a->digits, a->length, b->digits, b->length, log,
+            &plan
+        )) {
+            goto error;
+        }
+
+        goto done;
+    }
+
+    scratch.allocated = digits_mul_scratch(larger, &plan, plan.levels);
+
+    if (
+        scratch.allocated &&
+        !(scratch.digits = digits_alloc(scratch.allocated))
+    ) {
+        goto error;
+    }
+
+    digits_mul(
+        dest->digits, a->digits, a->length, b->digits, b->length,
+        scratch.digits, &plan, plan.levels
+    );
+
+    if (scratch.digits) {
+        digits_free(&scratch);
+    }
+
+done:
+    if (original_dest && dest != original_dest) {
+        digits_free(original_dest);
+        *original_dest = *dest;
+        xfree(dest);
+        dest = original_dest;
+    }
+
+    dest->negative = negative;
+    normalize(dest);
+    return dest;
+
+error:
+    if (dest != original_dest) {
+        bigint_free(dest);
+    }
+
+    return NULL;
+}
+
+/**
+ * Multiple two big integers.
+ *
+ * Arguments:
+ * - dest: Pointer to the output destination. If this is NULL, a heap pointer
+ *   is returned that the caller is responsible for freeing with "bigint_free".
+ * - a: Multiplicand.
+ * - b: Multiplicand.
+ *
+ * Return: A pointer to the result of the calculation if it succeeds and `NULL`
+ * otherwise.
+ */
+bigint_st *bigint_mul(bigint_st *dest, bigint_st *a, bigint_st *b)
+{
+    bigint_st *result;
+    trace_span_st span;
+
+    trace_begin(&span, "mul", a->length, b->length);
+    result = mul_untraced(dest, a, b);
+    trace_end(&span, result);
+    return result;
+}
+
+/**
+ * Add the product of two arrays of digits to another array of digits in
+ * place, one row of the schoolbook product at a time, or subtract it.
+ *
+ * Arguments:
+ * - r: Digits of the accumulator. This must not overlap either operand.
+ * - rn: Number of digits in the accumulator, which must be more than the
+ *   number of digits in the sum or difference.
+ * - a: Digits of the multiplicand.
+ * - an: Number of digits in the multiplicand.
+ * - b: Digits of the multiplier.
+ * - bn: Number of digits in the multiplier.
+ * - subtract: Whether to subtract the product instead of adding it.
+ *
+ * Return: Value indicating whether a subtraction went below zero, in which
+ * case the digits hold the difference modulo `2^(rn * DIGIT_BITS)`.
+ */
+static bool digits_addmul(
+    digit_tt *r,
+    size_t rn,
+    const digit_tt *a,
+    size_t an,
+    const digit_tt *b,
+    size_t bn,
+    bool subtract
+)
+{
+    digit_tt carry;
+    digit_tt digit;
+    size_t k;
+
+    digit_tt pending = 0;
+
+    // The carry out of each row goes to the digit above it, and what
+    // overflows from there is left for the next row, which ends one digit
+    // higher, so a carry is only propagated through the digits at the end.
+    for (size_t i = 0; i < bn; i++) {
+        k = i + an;
+
+        if (subtract) {
+            carry = digits_submul_1(r + i, a, an, b[i]);
+            digit = r[k];
+            r[k] = (digit_tt) (digit - carry);
+            carry = r[k] > digit;
+            digit = r[k];
+            r[k] = (digit_tt) (digit - pending);
+            pending = (digit_tt) (carry + (r[k] > digit));
+        } else {
+            carry = digits_addmul_1(r + i, a, an, b[i]);
+            digit = (digit_tt) (r[k] + carry);
+            carry = digit < carry;
+            r[k] = (digit_tt) (digit + pending);
+            pending = (digit_tt) (carry + (r[k] < pending));
+        }
+    }
+
+    for (k = an + bn; pending && k < rn; k++) {
+        digit = r[k];
+        r[k] = (digit_tt) (subtract ? digit - pending : digit + pending);
+        pending = subtract ? r[k] > digit : r[k] < digit;
+    }
+
+    // A borrow out of the most significant digit means the product was the
+    // larger of the two.
+    return pending != 0;
+}
+
+/**
+ * Implementation of "bigint_addmul" and "bigint_submul" without tracing.
+ */
+static bigint_st *addmul_untraced(
+    bigint_st *dest, bigint_st *a, bigint_st *b, bool subtract
+)
+{
+    size_t length;
+    size_t original_length;
+    bigint_st *result;
+    bigint_st *shorter;
+
+    bool negative = (a->negative != b->negative) != subtract;
+    bigint_st product = {NULL, 0, 0, false, false};
+
+    STATS_OPERATION(addmul, a->length + b->length);
+
+    if (bigint_eqz(a) || bigint_eqz(b)) {
+        return dest;
+    }
+
+    // Products past the schoolbook range are computed separately, as are
+    // those whose operands would be overwritten by the accumulation.
+    if (
+        dest == a || dest == b ||
+        (a->length < b->length ? a->length : b->length) >
+            threshold(THRESHOLD_MUL_KARATSUBA)
+    ) {
+        product.allocated = a->length + b->length + 1;
+
+        if (!(product.digits = digits_alloc(product.allocated))) {
+            return NULL;
+        }
+
+        result = mul_untraced(&product, a, b);
+
+        if (result) {
+            product.negative = negative;
+            result = bigint_add(dest, dest, &product);
+        }
+
+        digits_free(&product);
+        return result;
+    }
+
+    if (bigint_eqz(dest)) {
+        dest->negative = negative;
+    }
+
+    length = a->length + b->length;
+    length = (length > dest->length ? length : dest->length) + 1;
+
+    // The digits past the length may hold anything, and the sum is written
+    // to them.
+    original_length = dest->length;
+
+    if (resize(dest, length)) {
+        return NULL;
+    }
+
+    memset(
+        dest->digits + original_length, 0,
+        (length - original_length) * sizeof(digit_tt)
+    );
+
+    // The shorter operand gives the rows, which keeps the inner loops long.
+    if (a->length < b->length) {
+        shorter = a;
+        a = b;
+        b = shorter;
+    }
+
+    if (digits_addmul(
+        dest->digits, dest->length, a->digits, a->length, b->digits,
+        b->length, dest->negative != negative
+    )) {
+        // The product was larger, so the digits hold its two's complement.
+        for (size_t i = 0; i < dest->length; i++) {
+            dest->digits[i] = (digit_tt) ~dest->digits[i];
+        }
+
+        for (size_t i = 0; i < dest->length; i++) {
+            if (++dest->digits[i]) {
+                break;
+            }
+        }
+
+        dest->negative = negative;
+    }
+
+    normalize(dest);
+    return dest;
+}
+
+/**
+ * Add the product of two big integers to another in place, which avoids
+ * storing the product separately when the operands are small enough for
+ * schoolbook multiplication. This is the step of a dot product or of the
+ * evaluation of a polynomial.
+ *
+ * Arguments:
+ * - dest: The accumulator, which is replaced with `dest + a * b`.
+ * - a: Multiplicand.
+ * - b: Multiplicand.
+ *
+ * Return: A pointer to the result of the calculation if it succeeds and `NULL`
+ * otherwise.
+ */
+bigint_st *bigint_addmul(bigint_st *dest, bigint_st *a, bigint_st *b)
+{
+    bigint_st *result;
+    trace_span_st span;
+
+    trace_begin(&span, "addmul", a->length, b->length);
+    result = addmul_untraced(dest, a, b, false);
+    trace_end(&span, result);
+    return result;
+}
+
+/**
+ * Subtract the product of two big integers from another in place. This works
+ * like "bigint_addmul".
+ *
+ * Arguments:
+ * - dest: The accumulator, which is replaced with `dest - a * b`.
+ * - a: Multiplicand.
+ * - b: Multiplicand.
+ *
+ * Return: A pointer to the result of the calculation if it succeeds and `NULL`
+ * otherwise.
+ */
+bigint_st *bigint_submul(bigint_st *dest, bigint_st *a, bigint_st *b)
+{
+    bigint_st *result;
+    trace_span_st span;
+
+    trace_begin(&span, "addmul", a->length, b->length);
+    result = addmul_untraced(dest, a, b, true);
+    trace_end(&span, result);
+    return result;
+}
+
+/**
+ * Add the product of a big integer and an unsigned integer to another big
+ * integer in place. This works like "bigint_addmul".
+ *
+ * Arguments:
+ * - dest: The accumulator, which is replaced with `dest + a * b`.
+ * - a: Multiplicand.
+ * - b: Multiplicand.
+ *
+ * Return: A pointer to the result of the calculation if it succeeds and `NULL`
+ * otherwise.
+ */
+bigint_st *bigint_addmului(bigint_st *dest, bigint_st *a, uintmax_t b)
+{
+    digit_tt digits[DIGITS_FOR_INTMAX];
+
+    bigint_st multiplier = {digits, DIGITS_FOR_INTMAX, 0, false, true};
+
+    bigint_movui(&multiplier, b);
+    return bigint_addmul(dest, a, &multiplier);
+}
+
+/**
+ * Subtract the product of a big integer and an unsigned integer from another
+ * big integer in place. This works like "bigint_addmul".
+ *
+ * Arguments:
+ * - dest: The accumulator, which is replaced with `dest - a * b`.
+ * - a: Multiplicand.
+ * - b: Multiplicand.
+ *
+ * Return: A pointer to the result of the calculation if it succeeds and `NULL`
+ * otherwise.
+ */
+bigint_st *bigint_submului(bigint_st *dest, bigint_st *a, uintmax_t b)
+{
+    digit_tt digits[DIGITS_FOR_INTMAX];
+
+    bigint_st multiplier = {digits, DIGITS_FOR_INTMAX, 0, false, true};
+
+    bigint_movui(&multiplier, b);
+    return bigint_submul(dest, a, &multiplier);
+}
+
+/**
+ * Count the number of leading zeroes in the bits of a digit.
+ *
+ * Arguments:
+ * - x: A non-zero digit.
+ *
+ * Return: The number of leading zeroes.
+ */
+static inline unsigned digit_clz(digit_tt x)
+{
+    unsigned result = 0;
+    digit_tt mask = (digit_tt) 1 << (DIGIT_BITS - 1);
+
+    while ((mask & x) == 0) {
+        mask >>= 1;
+        result++;
+    }
+
+    return result;
+}
+
+/**
+ * Divide the magnitude of a big integer by a digit in place.
+ *
+ * Arguments:
+ * - x: The dividend. It is replaced with the quotient.
+ * - divisor: A non-zero digit.
+ *
+ * Return: The remainder.
+ */
+static digit_tt magnitude_divmod_digit(bigint_st *x, digit_tt divisor)
+{
+    digit_tt low;
+
+    digit_tt remainder = 0;
+    unsigned shift = digit_clz(divisor);
+
+    if (bigint_eqz(x)) {
+        return 0;
+    }
+
+    // The divisor is normalized so its most significant bit is set, and the
+    // dividend is shifted by the same amount as it is traversed. This does
+    // not change the quotient, and the remainder is shifted back at the end.
+    divisor = (digit_tt) (divisor << shift);
+
+    if (shift) {
+        remainder = x->digits[x->length - 1] >> (DIGIT_BITS - shift);
+    }
+
+    for (size_t i = x->length; i-- > 0; ) {
+        low = (digit_tt) (x->digits[i] << shift);
+
+        if (shift && i) {
+            low |= x->digits[i - 1] >> (DIGIT_BITS - shift);
+        }
+
+        x->digits[i] = digit_divide(remainder, low, divisor, &remainder);
+    }
+
+    normalize(x);
+    return remainder >> shift;
+}
+
+/**
+ * Shift an array of digits left by less than the width of a digit.
+ *
+ * Arguments:
+ * - dest: Output destination. This may be the same as the source.
+ * - src: Digits to shift.
+ * - length: Number of digits to shift.
+ * - shift: Number of bits to shift by.
+ *
+ * Return: The bits shifted out of the most significant digit.
+ */
+static digit_tt digits_shl(
+    digit_tt *dest, const digit_tt *src, size_t length, unsigned shift
+)
+{
+    digit_tt digit;
+
+    digit_tt carry = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        digit = src[i];
+        dest[i] = (digit_tt) (digit << shift) | carry;
+        carry = shift ? digit >> (DIGIT_BITS - shift) : 0;
+    }
+
+    return carry;
+}
+
+/**
+ * Shift an array of digits right by less than the width of a digit.
+ *
+ * Arguments:
+ * - dest: Output destination. This may be the same as the source.
+ * - src: Digits to shift.
+ * - length: Number of digits to shift.
+ * - shift: Number of bits to shift by.
+ */
+static void digits_shr(
+    digit_tt *dest, const digit_tt *src, size_t length, unsigned shift
+)
+{
+    digit_tt high;
+
+    for (size_t i = 0; i < length; i++) {
+        high = shift && i + 1 < length ? src[i + 1] << (DIGIT_BITS - shift) : 0;
+        dest[i] = (digit_tt) (src[i] >> shift) | high;
+    }
+}
+
+/**
+ * Replace the magnitude of a big integer with an array of digits.
+ *
+ * Arguments:
+ * - x: Output destination.
+ * - digits: The digits with the least significant digit first.
+ * - length: The number of digits.
+ *
+ * Return: 0 if the operation succeeds and -1 if it fails.
+ */
+static int magnitude_set_digits(
+    bigint_st *x, const digit_tt *digits, size_t length
+)
+{
+    if (resize(x, length)) {
+        return -1;
+    }
+
+    memcpy(x->digits, digits, length * sizeof(digit_tt));
+    x->negative = false;
+    normalize(x);
+    return 0;
+}
+
+/**
+ * Divide the magnitude of one big integer by the magnitude of another using
+ * Algorithm D from _The Art of Computer Programming_ Vol. 2, §4.3.1. Each
+ * quotient digit is estimated from the leading digits of the remainder and
+ * the divisor, and the estimate is corrected at most twice.
+ *
+ * Arguments:
+ * - q: Optional output destination for the quotient.
+ * - r: Optional output destination for the remainder.
+ * - inexact: Optional output pointer for a value indicating whether the
+ *   remainder is not 0, which is set even when "r" is NULL.
+ * - n: Dividend.
+ * - d: Divisor. This must not be 0.
+ *
+ * Return: 0 if the operation succeeds and -1 if it fails. The outputs are
+ * never negative, and they may be the same as either input.
+ */
+static int magnitude_divmod(
+    bigint_st *q, bigint_st *r, bool *inexact, bigint_st *n, bigint_st *d
+)
+{
+    bool borrow;
+    bool borrow_out;
+    digit_tt carry;
+    digit_tt *divisor;
+    digit_tt divisor_next;
+    digit_tt divisor_top;
+    digit_tt estimate;
+    digit_tt high;
+    digit_tt low;
+    digit_tt *quotient;
+    digit_tt *remainder;
+    digit_tt rest;
+    bool rest_overflow;
+    unsigned shift;
+    digit_tt sum;
+
+    size_t d_length = d->length;
+    size_t n_length = n->length;
+    int result = -1;
+    bigint_st scratch = {NULL, 0, 0, false, false};
+
+    if (magnitude_cmp(n, d) < 0) {
+        if (inexact) {
+            *inexact = bigint_nez(n);
+        }
+
+        if (r && r != n && bigint_mov(r, n)) {
+            return -1;
+        } else if (r) {
+            r->negative = false;
+        }
+
+        if (q) {
+            bigint_movui(q, 0);
+        }
+
+        return 0;
+    }
+
+    scratch.allocated = 2 * n_length + 2;
+
+    if (!(scratch.digits = digits_alloc(scratch.allocated))) {
+        return -1;
+    }
+
+    remainder = scratch.digits;
+    divisor = remainder + n_length + 1;
+    quotient = divisor + d_length;
+
+    if (d_length == 1) {
+        memcpy(quotient, n->digits, n_length * sizeof(digit_tt));
+        *remainder = magnitude_divmod_digit(
+            &(bigint_st) {quotient, n_length, n_length, false, true},
+            d->digits[0]
+        );
+        goto done;
+    }
+
+    // Normalize the divisor so its most significant bit is set. The dividend
+    // is shifted by the same amount, which gains it an extra digit.
+    shift = digit_clz(d->digits[d_length - 1]);
+    digits_shl(divisor, d->digits, d_length, shift);
+    remainder[n_length] = digits_shl(remainder, n->digits, n_length, shift);
+    divisor_top = divisor[d_length - 1];
+    divisor_next = divisor[d_length - 2];
+
+    for (size_t j = n_length - d_length + 1; j-- > 0; ) {
+        // Estimate the quotient digit from the two leading digits of the
+        // remainder. The leading digit never exceeds the divisor's, and when
+        // they are equal, the estimate is capped at the largest digit.
+        if (remainder[j + d_length] >= divisor_top) {
+            estimate = DIGIT_MAX;
+            rest = remainder[j + d_length - 1] + divisor_top;
+            rest_overflow = rest < divisor_top;
+        } else {
+            estimate = digit_divide(
+                remainder[j + d_length],
+                remainder[j + d_length - 1],
+                divisor_top,
+                &rest
+            );
+            rest_overflow = false;
+        }
+
+        // Use the next digit of the divisor to refine the estimate.
+        while (!rest_overflow) {
+            low = digit_muladd(estimate, divisor_next, 0, &high);
+
+            if (high < rest || (
+                high == rest && low <= remainder[j + d_length - 2]
+            )) {
+                break;
+            }
+
+            estimate--;
+            rest += divisor_top;
+            rest_overflow = rest < divisor_top;
+        }
+
+        // Subtract the product of the estimate and the divisor.
+        borrow = false;
+        carry = 0;
+
+        for (size_t i = 0; i <= d_length; i++) {
+            if (i < d_length) {
+                low = digit_muladd(estimate, divisor[i], carry, &carry);
+            } else {
+                low = carry;
+            }
+
+            sum = (digit_tt) (remainder[i + j] - low);
+            borrow_out = remainder[i + j] < low || sum < borrow;
+            remainder[i + j] = (digit_tt) (sum - borrow);
+            borrow = borrow_out;
+        }
+
+        // If the result is negative, the estimate was one too large, so the
+        // divisor is added back.
+        if (borrow) {
+            estimate--;
+            carry = 0;
+
+            for (size_t i = 0; i < d_length; i++) {
+                sum = (digit_tt) (remainder[i + j] + carry);
+                carry = sum < carry;
+                sum = (digit_tt) (sum + divisor[i]);
+                carry |= sum < divisor[i];
+                remainder[i + j] = sum;
+            }
+
+            remainder[j + d_length] = (digit_tt) (
+                remainder[j + d_length] + carry
+            );
+        }
+
+        quotient[j] = estimate;
+    }
+
+    // Undo the normalization of the remainder.
+    if (shift) {
+        for (size_t i = 0; i < d_length; i++) {
+            remainder[i] = (digit_tt) (
+                remainder[i] >> shift |
+                remainder[i + 1] << (DIGIT_BITS - shift)
+            );
+        }
+    }
+
+done:
+    if (inexact) {
+        *inexact = false;
+
+        for (size_t i = 0; i < d_length && !*inexact; i++) {
+            *inexact = remainder[i] != 0;
+        }
+    }
+
+    if (r && magnitude_set_digits(r, remainder, d_length)) {
+        goto error;
+    }
+
+    if (q && magnitude_set_digits(q, quotient, n_length - d_length + 1)) {
+        goto error;
+    }
+
+    result = 0;
+
+error:
+    digits_free(&scratch);
+    return result;
+}
+
+/**
+ * Implementation of "bigint_divmod" without tracing or counting.
+ */
+static int divmod_untraced(
+    bigint_st *q, bigint_st *r, bigint_st *n, bigint_st *d,
+    bigint_round_tt rounding
+)
+{
+    bool adjust;
+    bool inexact;
+    size_t length;
+
+    bigint_st *divisor = d;
+    int result = -1;
+
+    // The signs are saved because the outputs may be the same as the inputs.
+    bool n_negative = n->negative;
+    bool d_negative = d->negative;
+
+    // Cannot divide by 0.
+    if (bigint_eqz(d)) {
+        errno = EDOM;
+        return -1;
+    }
+
+    if (q && q == r) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (!q && !r) {
+        return 0;
+    }
+
+    // The divisor is needed after the division if the remainder is adjusted.
+    if (
+        r && rounding != BIGINT_ROUND_TRUNC && (q == d || r == d) &&
+        !(divisor = bigint_dup(d))
+    ) {
+        return -1;
+    }
+
+    // Rounding other than truncation depends on whether the division is
+    // exact, which is known even when the remainder is not wanted.
+    if (magnitude_divmod(q, r, &inexact, n, d)) {
+        goto done;
+    }
+
+    switch (rounding) {
+      case BIGINT_ROUND_FLOOR:
+        adjust = n_negative != d_negative;
+        break;
+
+      case BIGINT_ROUND_CEIL:
+        adjust = n_negative == d_negative;
+        break;
+
+      case BIGINT_ROUND_EUCLID:
+        adjust = n_negative;
+        break;
+
+      default:
+        adjust = false;
+        break;
+    }
+
+    // Rounding away from the truncated quotient adds one to its magnitude,
+    // and the magnitude of the remainder becomes its distance to the
+    // divisor.
+    if (adjust && inexact) {
+        if (q && magnitude_inc(q)) {
+            goto done;
+        }
+
+        if (r) {
+            length = r->length;
+
+            if (resize(r, divisor->length)) {
+                goto done;
+            }
+
+            digits_sub(
+                r->digits, divisor->digits, divisor->length, r->digits, length
+            );
+            normalize(r);
+        }
+    }
+
+    if (q) {
+        q->negative = bigint_nez(q) && n_negative != d_negative;
+    }
+
+    if (r) {
+        switch (rounding) {
+          case BIGINT_ROUND_FLOOR:
+            r->negative = d_negative;
+            break;
+
+          case BIGINT_ROUND_CEIL:
+            r->negative = !d_negative;
+            break;
+
+          case BIGINT_ROUND_EUCLID:
+            r->negative = false;
+            break;
+
+          default:
+            r->negative = n_negative;
+            break;
+        }
+
+        r->negative = r->negative && bigint_nez(r);
+    }
+
+    result = 0;
+
+done:
+    if (divisor != d) {
+        bigint_free(divisor);
+    }
+
+    return result;
+}
+
+/**
+ * Divide one big integer by another, rounding the quotient in one of several
+ * ways. The quotient and the remainder always satisfy `n = q * d + r` with
+ * the magnitude of "r" less than that of "d":
+ *
+ * - `BIGINT_ROUND_TRUNC` rounds toward zero like the "/" and "%" operators of
+ *   C, so the remainder has the sign of the numerator.
+ * - `BIGINT_ROUND_FLOOR` rounds toward negative infinity, so the remainder
+ *   has the sign of the denominator.
+ * - `BIGINT_ROUND_CEIL` rounds toward positive infinity, so the remainder has
+ *   the opposite sign of the denominator.
+ * - `BIGINT_ROUND_EUCLID` makes the remainder non-negative.
+ *
+ * Both results come from a single division, and an output that is NULL is
+ * neither stored nor given any memory, so the remainder alone costs no more
+ * than "bigint_mod".
+ *
+ * Arguments:
+ * - q: Optional output destination for the quotient.
+ * - r: Optional output destination for the remainder, which must not be the
+ *   same as "q".
+ * - n: Numerator.
+ * - d: Denominator.
+ * - rounding: How the quotient is rounded.
+ *
+ * Return: 0 if the operation succeeds and -1 if it fails, in which case
+ * "errno" is set accordingly. `EDOM` is used to indicate division by zero.
+ */
+int bigint_divmod(
+    bigint_st *q, bigint_st *r, bigint_st *n, bigint_st *d,
+    bigint_round_tt rounding
+)
+{
+    int result;
+    trace_span_st span;
+
+    STATS_OPERATION(div, n->length + d->length);
+
+    trace_begin(&span, "div", n->length, d->length);
+    result = divmod_untraced(q, r, n, d, rounding);
+    trace_end(&span, result ? NULL : q ? q : r);
+    return result;
+}
+
+/**
+ * Implementation of "bigint_div" without tracing.
+ */
+static bigint_st *div_untraced(
+    bigint_st *q, bigint_st **r, bigint_st *n, bigint_st *d
+)
+{
+    bool free_q_on_failure = false;
+    bool free_r_on_failure = false;
+
+    STATS_OPERATION(div, n->length + d->length);
+
+    // Cannot divide by 0.
+    if (bigint_eqz(d)) {
+        errno = EDOM;
+        return NULL;
+    }
+
+    if (!q) {
+        if (!(q = bigint_from_int(0))) {
+            return NULL;
+        }
+
+        free_q_on_failure = true;
+    }
+
+    if (r && !*r) {
+        if (!(*r = bigint_from_int(0))) {
+            goto error;
+        }
+
+        free_r_on_failure = true;
+    }
+
+    if (divmod_untraced(q, r ? *r : NULL, n, d, BIGINT_ROUND_TRUNC)) {
+        goto error;
+    }
+
+    return q;
+
+error:
+    if (free_q_on_failure) {
+        bigint_free(q);
+    }
+
+    if (free_r_on_failure) {
+        bigint_free(*r);
+        *r = NULL;
+    }
+
+    return NULL;
+}
+
+/**
+ * Divide one big integer by another.
+ *
+ * Arguments:
+ * - q: Quotient; pointer to the output destination. If this is NULL, a heap
+ *   pointer is returned that the caller is responsible for freeing with
+ *   "bigint_free".
+ * - r: Optional output pointer for the remainder.
+ * - n: Numerator.
+ * - d: Denominator.
+ *
+ * Return: A pointer to the result of the calculation. If there were any
+ * errors, this will be `NULL` and "errno" will be set accordingly. "EDOM" is
+ * used to indicate division by zero.
+ */
+bigint_st *bigint_div(bigint_st *q, bigint_st **r, bigint_st *n, bigint_st *d)
+{
+    bigint_st *result;
+    trace_span_st span;
+
+    trace_begin(&span, "div", n->length, d->length);
+    result = div_untraced(q, r, n, d);
+    trace_end(&span, result);
+    return result;
+}
+
+/**
+ * Implementation of "bigint_mod" without tracing.
+ */
+static bigint_st *mod_untraced(bigint_st *r, bigint_st *n, bigint_st *d)
+{
+    bool free_r_on_error = false;
+
+    STATS_OPERATION(mod, n->length + d->length);
+
+    if (!r) {
+        if (!(r = bigint_from_int(0))) {
+            return NULL;
+        }
+
+        free_r_on_error = true;
+    }
+
+    // Only the remainder is computed.
+    if (divmod_untraced(NULL, r, n, d, BIGINT_ROUND_TRUNC)) {
+        if (free_r_on_error) {
+            bigint_free(r);
+        }
+
+        return NULL;
+    }
+
+    return r;
+}
+
+/**
+ * Compute the module of one integer by another.
+ *
+ * Arguments:
+ * - r: Remainder; pointer to the output destination. If this is NULL, a heap
+ *   pointer is returned that the caller is responsible for freeing with
+ *   "bigint_free".
+ * - n: Numerator.
+ * - d: Denominator.
+ *
+ * Return: A pointer to the result of the calculation. If there were any
+ * errors, this will be `NULL` and "errno" will be set accordingly. "EDOM" is
+ * used to indicate division by zero.
+ */
+bigint_st *bigint_mod(bigint_st *r, bigint_st *n, bigint_st *d)
+{
+    bigint_st *result;
+    trace_span_st span;
+
+    trace_begin(&span, "mod", n->length, d->length);
+    result = mod_untraced(r, n, d);
+    trace_end(&span, result);
+    return result;
+}
+
+/**
+ * Implementation of "bigint_divexact" without tracing.
+ */
+static bigint_st *divexact_untraced(bigint_st *q, bigint_st *n, bigint_st *d)
+{
+    digit_tt borrow;
+    digit_tt digit;
+    digit_tt *digits;
+    digit_tt *divisor;
+    size_t dn;
+    digit_tt inverse;
+    size_t k;
+    size_t length;
+    size_t nn;
+    size_t qn;
+    size_t shift;
+
+    bool free_q_on_error = false;
+    bool negative = n->negative != d->negative;
+    bigint_st scratch = {NULL, 0, 0, false, false};
+
+    STATS_OPERATION(div, n->length + d->length);
+
+    if (bigint_eqz(d)) {
+        errno = EDOM;
+        return NULL;
+    }
+
+    if (!q) {
+        if (!(q = bigint_from_int(0))) {
+            return NULL;
+        }
+
+        free_q_on_error = true;
+    }
+
+    if (n->length < d->length) {
+        bigint_movui(q, 0);
+        return q;
+    }
+
+    // The trailing zeros of the divisor are also trailing zeros of the
+    // dividend, so both are shifted right by them to make the divisor odd.
+    // The copies are the working space of the division.
+    shift = ctz(d);
+    nn = n->length - shift / DIGIT_BITS;
+    dn = d->length - shift / DIGIT_BITS;
+    scratch.allocated = nn + dn;
+
+    if (!(scratch.digits = digits_alloc(scratch.allocated))) {
+        goto error;
+    }
+
+    digits = scratch.digits;
+    divisor = digits + nn;
+    digits_shr(digits, n->digits + n->length - nn, nn, shift % DIGIT_BITS);
+    digits_shr(divisor, d->digits + d->length - dn, dn, shift % DIGIT_BITS);
+    dn -= !divisor[dn - 1];
+    nn -= !digits[nn - 1];
+    qn = nn >= dn ? nn - dn + 1 : 0;
+
+    // An odd number is its own inverse modulo 8, and each step of Newton's
+    // method doubles the number of correct low bits.
+    inverse = divisor[0];
+
+    for (unsigned bits = 3; bits < DIGIT_BITS; bits *= 2) {
+        inverse = (digit_tt) (
+            (uintmax_t) inverse * (2 - (uintmax_t) divisor[0] * inverse)
+        );
+    }
+
+    // Each digit of the quotient is the one that clears the lowest digit of
+    // what is left of the dividend, so the digits are found from the least
+    // significant without estimates or corrections. Only the lowest "qn"
+    // digits of the dividend affect the quotient, and each one that has been
+    // cleared is replaced by the quotient digit that cleared it.
+    for (size_t i = 0; i < qn; i++) {
+        digit = (digit_tt) ((uintmax_t) digits[i] * inverse);
+        length = qn - i < dn ? qn - i : dn;
+        borrow = digits_submul_1(digits + i, divisor, length, digit);
+
+        for (k = i + length; borrow && k < qn; k++) {
+            digits[k] = (digit_tt) (digits[k] - borrow);
+            borrow = (digit_tt) (digits[k] + borrow) < borrow;
+        }
+
+        digits[i] = digit;
+    }
+
+    if (magnitude_set_digits(q, digits, qn)) {
+        goto error;
+    }
+
+    q->negative = negative && bigint_nez(q);
+    digits_free(&scratch);
+    return q;
+
+error:
+    digits_free(&scratch);
+
+    if (free_q_on_error) {
+        bigint_free(q);
+    }
+
+    return NULL;
+}
+
+/**
+ * Divide one big integer by another that is known to divide it exactly, as
+ * in the computation of binomial coefficients or the reduction of fractions
+ * by their greatest common divisor. The quotient is computed from its least
+ * significant digit with the 2-adic inverse of the divisor (Hensel division),
+ * which needs one multiplication per quotient digit instead of the estimate,
+ * the correction and the remainder of "bigint_div".
+ *
+ * Arguments:
+ * - q: Quotient; pointer to the output destination. If this is NULL, a heap
+ *   pointer is returned that the caller is responsible for freeing with
+ *   "bigint_free".
+ * - n: Numerator, which must be a multiple of the denominator. The result is
+ *   unspecified otherwise.
+ * - d: Denominator.
+ *
+ * Return: A pointer to the result of the calculation. If there were any
+ * errors, this will be `NULL` and "errno" will be set accordingly. "EDOM" is
+ * used to indicate division by zero.
+ */
+bigint_st *bigint_divexact(bigint_st *q, bigint_st *n, bigint_st *d)
+{
+    bigint_st *result;
+    trace_span_st span;
+
+    trace_begin(&span, "div", n->length, d->length);
+    result = divexact_untraced(q, n, d);
+    trace_end(&span, result);
+    return result;
+}
+
+/**
+ * Divide a big integer by an unsigned integer that is known to divide it
+ * exactly. This works like "bigint_divexact".
+ *
+ * Arguments:
+ * - q: Quotient; pointer to the output destination. If this is NULL, a heap
+ *   pointer is returned that the caller is responsible for freeing with
+ *   "bigint_free".
+ * - n: Numerator, which must be a multiple of the denominator.
+ * - d: Denominator.
+ *
+ * Return: A pointer to the result of the calculation. If there were any
+ * errors, this will be `NULL` and "errno" will be set accordingly. "EDOM" is
+ * used to indicate division by zero.
  */
-static void *safe_calloc(size_t nmemb, size_t size)
+bigint_st *bigint_divexactui(bigint_st *q, bigint_st *n, uintmax_t d)
 {
-    if (nmemb > SIZE_MAX / size) {
-        errno = EOVERFLOW;
+    digit_tt digits[DIGITS_FOR_INTMAX];
+
+    bigint_st divisor = {digits, DIGITS_FOR_INTMAX, 0, false, true};
+
+    bigint_movui(&divisor, d);
+    return bigint_divexact(q, n, &divisor);
+}
+
+/**
+ * Check that a power can be stored before it is computed.
+ *
+ * Arguments:
+ * - base_bits: The number of bits in the magnitude of the base.
+ * - exponent: The power the base is raised to. Exponents that do not fit in
+ *   an uintmax_t can be passed as `UINTMAX_MAX`.
+ *
+ * Return: 0 if the power may be computed and -1 if it may not, in which case
+ * "errno" is set to `ERANGE` if the number of bits in the result cannot be
+ * represented as a size_t and to `ENOMEM` if the result would go over the
+ * memory limit of the calling thread.
+ */
+static int power_check(size_t base_bits, uintmax_t exponent)
+{
+    // The magnitudes 0 and 1 are their own powers.
+    if (base_bits < 2 || !exponent) {
+        return 0;
+    }
+
+    // A base with "b" bits raised to "e" has at least `(b - 1) * e + 1` bits.
+    if (exponent > (SIZE_MAX - 1) / (base_bits - 1)) {
+        errno = ERANGE;
+        return -1;
+    }
+
+    return memory_check(
+        CEIL_DIV((base_bits - 1) * (size_t) exponent + 1, DIGIT_BITS)
+    );
+}
+
+/**
+ * Implementation of "bigint_pow" without tracing.
+ */
+static bigint_st *pow_untraced(bigint_st* dest, bigint_st *base, bigint_st* exp)
+{
+    bool free_dest_on_error = false;
+    bool negative = bigint_nez(exp) && bigint_ltz(base) && exp->digits[0] & 1;
+
+    STATS_OPERATION(pow, base->length + exp->length);
+
+    if (bigint_ltz(exp)) {
+        errno = EDOM;
+        return NULL;
+    }
+
+    if (power_check(bit_length(base), bigint_toui(exp))) {
+        return NULL;
+    }
+
+    // TODO: handle exp = 1 and base = 0 in a way that avoid unnecessary dup
+    // calls.
+    if (!(exp = bigint_dup(exp))) {
+        goto error;
+    }
+
+    if (!(base = bigint_dup(base))) {
+        goto error;
+    }
+
+    if (dest) {
+        bigint_movui(dest, 1);
+    } else {
+        dest = bigint_from_int(1);
+        free_dest_on_error = true;
+    }
+
+    if (bigint_eqz(exp)) {
+        bigint_movui(dest, 1);
+        goto done;
+    }
+
+    if (bigint_eqz(base)) {
+        bigint_movui(dest, 0);
+        goto done;
+    }
+
+    if (!dest) {
+        goto error;
+    }
+
+    while (1) {
+        if ((exp->digits[0] & 1) && !bigint_mul(dest, dest, base)) {
+            goto error;
+        }
+
+        bigint_shri(exp, exp, 1);
+
+        if (bigint_eqz(exp)) {
+            break;
+        }
+
+        if (!bigint_mul(base, base, base)) {
+            goto error;
+        }
+    }
+
+done:
+    dest->negative = negative;
+    bigint_free(base);
+    bigint_free(exp);
+    return dest;
+
+error:
+    if (base) {
+        bigint_free(base);
+    }
+
+    if (free_dest_on_error) {
+        bigint_free(dest);
+    }
+
+    if (exp) {
+        bigint_free(exp);
+    }
+
+    return NULL;
+}
+
+/**
+ * Compute the value of a number raise to an exponent.
+ *
+ * Arguments:
+ * - base: The base big integer.
+ * - exp: The exponent the base is raised to as a big integer.
+ *
+ * Return: A pointer to the result of the calculation if it succeeds or `NULL`
+ * if it fails. If the exponent is less than 0, "errno" is set to `EDOM`.
+ */
+bigint_st *bigint_pow(bigint_st* dest, bigint_st *base, bigint_st* exp)
+{
+    bigint_st *result;
+    trace_span_st span;
+
+    trace_begin(&span, "pow", base->length, exp->length);
+    result = pow_untraced(dest, base, exp);
+    trace_end(&span, result);
+    return result;
+}
+
+/**
+ * Compute a power of ten by multiplying together entries from the table of
+ * `10^(2^k)` values that correspond to the bits set in the exponent. Powers
+ * beyond the end of the table are produced by repeatedly squaring its last
+ * entry.
+ *
+ * Arguments:
+ * - dest: Output destination.
+ * - exponent: The power ten is raised to.
+ *
+ * Return: A pointer to the destination if the operation succeeds or `NULL` if
+ * it fails.
+ */
+static bigint_st *power_of_ten(bigint_st *dest, uintmax_t exponent)
+{
+    bigint_st *square;
+
+    bigint_movui(dest, 1);
+
+    for (size_t k = 0; exponent && k < POWER_OF_TEN_TABLE_SIZE; k++) {
+        if ((exponent & 1) && !bigint_mul(dest, dest, POWER_OF_TEN(k))) {
+            return NULL;
+        }
+
+        exponent >>= 1;
+    }
+
+    if (exponent) {
+        if (!(square = bigint_dup(POWER_OF_TEN(POWER_OF_TEN_TABLE_SIZE - 1)))) {
+            return NULL;
+        }
+
+        for (; exponent; exponent >>= 1) {
+            if (!bigint_mul(square, square, square)) {
+                goto error;
+            }
+
+            if ((exponent & 1) && !bigint_mul(dest, dest, square)) {
+                goto error;
+            }
+        }
+
+        bigint_free(square);
+    }
+
+    return dest;
+
+error:
+    bigint_free(square);
+    return NULL;
+}
+
+/**
+ * Compute a power of a small base without consulting the power cache.
+ *
+ * Arguments:
+ * - base: The base. This must not exceed `SMALL_NUMBERS_MAX`.
+ * - exponent: The power the base is raised to.
+ *
+ * Return: A newly allocated big integer or `NULL` if the operation fails.
+ */
+static bigint_st *power_compute(unsigned base, uintmax_t exponent)
+{
+    bigint_st *exp;
+    bigint_st *result;
+
+    if (power_check(bit_length(SMALL_NUMBER(base)), exponent)) {
+        return NULL;
+    }
+
+    if (base == 10) {
+        if (!(result = bigint_from_int(0))) {
+            return NULL;
+        }
+
+        if (!power_of_ten(result, exponent)) {
+            bigint_free(result);
+            return NULL;
+        }
+
+        return result;
+    }
+
+    if (!(exp = bigint_from_uint(exponent))) {
         return NULL;
     }
-
-    return malloc(nmemb * size);
+
+    result = bigint_pow(NULL, SMALL_NUMBER(base), exp);
+    bigint_free(exp);
+    return result;
+}
+
+/**
+ * Remove an entry from the recency list of the power cache. The caller must
+ * hold the cache's lock.
+ *
+ * Arguments:
+ * - entry: Entry to remove.
+ */
+static void power_cache_unlink(power_cache_entry_st *entry)
+{
+    if (entry->newer) {
+        entry->newer->older = entry->older;
+    } else {
+        power_cache.newest = entry->older;
+    }
+
+    if (entry->older) {
+        entry->older->newer = entry->newer;
+    } else {
+        power_cache.oldest = entry->newer;
+    }
+
+    power_cache.bytes -= entry->bytes;
+}
+
+/**
+ * Add an entry to the power cache as the most recently used one. The caller
+ * must hold the cache's lock.
+ *
+ * Arguments:
+ * - entry: Entry to add.
+ */
+static void power_cache_push(power_cache_entry_st *entry)
+{
+    entry->newer = NULL;
+    entry->older = power_cache.newest;
+
+    if (power_cache.newest) {
+        power_cache.newest->newer = entry;
+    } else {
+        power_cache.oldest = entry;
+    }
+
+    power_cache.newest = entry;
+    power_cache.bytes += entry->bytes;
+}
+
+/**
+ * Find an entry in the power cache and mark it as the most recently used one.
+ * The caller must hold the cache's lock.
+ *
+ * Arguments:
+ * - base: The base of the power.
+ * - exponent: The exponent of the power.
+ *
+ * Return: A pointer to the entry or `NULL` if there is no matching entry.
+ */
+static power_cache_entry_st *power_cache_find(
+    unsigned base, uintmax_t exponent
+)
+{
+    power_cache_entry_st *entry;
+
+    for (entry = power_cache.newest; entry; entry = entry->older) {
+        if (entry->base == base && entry->exponent == exponent) {
+            break;
+        }
+    }
+
+    if (entry && entry != power_cache.newest) {
+        power_cache_unlink(entry);
+        power_cache_push(entry);
+    }
+
+    return entry;
+}
+
+/**
+ * Free an entry of the cache of powers and its value. The digits of a cached
+ * value are not charged to any thread, so they are freed without crediting
+ * the thread that happens to evict them.
+ *
+ * Arguments:
+ * - entry: The entry, which must not be in the cache.
+ */
+static void power_cache_free(power_cache_entry_st *entry)
+{
+    xfree(entry->value->digits);
+    xfree(entry->value);
+    xfree(entry);
+}
+
+/**
+ * Evict the least recently used entries that are not in use until the cache
+ * has room for the given number of bytes or nothing else can be evicted. The
+ * caller must hold the cache's lock.
+ *
+ * Arguments:
+ * - bytes: Amount of space needed.
+ */
+static void power_cache_evict(size_t bytes)
+{
+    power_cache_entry_st *entry;
+    power_cache_entry_st *newer;
+
+    for (entry = power_cache.oldest; entry; entry = newer) {
+        if (power_cache.bytes <= power_cache.limit &&
+          power_cache.limit - power_cache.bytes >= bytes) {
+            break;
+        }
+
+        newer = entry->newer;
+
+        if (entry->references == 0) {
+            power_cache_unlink(entry);
+            power_cache_free(entry);
+        }
+    }
 }
 
 /**
- * This function works like _reallocarray(3)_, but when the total number of
- * bytes would lead to an integer overflow, the allocation fails.
+ * Release a value returned by "power_cache_get". Values that are not tracked
+ * by the cache are freed.
  *
  * Arguments:
- * - nmemb: Number of members for which space should be allocated.
- * - size: The size of each member for which space should be allocated.
- *
- * Return: A pointer to the allocated memory if the allocation succeeds.
+ * - value: Value to release.
  */
-static void *safe_reallocarray(void *ptr, size_t nmemb, size_t size)
+static void power_cache_release(bigint_st *value)
 {
-    if (nmemb > SIZE_MAX / size) {
-        errno = EOVERFLOW;
-        return NULL;
+    power_cache_entry_st *entry;
+
+    pthread_mutex_lock(&power_cache.lock);
+
+    for (entry = power_cache.newest; entry; entry = entry->older) {
+        if (entry->value == value) {
+            entry->references--;
+            break;
+        }
+    }
+
+    // Entries that were in use when the limit was exceeded could not be
+    // evicted at the time.
+    if (entry && entry->references == 0) {
+        power_cache_evict(0);
     }
 
-    return realloc(ptr, nmemb * size);
+    pthread_mutex_unlock(&power_cache.lock);
+
+    if (!entry) {
+        bigint_free(value);
+    }
 }
 
 /**
- * Change the length of a number and reallocate the space available for the
- * digits as necessary.
+ * Get a power of a small base. Results are kept in a size-bounded cache that
+ * is shared by all threads, so repeated conversions of similarly sized
+ * numbers do not recompute the same powers. When the power is not cached but
+ * its square root is, the power is produced by squaring the cached value.
+ * Every value returned by this function must be passed to
+ * "power_cache_release" once it is no longer needed, and it must never be
+ * modified.
  *
  * Arguments:
- * - x: A big integer.
- * - length: The new length.
+ * - base: The base. This must not exceed `SMALL_NUMBERS_MAX`.
+ * - exponent: The power the base is raised to.
  *
- * Return: 0 if the operation succeeds and -1 if it fails.
+ * Return: A pointer to the power or `NULL` if it could not be computed.
  */
-static int resize(bigint_st *x, size_t length)
+static bigint_st *power_cache_get(unsigned base, uintmax_t exponent)
 {
-    size_t original_allocated = x->allocated;
+    size_t bytes;
+    power_cache_entry_st *entry;
+    bigint_st *value;
 
-    while (length >= x->allocated) {
-        x->allocated *= 2;
+    bigint_st *root = NULL;
 
-        // If doubling causes an overflow, just use the exact length provided.
-        if (x->allocated <= original_allocated) {
-            x->allocated = length;
-            break;
-        }
+    pthread_mutex_lock(&power_cache.lock);
+
+    if ((entry = power_cache_find(base, exponent))) {
+        entry->references++;
+        pthread_mutex_unlock(&power_cache.lock);
+        return entry->value;
     }
 
-    if (x->allocated > original_allocated) {
-        digit_tt *new = safe_reallocarray(
-            x->digits, x->allocated, sizeof(digit_tt)
-        );
+    if (exponent % 2 == 0 && (entry = power_cache_find(base, exponent / 2))) {
+        entry->references++;
+        root = entry->value;
+    }
 
-        if (!new) {
-            x->allocated = original_allocated;
-            return -1;
-        }
+    pthread_mutex_unlock(&power_cache.lock);
 
-        x->digits = new;
-        memset(
-            x->digits + original_allocated,
-            0,
-            sizeof(digit_tt) * (x->allocated - original_allocated)
-        );
+    // The power is computed without holding the lock so other threads are
+    // not blocked by what may be a very large multiplication.
+    if (root) {
+        value = bigint_mul(NULL, root, root);
+        power_cache_release(root);
+    } else {
+        value = power_compute(base, exponent);
     }
 
-    x->length = length;
-    return 0;
+    if (!value || !(entry = safe_calloc(1, sizeof(*entry)))) {
+        // Failing to cache the value is not fatal.
+        return value;
+    }
+
+    entry->base = base;
+    entry->exponent = exponent;
+    entry->value = value;
+    entry->bytes = sizeof(*entry) + sizeof(*value) +
+        value->allocated * sizeof(digit_tt);
+    entry->references = 1;
+
+    pthread_mutex_lock(&power_cache.lock);
+
+    if (power_cache_find(base, exponent) || entry->bytes > power_cache.limit) {
+        // Another thread already cached the same power, or the value is too
+        // large to ever be cached, so the value is returned to the caller
+        // without being tracked, and "power_cache_release" frees it.
+        xfree(entry);
+    } else {
+        power_cache_evict(entry->bytes);
+        power_cache_push(entry);
+
+        // The cache is bounded by its own limit, so its values stop counting
+        // against the memory limit of the thread that computed them once they
+        // are adopted.
+        bytes = value->allocated * sizeof(digit_tt);
+        memory.used = memory.used > bytes ? memory.used - bytes : 0;
+    }
+
+    pthread_mutex_unlock(&power_cache.lock);
+    return value;
 }
 
 /**
- * Change the length of a number and reallocate the space available for the
- * digits as necessary to be the sum of two values. If that sum results in an
- * overflow, this function will fail.
- *
- * Arguments:
- * - x: A big integer.
- * - a: Addend.
- * - b: Addend.
- *
- * Return: 0 if the operation succeeds and -1 if it fails.
+ * Release the memory held by the cache of powers used by conversions and the
+ * tables of roots used by multiplication. Values that are being used by other
+ * threads are kept. This function is thread safe.
  */
-static int resize_sum(bigint_st *x, size_t a, size_t b)
+void bigint_cleanup(void)
 {
-    size_t sum = a + b;
-
-    if (sum < a) {
-        errno = EOVERFLOW;
-        return -1;
+    size_t limit;
+
+    pthread_mutex_lock(&power_cache.lock);
+    limit = power_cache.limit;
+    power_cache.limit = 0;
+    power_cache_evict(0);
+    power_cache.limit = limit;
+    pthread_mutex_unlock(&power_cache.lock);
+
+    pthread_mutex_lock(&ntt_tables_lock);
+
+    for (unsigned i = 0; i < NTT_PRIMES; i++) {
+        for (unsigned log = 0; log <= NTT_LOG_MAX / 2; log++) {
+            if (ntt_tables[i][log] && !ntt_tables[i][log]->references) {
+                xfree(ntt_tables[i][log]);
+                ntt_tables[i][log] = NULL;
+            }
+        }
     }
 
-    return resize(x, sum);
+    pthread_mutex_unlock(&ntt_tables_lock);
 }
 
 /**
- * A thin wrapper around _free(3)_ that ensures errno is preserved when the
- * call returns. See also: <https://www.austingroupbugs.net/view.php?id=385>.
+ * Set the maximum amount of memory in bytes that may be used to cache powers
+ * that are needed when converting numbers to and from strings. The least
+ * recently used values are evicted when the limit is reached. Setting the
+ * limit to 0 disables the cache. This function is thread safe.
  *
  * Arguments:
- *- ptr: Pointer to free.
+ * - limit: The limit in bytes.
  */
-static void xfree(void *ptr)
+void bigint_set_power_cache_limit(size_t limit)
 {
-    int saved_errno = errno;
+    pthread_mutex_lock(&power_cache.lock);
+    power_cache.limit = limit;
+    power_cache_evict(0);
+    pthread_mutex_unlock(&power_cache.lock);
+}
 
-    free(ptr);
+/**
+ * Get the amount of memory in bytes used by the cache of powers. This
+ * function is thread safe.
+ *
+ * Return: The number of bytes used by the values in the cache and the
+ * structures that track them.
+ */
+size_t bigint_power_cache_usage(void)
+{
+    size_t bytes;
 
-    errno = saved_errno;
+    pthread_mutex_lock(&power_cache.lock);
+    bytes = power_cache.bytes;
+    pthread_mutex_unlock(&power_cache.lock);
+    return bytes;
 }
 
 /**
- * Determines whether or not a big integer is a power of two.
+ * Set the maximum amount of memory in bytes that the digits of big integers
+ * allocated by the calling thread may use. Once the limit is reached,
+ * operations that need more digits fail with "errno" set to `ENOMEM` before
+ * they do any work, and exponentiation, including the exponents of parsed
+ * decimals, fails when the projected size of the result would go over the
+ * limit. Digits are charged to the thread that allocates them and credited
+ * to the thread that frees them. Values adopted by the cache of powers stop
+ * counting once they are cached, since the cache has a limit of its own. The
+ * helper threads of "bigint_strntobiv" and "bigint_snbprintv" and the parts
+ * of a conversion handed to the threads of "bigint_set_threads" are each
+ * checked against the limit of the thread that started them.
  *
  * Arguments:
- * - x: Big integer.
+ * - limit: The limit in bytes or 0 to remove the limit.
+ */
+void bigint_set_memory_limit(size_t limit)
+{
+    memory.limit = limit;
+}
+
+/**
+ * Get the amount of memory in bytes used by the digits of big integers that
+ * were allocated by the calling thread and have not been freed. Values held
+ * by the cache of powers are not included.
  *
- * Return: True if the number is a power of two or false otherwise.
+ * Return: The number of bytes.
  */
-bool bigint_is_power_of_2(bigint_st *x)
+size_t bigint_memory_usage(void)
 {
-    if (bigint_eqz(x)) {
-        return false;
-    }
+    return memory.used;
+}
 
-    for (size_t n = 0; n < x->length - 1; n++) {
-        if (x->digits[n] != 0) {
-            return false;
+/**
+ * Find a threshold by name.
+ *
+ * Arguments:
+ * - name: The name of the threshold.
+ *
+ * Return: The threshold or NULL with "errno" set to `EINVAL` if no threshold
+ * has that name.
+ */
+static threshold_st *threshold_find(const char *name)
+{
+    for (size_t i = 0; i < THRESHOLD_COUNT; i++) {
+        if (!strcmp(thresholds[i].name, name)) {
+            return &thresholds[i];
         }
     }
 
-    return POWER_OF_2(x->digits[x->length - 1]);
+    errno = EINVAL;
+    return NULL;
 }
 
 /**
- * Release the resources associated with a big integer. This function is
- * guaranteed to preserve errno.
+ * Change the size at which the library switches between two algorithms for
+ * the same operation. The defaults are chosen when the library is built and
+ * can be measured for a specific machine with "tune.c". Changes apply to the
+ * whole process, and this function is thread safe. The thresholds are:
+ *
+ * - parse_dc: Number of digits above which parsing splits a run of numerals
+ *   in half.
+ * - print_dc: Number of digits above which printing splits a value in half.
+ * - mul_karatsuba: Number of digits in the smaller operand above which
+ *   multiplication uses the Karatsuba algorithm.
+ * - mul_parallel: Number of digits in the smaller operand above which the
+ *   subproducts of the Karatsuba algorithm are handed to the threads started
+ *   with "bigint_set_threads".
+ * - mul_ntt: Number of digits in the smaller operand above which
+ *   multiplication uses a number-theoretic transform.
+ * - convert_parallel: Number of digits above which divide-and-conquer
+ *   parsing and printing hand one half of every split to the threads started
+ *   with "bigint_set_threads".
  *
  * Arguments:
- * - x: A big integer.
+ * - name: The name of the threshold.
+ * - value: The new value which must be at least 1. The value 0 restores the
+ *   value the threshold had when the library was built.
+ *
+ * Return: 0 if the operation succeeds and -1 if no threshold has the given
+ * name, in which case "errno" is set to `EINVAL`.
  */
-void bigint_free(bigint_st *x)
+int bigint_set_threshold(const char *name, size_t value)
 {
-    xfree(x->digits);
-    xfree(x);
+    threshold_st *entry = threshold_find(name);
+
+    if (!entry) {
+        return -1;
+    }
+
+    atomic_store_explicit(
+        &entry->value, value ? value : entry->initial, memory_order_relaxed
+    );
+    return 0;
 }
 
 /**
- * Duplicate a big integer. The caller is responsible for calling "bigint_free"
- * when the structure is no longer needed.
+ * Get the current value of a threshold. See "bigint_set_threshold" for the
+ * list of thresholds. This function is thread safe.
  *
  * Arguments:
- * - x: Value to duplicate.
+ * - name: The name of the threshold.
  *
- * Return: A pointer to the duplicated structure or `NULL` if it could not be
- * duplicated in which case "errno" will be set appropriately.
+ * Return: The value of the threshold or 0 if no threshold has the given name,
+ * in which case "errno" is set to `EINVAL`.
  */
-bigint_st *bigint_dup(bigint_st *x)
+size_t bigint_get_threshold(const char *name)
 {
-    bigint_st *new = malloc(sizeof(*x));
+    threshold_st *entry = threshold_find(name);
 
-    if (!new) {
-        return NULL;
+    if (!entry) {
+        return 0;
     }
 
-    *new = *x;
-    new->digits = safe_calloc(x->allocated, sizeof(digit_tt));
+    return atomic_load_explicit(&entry->value, memory_order_relaxed);
+}
 
-    if (!new->digits) {
-        xfree(new);
-        return NULL;
+/**
+ * Set the number of threads that may work on a single multiplication or
+ * conversion, including the thread that calls it. Products whose operands
+ * are larger than the "mul_parallel" threshold hand their subproducts to a
+ * pool of worker threads shared by the whole process, and those past the
+ * "mul_ntt" threshold split their transforms between the same threads, so
+ * one multiplication of numbers with millions of digits can use every core.
+ * Parsing and printing numbers past the "convert_parallel" threshold hand
+ * one half of every split to the pool as well. Operations that are running
+ * when the pool changes finish on the threads that remain. The subproducts
+ * only use memory allocated up front by the calling thread, and the memory
+ * and counters of the parts of a conversion are added to the thread that
+ * started it, so its memory limit and counters still cover the whole
+ * operation. This function is thread safe.
+ *
+ * Arguments:
+ * - threads: The number of threads. The values 0 and 1 stop the workers, so
+ *   every multiplication runs on the thread that calls it.
+ *
+ * Return: 0 if the operation succeeds and -1 if a thread could not be
+ * created, in which case the pool keeps the threads that were created.
+ */
+int bigint_set_threads(unsigned threads)
+{
+    pthread_t *workers;
+
+    int error = 0;
+    unsigned count = 0;
+
+    pthread_mutex_lock(&pool.configure);
+    pool_stop();
+
+    if (threads > 1) {
+        if (!(workers = safe_calloc(threads - 1, sizeof(*workers)))) {
+            error = errno;
+        }
+
+        while (workers && count < threads - 1 && !error) {
+            if (!(error = pthread_create(
+                &workers[count], NULL, pool_worker, NULL
+            ))) {
+                count++;
+            }
+        }
+
+        pool.workers = workers;
+        atomic_store(&pool.count, count);
     }
-    memset(new->digits, 0, x->allocated * sizeof(digit_tt));
 
-    if (x->length != 0) {
-        memcpy(new->digits, x->digits, x->length * sizeof(digit_tt));
+    pthread_mutex_unlock(&pool.configure);
+
+    if (error) {
+        errno = error;
+        return -1;
     }
 
-    return new;
+    return 0;
 }
 
 /**
- * Return a value indicating whether the argument equals zero.
+ * Get the counters of the calling thread. Counters are only kept when the
+ * library is built with COLLECT_STATS; otherwise the instrumentation compiles
+ * to nothing. Operations count every call including calls made by other
+ * library functions, so "bigint_mod" also counts a division. Work done by the
+ * helper threads of "bigint_strntobiv" and "bigint_snbprintv" is added to the
+ * thread that called them.
  *
  * Arguments:
- * - x: Big integer.
+ * - snapshot: Output pointer for a copy of the counters.
  *
- * Return: 0 if the value equals zero, and a non-zero value otherwise.
+ * Return: 0 if the operation succeeds and -1 with "errno" set to `ENOTSUP` if
+ * the library was built without COLLECT_STATS.
  */
-bool bigint_eqz(const bigint_st *x)
+int bigint_stats_get(bigint_stats_st *snapshot)
 {
-    return x->length == 0;
+#ifdef COLLECT_STATS
+    *snapshot = stats;
+    return 0;
+#else
+    (void) snapshot;
+    errno = ENOTSUP;
+    return -1;
+#endif
 }
 
 /**
- * Return a value indicating whether the argument is not equal zero.
+ * Set every counter of the calling thread to 0. This does nothing unless the
+ * library is built with COLLECT_STATS.
+ */
+void bigint_stats_reset(void)
+{
+#ifdef COLLECT_STATS
+    memset(&stats, 0, sizeof(stats));
+#endif
+}
+
+/**
+ * Set a function that is called when an operation on the calling thread is
+ * large or slow. The traced operations are "bigint_mul", "bigint_div",
+ * "bigint_mod", "bigint_pow", "bigint_gcd", "bigint_logui", parsing as
+ * "strtobi", and printing a single value as "tostr". The hook is called after
+ * the operation returns with its name, the sizes of its operands and result,
+ * and its duration. An operation that uses other traced operations, such as
+ * "bigint_pow", is reported once under its own name. Operations called by
+ * the hook are not reported.
  *
  * Arguments:
- * - x: Big integer.
- *
- * Return: 0 if the value equals zero, and a non-zero value otherwise.
+ * - hook: The function to call or NULL to disable tracing.
+ * - context: Value passed to the hook.
+ * - min_digits: The hook is called when the operands together or the result
+ *   have at least this many digits. The value 0 disables this condition.
+ * - min_seconds: The hook is called when the operation takes at least this
+ *   many seconds. The value 0 disables this condition.
  */
-bool bigint_nez(const bigint_st *x)
+void bigint_set_trace(
+    bigint_trace_ft hook, void *context, size_t min_digits, double min_seconds
+)
 {
-    return x->length != 0;
+    tracer.hook = hook;
+    tracer.context = context;
+    tracer.min_digits = min_digits;
+    tracer.min_seconds = min_seconds;
 }
 
 /**
- * Return a value indicating whether the argument is less than zero.
+ * Characters used to write numerals in order of their values. Bases up to 36
+ * only use lowercase letters, and larger bases use uppercase letters for the
+ * values that follow "z".
+ */
+static const char numeral_characters[NUMERAL_BASE_MAX + 1] =
+    "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+/**
+ * Get the value of a numeral.
  *
  * Arguments:
- * - x: Big integer.
+ * - c: A character.
+ * - base: The base of the numeral. For bases up to 36, letters are
+ *   case-insensitive and represent values starting at 10. For larger bases,
+ *   lowercase letters represent values starting at 10 and uppercase letters
+ *   represent values starting at 36.
  *
- * Return: A boolean value indicating whether the condition is true.
+ * Return: The value of the numeral or `UCHAR_MAX` if the character is not a
+ * numeral.
  */
-bool bigint_ltz(const bigint_st *x)
+static unsigned char numeral_value(char c, unsigned char base)
 {
-    return x->negative;
+    if (c >= '0' && c <= '9') {
+        return (unsigned char) (c - '0');
+    } else if (c >= 'a' && c <= 'z') {
+        return (unsigned char) (c - 'a' + 10);
+    } else if (c >= 'A' && c <= 'Z') {
+        return (unsigned char) (c - 'A' + (base > 36 ? 36 : 10));
+    }
+
+    return UCHAR_MAX;
 }
 
 /**
- * Return a value indicating whether the argument is less than or equal to
- * zero.
+ * Get the largest power of a base that fits in a single digit.
  *
  * Arguments:
- * - x: Big integer.
+ * - base: A base no larger than `NUMERAL_BASE_MAX`.
+ * - scale: Output pointer for the power.
  *
- * Return: A boolean value indicating whether the condition is true.
+ * Return: The exponent of the power which is the number of numerals that fit
+ * in a single digit.
  */
-bool bigint_lez(const bigint_st *x)
+static size_t numerals_per_digit(unsigned char base, digit_tt *scale)
 {
-    return x->length == 0 || x->negative;
+    size_t count = 1;
+
+    for (*scale = base; *scale <= DIGIT_MAX / base; count++) {
+        *scale = (digit_tt) (*scale * base);
+    }
+
+    return count;
 }
 
 /**
- * Return a value indicating whether the argument is greater than zero.
+ * Choose where to split a run of numerals for divide-and-conquer conversion.
+ * The split is always a power of two multiple of the number of numerals per
+ * digit, so the same few powers of the base are reused at every level of
+ * recursion and across conversions via the power cache.
  *
  * Arguments:
- * - x: Big integer.
+ * - count: Total number of numerals.
+ * - chunk: Number of numerals per digit.
  *
- * Return: A boolean value indicating whether the condition is true.
+ * Return: The number of least significant numerals to split off. This is more
+ * than a quarter and no more than a half of the total.
  */
-bool bigint_gtz(const bigint_st *x)
+static size_t numerals_split(size_t count, size_t chunk)
 {
-    return !x->negative && x->length;
+    size_t split = chunk;
+
+    while (split <= count / 4) {
+        split *= 2;
+    }
+
+    return split;
 }
 
 /**
- * Return a value indicating whether the argument is greater than or equal to
- * zero.
+ * Release the powers held by a conversion.
  *
  * Arguments:
- * - x: Big integer.
+ * - conversion: The conversion.
+ */
+static void conversion_free(conversion_st *conversion)
+{
+    for (size_t i = 0; i < conversion->levels; i++) {
+        power_cache_release(conversion->powers[i]);
+    }
+
+    xfree(conversion->powers);
+}
+
+/**
+ * Set up a divide-and-conquer conversion. When the pool has workers and the
+ * numerals pass the "convert_parallel" threshold, every power of the base the
+ * conversion may split by is computed up front, so the threads that share
+ * the work never compute the same power twice.
  *
- * Return: A boolean value indicating whether the condition is true.
+ * Arguments:
+ * - conversion: The conversion.
+ * - base: The base of the numerals.
+ * - numerals: The number of numerals being converted.
+ *
+ * Return: 0 if the operation succeeds and -1 if it fails.
  */
-bool bigint_gez(const bigint_st *x)
+static int conversion_init(
+    conversion_st *conversion, unsigned char base, size_t numerals
+)
 {
-    return !x->negative;
+    digit_tt scale;
+    size_t split;
+
+    size_t per_digit = numerals_per_digit(base, &scale);
+
+    *conversion = (conversion_st) {base, per_digit, NULL, 0};
+
+    if (
+        !atomic_load(&pool.count) ||
+        CEIL_DIV(numerals, per_digit) <= threshold(THRESHOLD_CONVERT_PARALLEL)
+    ) {
+        return 0;
+    }
+
+    split = numerals_split(numerals, per_digit);
+
+    for (size_t power = per_digit; power <= split; power *= 2) {
+        conversion->levels++;
+    }
+
+    if (!(conversion->powers = safe_calloc(
+        conversion->levels, sizeof(*conversion->powers)
+    ))) {
+        return -1;
+    }
+
+    // Each power is the square of the previous one, which the cache finds
+    // and squares instead of computing the power from scratch.
+    for (size_t i = 0; i < conversion->levels; i++) {
+        if (!(conversion->powers[i] = power_cache_get(base, per_digit << i))) {
+            conversion->levels = i;
+            conversion_free(conversion);
+            return -1;
+        }
+    }
+
+    return 0;
 }
 
 /**
- * Return the least of two big integers.
+ * Get the power of the base a conversion splits by.
  *
  * Arguments:
- * - a: A big integer.
- * - b: A big integer.
+ * - conversion: The conversion.
+ * - split: The number of numerals split off, which is the exponent.
  *
- * Return: The smaller of the two values.
+ * Return: The power or NULL if it could not be computed. It must be passed to
+ * "conversion_release" once it is no longer needed.
  */
-bigint_st *bigint_min(bigint_st *a, bigint_st *b)
+static bigint_st *conversion_power(
+    const conversion_st *conversion, size_t split
+)
 {
-    return bigint_cmp(a, b) <= 0 ? a : b;
+    for (size_t i = 0; i < conversion->levels; i++) {
+        if (conversion->per_digit << i == split) {
+            return conversion->powers[i];
+        }
+    }
+
+    return power_cache_get(conversion->base, split);
 }
 
 /**
- * Return the greatest of two big integers.
+ * Release a power returned by "conversion_power".
  *
  * Arguments:
- * - a: A big integer.
- * - b: A big integer.
- *
- * Return: The larger of the two values.
+ * - conversion: The conversion.
+ * - power: The power.
  */
-bigint_st *bigint_max(bigint_st *a, bigint_st *b)
+static void conversion_release(
+    const conversion_st *conversion, bigint_st *power
+)
 {
-    return bigint_cmp(a, b) >= 0 ? a : b;
+    for (size_t i = 0; i < conversion->levels; i++) {
+        if (conversion->powers[i] == power) {
+            return;
+        }
+    }
+
+    power_cache_release(power);
 }
 
 /**
- * Assign the value of one big integer to another.
+ * Multiply the magnitude of a big integer by a digit and add another digit to
+ * the product.
  *
  * Arguments:
- * - dest: Destination value.
- * - src: Source value.
+ * - x: A big integer.
+ * - multiplier: Multiplicand.
+ * - addend: Addend.
  *
  * Return: 0 if the operation succeeds and -1 if it fails.
  */
-int bigint_mov(bigint_st *dest, bigint_st *src)
+static int magnitude_muladd_digit(
+    bigint_st *x, digit_tt multiplier, digit_tt addend
+)
 {
-    if (dest == src) {
-        return 0;
+#ifdef DIGIT_SUPER_TYPE
+    digit_super_tt product;
+
+    digit_super_tt carry = addend;
+
+    for (size_t i = 0; i < x->length; i++) {
+        product = (digit_super_tt) x->digits[i] * multiplier + carry;
+        x->digits[i] = (digit_tt) (DIGIT_MAX & product);
+        carry = product >> DIGIT_BITS;
     }
+#else
+    digit_tt product;
 
-    if (src->length > dest->allocated && resize(dest, src->length)) {
-        return -1;
+    digit_tt carry = addend;
+
+    for (size_t i = 0; i < x->length; i++) {
+        u128fma64(&carry, &product, x->digits[i], multiplier, carry);
+        x->digits[i] = product;
+    }
+#endif
+
+    if (carry != 0) {
+        if (resize_sum(x, x->length, 1)) {
+            return -1;
+        }
+
+        x->digits[x->length - 1] = (digit_tt) carry;
     }
 
-    memcpy(dest->digits, src->digits, src->length * sizeof(digit_tt));
-    dest->length = src->length;
     return 0;
 }
 
+static int append_numerals(
+    bigint_st *x,
+    const char *numerals,
+    size_t count,
+    const conversion_st *conversion
+);
+
 /**
- * Assign the value of a standard integer to an existing big integer.
+ * Parse the least significant part of a run of numerals on a thread of the
+ * pool.
  *
  * Arguments:
- * - dest: Destination value.
- * - src: Source value.
+ * - arg: The job.
  */
-void bigint_movi(bigint_st *dest, intmax_t src)
+static void parse_job_run(void *arg)
 {
-    uintmax_t magnitude;
-    size_t offset;
+    parse_job_st *job = arg;
 
-    dest->negative = src < 0;
+    task_state_swap(&job->state);
 
-    if (src == 0) {
-        dest->length = 0;
-        return;
+    if ((job->result = append_numerals(
+        job->x, job->numerals, job->count, job->conversion
+    ))) {
+        job->state.error = errno;
     }
 
-    if (src > 0) {
-        magnitude = (uintmax_t) src;
-    } else {
-#if (INTMAX_MIN + INTMAX_MAX) >= 0
-        magnitude = (uintmax_t) -src;
-#else
-        if (src == INTMAX_MIN) {
-            magnitude = INTMAX_MIN_MAGNITUDE;
-        } else {
-            magnitude = (uintmax_t) -src;
+    task_state_swap(&job->state);
+}
+
+/**
+ * Implementation of "magnitude_append_numerals" for one level of a
+ * conversion.
+ */
+static int append_numerals(
+    bigint_st *x,
+    const char *numerals,
+    size_t count,
+    const conversion_st *conversion
+)
+{
+    digit_tt chunk;
+    int failed;
+    parse_job_st job;
+    bigint_st *low;
+    bigint_st *power;
+    digit_tt scale;
+    size_t split;
+    pool_task_st task;
+
+    unsigned char base = conversion->base;
+    size_t digits = CEIL_DIV(count, conversion->per_digit);
+    bool forked = false;
+    int result = -1;
+
+    if (digits <= threshold(THRESHOLD_PARSE_DC)) {
+        for (size_t i = 0; i < count; ) {
+            chunk = 0;
+            scale = 1;
+
+            for (; i < count && scale <= DIGIT_MAX / base; i++) {
+                chunk = chunk * base + numeral_value(numerals[i], base);
+                scale *= base;
+            }
+
+            if (magnitude_muladd_digit(x, scale, chunk)) {
+                return -1;
+            }
         }
-#endif
+
+        return 0;
     }
 
-    if (DIGIT_BITS >= sizeof(magnitude) * CHAR_BIT) {
-        dest->length = 1;
-        dest->digits[0] = (digit_tt) magnitude;
-    } else {
-        offset = 0;
+    split = numerals_split(count, conversion->per_digit);
 
-        while (magnitude != 0) {
-            dest->digits[offset++] = magnitude & DIGIT_MAX;
-            magnitude >>= DIGIT_BITS;
+    if (!(low = bigint_from_int(0))) {
+        return -1;
+    }
+
+    // The least significant numerals are parsed into a value of their own,
+    // so they can be handed to another thread while this one parses the
+    // rest.
+    if (
+        conversion->powers &&
+        digits > threshold(THRESHOLD_CONVERT_PARALLEL)
+    ) {
+        job = (parse_job_st) {
+            low, numerals + count - split, split, conversion,
+            task_state_fork(), 0
+        };
+        pool_fork(&task, parse_job_run, &job);
+        forked = true;
+    } else if (append_numerals(
+        low, numerals + count - split, split, conversion
+    )) {
+        goto error;
+    }
+
+    failed = append_numerals(x, numerals, count - split, conversion);
+
+    if (forked) {
+        pool_join(&task);
+        task_state_merge(&job.state);
+
+        if (job.result && !failed) {
+            errno = job.state.error;
+            failed = -1;
         }
+    }
 
-        dest->length = offset;
+    if (failed) {
+        goto error;
+    }
+
+    if (bigint_eqz(x)) {
+        result = bigint_mov(x, low);
+    } else if ((power = conversion_power(conversion, split))) {
+        if (bigint_mul(x, x, power) && magnitude_sum(x, x, low)) {
+            result = 0;
+        }
+
+        conversion_release(conversion, power);
     }
+
+error:
+    bigint_free(low);
+    return result;
 }
 
 /**
- * Assign the value of an unsigned integer to an existing big integer.
+ * Append numerals to the magnitude of a big integer. Rather than multiplying
+ * the whole number once per numeral, the numerals are grouped into chunks
+ * holding the most numerals that fit in a single digit, so the number is
+ * only traversed once per chunk. Long runs of numerals are split in two, and
+ * the halves are combined with a power of the base from the power cache.
+ * When the pool has workers, the two halves of long runs are parsed by
+ * different threads.
  *
  * Arguments:
- * - dest: Destination value.
- * - src: Source value.
+ * - x: A big integer.
+ * - numerals: Numerals to append. These must have already been validated.
+ * - count: Number of numerals.
+ * - base: Base of the numerals.
+ *
+ * Return: 0 if the operation succeeds and -1 if it fails.
  */
-void bigint_movui(bigint_st *dest, uintmax_t src)
+static int magnitude_append_numerals(
+    bigint_st *x, const char *numerals, size_t count, unsigned char base
+)
 {
-    size_t offset;
-
-    dest->negative = false;
-
-    if (src == 0) {
-        dest->length = 0;
-    } else if (DIGIT_BITS >= sizeof(src) * CHAR_BIT) {
-        dest->length = 1;
-        dest->digits[0] = (digit_tt) src;
-    } else {
-        offset = 0;
-
-        while (src != 0) {
-            dest->digits[offset++] = src & DIGIT_MAX;
-            src >>= DIGIT_BITS;
-        }
+    conversion_st conversion;
+    int result;
 
-        dest->length = offset;
+    if (conversion_init(&conversion, base, count)) {
+        return -1;
     }
+
+    result = append_numerals(x, numerals, count, &conversion);
+    conversion_free(&conversion);
+    return result;
 }
 
 /**
- * Create a big integer from a standard unsigned integer.
+ * Get the base indicated by the character following the leading "0" of a
+ * number's prefix.
  *
  * Arguments:
- * - value: Value of integer.
+ * - c: A character.
  *
- * Return: A pointer to a big integer if the instantiation succeeds and `NULL`
- * otherwise.
+ * Return: 2 for "b", 8 for "o" and 16 for "x" in either case, or 0 if the
+ * character does not indicate a base.
  */
-bigint_st *bigint_from_uint(uintmax_t value)
+static unsigned char prefix_base(char c)
 {
-    bigint_st *x;
+    switch (c | 32) {
+      case 'b':
+        return 2;
 
-    x = malloc(sizeof(bigint_st));
-
-    if (!x) {
-        return NULL;
-    }
-
-    // The minimum allocation is enough to for two intmax_t reducing the
-    // likelihood of reallocations when working with smaller values.
-    x->allocated = 2 * DIGITS_FOR_INTMAX;
-    x->digits = safe_calloc(x->allocated, sizeof(digit_tt));
+      case 'o':
+        return 8;
 
-    if (!x->digits) {
-        xfree(x);
-        return NULL;
+      case 'x':
+        return 16;
     }
 
-    bigint_movui(x, value);
-    return x;
+    return 0;
 }
 
 /**
- * Create a big integer from a standard integer.
- *
- * Arguments:
- * - value: Value of integer.
- *
- * Return: A pointer to a big integer if the instantiation succeeds and `NULL`
- * otherwise.
+ * Implementation of "strntobi_base" without tracing.
  */
-bigint_st *bigint_from_int(intmax_t value)
+static bigint_st *strntobi_untraced(
+    const char *str,
+    size_t len,
+    const char **end,
+    const char **fraction,
+    unsigned char base
+)
 {
-    bigint_st *x;
+    size_t fraction_end;
+    size_t fraction_length;
+    size_t fraction_start;
+    size_t fraction_used;
+    size_t integer_end;
+    size_t numerals;
+    bigint_st *power;
+    unsigned char prefix;
+    bigint_st *product;
+    bigint_st *result;
+    unsigned char value;
+
+    bool decimal = false;
+    uintmax_t exponent = 0;
+    size_t i = 0;
+    bool negative = false;
+    bool octal = false;
+    bool scientific = false;
 
-    x = malloc(sizeof(bigint_st));
+    STATS_ADD(strtobi.calls, 1);
 
-    if (!x) {
+    if (end) {
+        *end = str;
+    }
+
+    if (len && (*str == '+' || *str == '-')) {
+        negative = str[i++] == '-';
+    }
+
+    // A prefix is only treated as such when a numeral follows it, so "0x"
+    // on its own is the number 0 followed by an "x".
+    if (
+        len - i > 2 && str[i] == '0' &&
+        (prefix = prefix_base(str[i + 1])) && (!base || base == prefix) &&
+        numeral_value(str[i + 2], prefix) < prefix
+    ) {
+        base = prefix;
+        i += 2;
+    } else if (!base) {
+        // Without a prefix, a leading zero indicates an octal number unless
+        // a decimal point or an exponent shows that it is decimal.
+        octal = i < len && str[i] == '0';
+        base = 10;
+    }
+
+    for (numerals = i; i < len && numeral_value(str[i], base) < base; i++);
+
+    integer_end = i;
+    fraction_start = i;
+
+    if (base == 10 && i < len && str[i] == '.') {
+        decimal = true;
+
+        for (fraction_start = ++i; i < len; i++) {
+            if (numeral_value(str[i], 10) >= 10) {
+                break;
+            }
+        }
+    }
+
+    fraction_end = i;
+
+    if (integer_end == numerals && fraction_end == fraction_start) {
+        errno = EINVAL;
         return NULL;
     }
 
-    // The minimum allocation is enough to for two intmax_t reducing the
-    // likelihood of reallocations when working with smaller values.
-    x->allocated = 2 * DIGITS_FOR_INTMAX;
-    x->digits = safe_calloc(x->allocated, sizeof(digit_tt));
+    if (
+        base == 10 && len - i > 1 && (str[i] | 32) == 'e' &&
+        numeral_value(str[i + 1], 10) < 10
+    ) {
+        scientific = true;
 
-    if (!x->digits) {
-        xfree(x);
+        for (i++; i < len && (value = numeral_value(str[i], 10)) < 10; i++) {
+            if (exponent > (UINTMAX_MAX - value) / 10) {
+                errno = ERANGE;
+                return NULL;
+            }
+
+            exponent = exponent * 10 + value;
+        }
+    }
+
+    if (octal && !decimal && !scientific) {
+        base = 8;
+
+        for (i = numerals; i < integer_end && str[i] < '8'; i++);
+
+        integer_end = fraction_start = fraction_end = i;
+    }
+
+    if (!end && i < len && str[i]) {
+        errno = EINVAL;
         return NULL;
     }
 
-    bigint_movi(x, value);
-    return x;
+    // Fractional digits are consumed for as long as the exponent allows, and
+    // every digit consumed lowers the exponent by one. Trailing zeroes never
+    // need to be consumed.
+    fraction_length = fraction_end - fraction_start;
+
+    while (fraction_length && str[fraction_end - 1] == '0') {
+        fraction_length--;
+        fraction_end--;
+    }
+
+    if (exponent < fraction_length) {
+        fraction_used = (size_t) exponent;
+    } else {
+        fraction_used = fraction_length;
+    }
+
+    exponent -= fraction_used;
+
+    if (!(result = bigint_from_int(0))) {
+        return NULL;
+    }
+
+    if (magnitude_append_numerals(
+        result, str + numerals, integer_end - numerals, base
+    )) {
+        goto error;
+    }
+
+    if (magnitude_append_numerals(
+        result, str + fraction_start, fraction_used, base
+    )) {
+        goto error;
+    }
+
+    if (fraction && fraction_used < fraction_length) {
+        *fraction = str + fraction_start + fraction_used;
+    }
+
+    normalize(result);
+
+    if (exponent && bigint_nez(result)) {
+        if (!(power = power_cache_get(10, exponent))) {
+            goto error;
+        }
+
+        product = bigint_mul(result, result, power);
+        power_cache_release(power);
+
+        if (!product) {
+            goto error;
+        }
+    }
+
+    if (bigint_nez(result)) {
+        result->negative = negative;
+    }
+
+    STATS_ADD(strtobi.digits, result->length);
+
+    if (end) {
+        *end = str + i;
+    }
+
+    return result;
+
+error:
+    bigint_free(result);
+    return NULL;
 }
 
 /**
- * Count the number of leading zeroes in the bits of the most significant digit
- * of a big integer.
+ * Convert the beginning of a buffer to a big integer in a given base. The
+ * buffer is scanned once, and no character is read past its length or past a
+ * NUL byte.
  *
  * Arguments:
- * - x: A big integer.
+ * - str: Text to convert to a big integer.
+ * - len: Maximum number of characters to read. NUL-terminated strings can use
+ *   `SIZE_MAX`.
+ * - end: Optional output pointer for the first character that is not part of
+ *   the number. When this is NULL, the number must span all of the text.
+ * - fraction: Optional output pointer that will be used to indicate where the
+ *   unused fractional value of a decimal input begins.
+ * - base: The base of the numerals, or 0 to detect the base from the prefix
+ *   of the numerals as described in "bigint_strtobif". When the base is 2, 8
+ *   or 16, the corresponding prefix is optional. Decimal points and exponents
+ *   are only recognized for base 10.
  *
- * Return: The number of leading zeroes.
- */
-static inline size_t clz(bigint_st *x)
-{
-    size_t result = 0;
-    digit_tt msd = x->digits[x->length - 1];
-    digit_tt mask = 1 << (DIGIT_BITS - 1);
-
-    while ((mask & msd) == 0) {
-        mask >>= 1;
-        result++;
-    }
+ * Return: A big integer if the parsing succeeds and `NULL` if it fails.
+ */
+static bigint_st *strntobi_base(
+    const char *str,
+    size_t len,
+    const char **end,
+    const char **fraction,
+    unsigned char base
+)
+{
+    bigint_st *result;
+    trace_span_st span;
 
+    trace_begin(&span, "strtobi", 0, 0);
+    result = strntobi_untraced(str, len, end, fraction, base);
+    trace_end(&span, result);
     return result;
 }
 
 /**
- * Count the number of trailing zeroes of a big integer.
+ * Convert a string to a big integer. This function supports hexadecimal
+ * indicated by the prefix "0x" and "0X"; octal octal by "0o", "0O" or simply
+ * "0"; and binary by "0b" and "0B". Otherwise, the string is parsed as a
+ * decimal value. Decimal parsing supports scientific notation with positive
+ * exponents like "1e100", "12E3" and "1.5e3". The digits of the coefficient
+ * are accumulated as a single integer and the exponent is applied with one
+ * multiplication at the end.
  *
  * Arguments:
- * - x: A big integer.
+ * - str: Text to convert to a big integer.
+ * - fraction: Optional output pointer that will be used to indicate where the
+ *   unused fractional value of the input begins. It ends at the first
+ *   non-decimal-digit character following this pointer. This is only set when
+ *   there are non-zero fractional digits that were not used.
  *
- * Return: The number of leading zeroes.
+ * Return: A big integer if the parsing succeeds and `NULL` if it fails.
+ * "errno" is set to `EINVAL` when the string is malformed and `ERANGE` when
+ * the exponent cannot be represented as a uintmax_t value.
  */
-static inline size_t ctz(bigint_st *x)
+bigint_st *bigint_strtobif(const char *str, const char **fraction)
 {
-    digit_tt digit;
-
-    size_t result = 0;
-
-    for (size_t n = 0; n < x->length; n++) {
-        digit = x->digits[n];
-
-        if (x->digits[n] == 0) {
-            result += DIGIT_BITS;
-        } else {
-            while ((digit & 1) == 0) {
-                result++;
-                digit >>= 1;
-            }
-
-            break;
-        }
-    }
+    return strntobi_base(str, SIZE_MAX, NULL, fraction, 0);
+}
 
-    return result;
+bigint_st *bigint_strtobi(const char *str)
+{
+    return bigint_strtobif(str, NULL);
 }
 
 /**
- * Reduce the length of the big integer to exclude any leading zeroes and
- * ensure the "negative" struct value is set to false if the value of the
- * integer is 0.
+ * Convert the number at the beginning of a buffer that does not need to be
+ * NUL-terminated to a big integer. Numbers are written the same way as they
+ * are for "bigint_strtobi", but parsing stops at the first character that
+ * cannot be part of the number instead of failing, and no more than "len"
+ * characters are ever read. This allows numbers to be parsed directly from
+ * memory-mapped files and I/O buffers without copying them.
  *
  * Arguments:
- * - x: Big integer.
+ * - str: Text to convert to a big integer.
+ * - len: The number of characters available.
+ * - end: Optional output pointer for the first character following the
+ *   number. If the parsing fails, this is set to "str".
+ *
+ * Return: A big integer if the parsing succeeds and `NULL` if it fails.
+ * "errno" is set to `EINVAL` when the text does not begin with a number and
+ * `ERANGE` when the exponent cannot be represented as a uintmax_t value.
  */
-static void normalize(bigint_st *x)
+bigint_st *bigint_strntobi(const char *str, size_t len, const char **end)
 {
-    while (x->length && !x->digits[x->length - 1]) {
-        x->length--;
-    }
+    const char *unused;
 
-    if (x->length == 0) {
-        x->negative = false;
-    }
+    return strntobi_base(str, len, end ? end : &unused, NULL, 0);
 }
 
 /**
- * Decrement the magnitude of a non-zero number by 1.
+ * Determine whether text consists only of decimal digits. The text is
+ * examined eight bytes at a time: the high nibble of every byte of a decimal
+ * digit is 3, and adding 6 to the byte does not change that, which does not
+ * hold for any other byte.
  *
  * Arguments:
- * - x: A non-zero big integer.
+ * - str: Text to examine.
+ * - len: Number of characters to examine.
  *
- * Return: 0 if the operation succeeds or a negative value otherwise.
+ * Return: True if every character is a decimal digit and false otherwise.
  */
-static int magnitude_dec(bigint_st *x)
+static bool is_decimal(const char *str, size_t len)
 {
-    x->digits[0]--;
+    uint64_t word;
 
-    if (x->digits[0] == DIGIT_MAX) {
-        for (size_t i = 1; i < x->length; i++) {
-            if (x->digits[i] != 0) {
-                x->digits[i]--;
-                break;
-            }
+    for (; len >= sizeof(word); str += sizeof(word), len -= sizeof(word)) {
+        memcpy(&word, str, sizeof(word));
 
-            x->digits[i] = DIGIT_MAX;
+        if ((
+            (word & UINT64_C(0xF0F0F0F0F0F0F0F0)) |
+            ((word + UINT64_C(0x0606060606060606)) >> 4 &
+                UINT64_C(0x0F0F0F0F0F0F0F0F))
+        ) != UINT64_C(0x3333333333333333)) {
+            return false;
         }
     }
 
-    normalize(x);
-    return 0;
+    for (; len; str++, len--) {
+        if (*str < '0' || *str > '9') {
+            return false;
+        }
+    }
+
+    return true;
 }
 
 /**
- * Increment the magnitude of a number by 1.
+ * Get the number of digits reserved in the slab of a batch for a value.
+ * Values that are written as plain decimal integers are parsed directly into
+ * the slab, and everything else is handled by the general-purpose parser.
  *
  * Arguments:
- * - x: A big integer.
+ * - field: Text of the value.
+ * - len: Length of the text.
  *
- * Return: 0 if the operation succeeds or a negative value otherwise.
+ * Return: The number of digits to reserve or 0 if the value is parsed
+ * separately.
  */
-static int magnitude_inc(bigint_st *x)
+static size_t batch_reservation(const char *field, size_t len)
 {
-    digit_tt sum;
-
-    digit_tt carry = 1;
-
-    for (size_t i = 0; i < x->length; i++) {
-        sum = x->digits[i] + carry;
-        carry = sum < x->digits[i];
-        x->digits[i] = sum & DIGIT_MAX;
+    if (len && (*field == '+' || *field == '-')) {
+        field++;
+        len--;
     }
 
-    if (carry != 0) {
-        if (resize_sum(x, x->length, 1)) {
-            return -1;
-        }
-
-        x->digits[x->length - 1] = carry;
+    // A leading zero indicates an octal number.
+    if (!len || (len > 1 && *field == '0') || len > SIZE_MAX / 10 ||
+        !is_decimal(field, len)) {
+        return 0;
     }
 
-    normalize(x);
-    return 0;
+    // Every decimal numeral needs less than 10/3 bits, and resizing requires
+    // an additional digit beyond the length of the value.
+    return CEIL_DIV(len * 10 / 3 + 1, DIGIT_BITS) + 1;
 }
 
 /**
- * Compare the magnitude value of two big integers to determine if the first
- * argument is greater than, equal to or less than the second argument.
+ * Scan a range of a batch for values and the number of digits they need.
  *
  * Arguments:
- * - a: A big integer.
- * - b: A big integer.
- *
- * Return: A positive number if "a" has a greater magnitude than "b", 0 if the
- * magnitude of "a" equals "b" and a negative number if the magnitude "a" is
- * less than "b".
+ * - range: The range to scan.
  */
-static int magnitude_cmp(const bigint_st *a, const bigint_st *b)
+static void batch_measure(batch_range_st *range)
 {
-    digit_tt a_digit;
-    digit_tt b_digit;
-
-    int cmp = 0;
+    const char *delimiter;
 
-    if (a->length != 0 && a->length == b->length) {
-        // We can't use memcmp here because the digits are stored with the
-        // least significant digit at index 0 and, for digits with a width of
-        // more than one character, due to differences in endianess on
-        // different architectures.
-        size_t index = a->length - 1;
+    for (const char *field = range->start; field < range->end; ) {
+        delimiter = memchr(
+            field, range->delimiter, (size_t) (range->end - field)
+        );
 
-        while (1) {
-            a_digit = a->digits[index];
-            b_digit = b->digits[index];
-            cmp = (a_digit > b_digit) - (a_digit < b_digit);
+        range->values++;
+        range->digits += batch_reservation(
+            field, (size_t) ((delimiter ? delimiter : range->end) - field)
+        );
 
-            if (cmp == 0 || index-- == 0) {
-                break;
-            }
+        if (!delimiter) {
+            break;
         }
-    } else {
-        cmp = (a->length > b->length) - (a->length < b->length);
-    }
 
-    return cmp;
+        field = delimiter + 1;
+    }
 }
 
 /**
- * Compute the difference in magnitude of two big integers.
- *
- * **WARNING:** The minuend must be greater than or equal the subtrahend or
- * this function will not work correctly.
+ * Parse the values in a range of a batch. The number of values parsed is
+ * stored in the range, and if the parsing fails, so is the error.
  *
  * Arguments:
- * - dest: Pointer to the output destination.
- * - m: Minuend.
- * - s: Subtrahend.
+ * - range: The range to parse.
  *
- * Return: A big integer containing the difference in the magnitudes.
+ * Return: Always NULL. This signature allows the function to be used as the
+ * start routine of a thread.
  */
-static bigint_st *magnitude_delta(bigint_st *dest, bigint_st *m, bigint_st *s)
+static void *batch_parse(void *arg)
 {
-    bool copied_minuend = false;
+    const char *delimiter;
+    size_t len;
+    bigint_st *parsed;
+    size_t reserved;
+    bigint_st *x;
 
-    // If either input is also the output, the length will be mutated, so we
-    // need to save the original values.
-    size_t m_length = m->length;
-    size_t s_length = s->length;
+    batch_range_st *range = arg;
+    digit_tt *slab = range->slab;
 
-    if (resize(dest, m->length)) {
-        return NULL;
-    }
+    task_state_swap(&range->state);
 
-    for (size_t i = 0; i < m_length; i++) {
-        if (i < s_length) {
-            // If the minuend's digit is less than the subtrahend's, borrow
-            // from the following digits of the minuend. The borrow logic
-            // mutates the minuend, so we first make a copy of the original
-            // minuend if the output pointer is not also the minuend.
-            //
-            // Note that we do not modify the subtrahend's digit. When doing
-            // this on paper with base 10, the subtrahend's digit would have 10
-            // added to it. In this library, that would be analogous to
-            // `DIGIT_MAX + 1`. However, unsigned integers use two's complement
-            // making adding `DIGIT_MAX + 1` a no-op.
-            if (m->digits[i] < s->digits[i]) {
-                if (m != dest && !copied_minuend) {
-                    if (!(m = bigint_dup(m))) {
-                        return NULL;
-                    }
+    for (const char *field = range->start; field < range->end; ) {
+        delimiter = memchr(
+            field, range->delimiter, (size_t) (range->end - field)
+        );
+        len = (size_t) ((delimiter ? delimiter : range->end) - field);
+        x = range->structs + range->parsed;
 
-                    copied_minuend = true;
-                }
+        if ((reserved = batch_reservation(field, len))) {
+            *x = (bigint_st) {slab, reserved, 0, false, true};
+            slab += reserved;
 
-                for (size_t j = i + 1; j < m_length; j++) {
-                    if (m->digits[j] != 0) {
-                        m->digits[j]--;
-                        break;
-                    }
+            if (*field == '+' || *field == '-') {
+                x->negative = *field == '-';
+                field++;
+                len--;
+            }
 
-                    m->digits[j] = DIGIT_MAX;
-                }
+            if (magnitude_append_numerals(x, field, len, 10)) {
+                // Digits that were moved out of the slab before the failure
+                // belong to the unfinished value.
+                digits_free(x);
+                goto error;
             }
 
-            dest->digits[i] = m->digits[i] - s->digits[i];
+            if (!x->length) {
+                x->negative = false;
+            }
+        } else if ((parsed = strntobi_base(field, len, NULL, NULL, 0))) {
+            *x = *parsed;
+            xfree(parsed);
         } else {
-            dest->digits[i] = m->digits[i];
+            goto error;
         }
-    }
 
-    if (copied_minuend) {
-        bigint_free(m);
+        range->output[range->parsed++] = x;
+
+        if (!delimiter) {
+            break;
+        }
+
+        field = delimiter + 1;
     }
 
-    normalize(dest);
-    return dest;
+    task_state_swap(&range->state);
+    return NULL;
+
+error:
+    range->state.error = errno;
+    task_state_swap(&range->state);
+    return NULL;
 }
 
 /**
- * Compute the sum of the magnitude of two big integers.
+ * Parse a buffer containing many numbers separated by a delimiter such as a
+ * newline. Each number is written the way "bigint_strtobi" expects, and a
+ * trailing delimiter at the end of the buffer is ignored. All of the values
+ * share a single allocation, and plain decimal integers are parsed into it
+ * directly, so there is no per-number allocation in the common case. The
+ * buffer does not need to be NUL-terminated.
  *
  * Arguments:
- * - dest: Pointer to the output destination.
- * - a: Addend.
- * - b: Addend.
+ * - count: Output pointer for the number of values parsed. If the parsing
+ *   fails, this is set to the index of the value that could not be parsed.
+ * - buf: The text to parse.
+ * - len: Length of the text.
+ * - delimiter: Character that separates the values.
+ * - threads: Maximum number of threads used to parse the values. The buffer
+ *   is split into ranges of whole values that are parsed concurrently. Small
+ *   buffers are always parsed by the calling thread.
  *
- * Return: A big integer containing the sums of the magnitudes.
+ * Return: A NULL-terminated array of big integers if the parsing succeeds and
+ * `NULL` if it fails. The values may be used with any other function, but
+ * they must not be freed individually: the array and every value in it are
+ * released together with "bigint_freev".
  */
-static bigint_st *magnitude_sum(bigint_st *dest, bigint_st *a, bigint_st *b)
+bigint_st **bigint_strntobiv(
+    size_t *count, const char *buf, size_t len, char delimiter, unsigned threads
+)
 {
-    digit_tt sum;
+    const char *boundary;
+    digit_tt *digit_base;
+    size_t digits;
+    bigint_st **output;
+    batch_range_st *ranges;
+    bigint_st *structs;
+    size_t values;
+    pthread_t *workers;
 
-    // We store these separately in case one of the inputs is the dest.
-    size_t a_length = a->length;
-    size_t b_length = b->length;
-    size_t max_length = a_length > b_length ? a_length : b_length;
+    const char *end = buf + len;
+    bool failed = false;
+    const char *start = buf;
 
-    bool carry = false;
+    STATS_ADD(strntobiv.calls, 1);
+    *count = 0;
 
-    if (bigint_eqz(a) && bigint_eqz(b)) {
-        bigint_movui(dest, 0);
-        goto done;
+    if (threads > len / BATCH_RANGE_MIN) {
+        threads = (unsigned) (len / BATCH_RANGE_MIN);
     }
 
-    if (resize(dest, max_length)) {
+    if (threads == 0) {
+        threads = 1;
+    }
+
+    if (!(ranges = safe_calloc(threads, sizeof(*ranges)))) {
         return NULL;
     }
 
-    for (size_t offset = 0; offset < max_length; offset++) {
-        if (offset >= a_length) {
-            sum = b->digits[offset] + carry;
-            carry = sum < b->digits[offset];
-        } else if (offset >= b_length) {
-            sum = a->digits[offset] + carry;
-            carry = sum < a->digits[offset];
+    // Split the buffer into ranges of roughly equal size that end just past a
+    // delimiter, so no value straddles two ranges.
+    values = 0;
+    digits = 0;
+
+    for (unsigned i = 0; i < threads; i++) {
+        if (i == threads - 1) {
+            boundary = end;
+        } else if ((boundary = buf + len / threads * (i + 1)) < start) {
+            boundary = start;
         } else {
-            sum = a->digits[offset] + b->digits[offset] + carry;
-            carry = (sum - carry) < a->digits[offset];
+            boundary = memchr(boundary, delimiter, (size_t) (end - boundary));
+            boundary = boundary ? boundary + 1 : end;
         }
 
-        dest->digits[offset] = sum;
+        ranges[i] = (batch_range_st) {
+            start, boundary, delimiter, 0, 0, NULL, NULL, NULL, 0, false,
+            task_state_fork()
+        };
+        batch_measure(&ranges[i]);
+        values += ranges[i].values;
+        digits += ranges[i].digits;
+        start = boundary;
+    }
+
+    if (
+        values > SIZE_MAX / 2 / (sizeof(*output) + sizeof(*structs)) ||
+        digits > SIZE_MAX / 2 / sizeof(digit_tt)
+    ) {
+        errno = EOVERFLOW;
+        xfree(ranges);
+        return NULL;
+    }
+
+    STATS_ADD(strntobiv.digits, digits);
+
+    // The slab holds the array of pointers followed by the structures and
+    // then the digits, so each part is suitably aligned for the next.
+    if (!(output = safe_calloc(
+        1,
+        (values + 1) * sizeof(*output) + values * sizeof(*structs) +
+        digits * sizeof(digit_tt)
+    ))) {
+        xfree(ranges);
+        return NULL;
+    }
+
+    output[values] = NULL;
+    structs = (bigint_st *) (output + values + 1);
+    digit_base = (digit_tt *) (structs + values);
+    values = 0;
+    digits = 0;
+
+    for (unsigned i = 0; i < threads; i++) {
+        ranges[i].output = output + values;
+        ranges[i].structs = structs + values;
+        ranges[i].slab = digit_base + digits;
+        values += ranges[i].values;
+        digits += ranges[i].digits;
+    }
+
+    workers = threads > 1 ? safe_calloc(threads, sizeof(*workers)) : NULL;
+
+    // A range is parsed by the calling thread when a thread cannot be created
+    // for it. Either way, it runs with the memory accounting of the calling
+    // thread, so every range is subject to the same limit.
+    for (unsigned i = 1; i < threads; i++) {
+        ranges[i].threaded = workers && !pthread_create(
+            &workers[i], NULL, batch_parse, &ranges[i]
+        );
+
+        if (!ranges[i].threaded) {
+            batch_parse(&ranges[i]);
+            task_state_merge(&ranges[i].state);
+        }
+    }
+
+    batch_parse(&ranges[0]);
+    task_state_merge(&ranges[0].state);
+
+    for (unsigned i = 1; i < threads; i++) {
+        if (ranges[i].threaded) {
+            pthread_join(workers[i], NULL);
+            task_state_merge(&ranges[i].state);
+        }
+    }
+
+    xfree(workers);
+
+    for (unsigned i = 0; i < threads && !failed; i++) {
+        *count += ranges[i].parsed;
+
+        if (ranges[i].parsed < ranges[i].values) {
+            errno = ranges[i].state.error;
+            failed = true;
+        }
+    }
+
+    if (failed) {
+        for (unsigned i = 0; i < threads; i++) {
+            for (size_t j = 0; j < ranges[i].parsed; j++) {
+                digits_free(&ranges[i].structs[j]);
+            }
+        }
+
+        xfree(output);
+        output = NULL;
+    } else {
+        *count = values;
+    }
+
+    xfree(ranges);
+    return output;
+}
+
+/**
+ * Release an array of big integers created by "bigint_strntobiv". This
+ * function is guaranteed to preserve errno.
+ *
+ * Arguments:
+ * - values: A NULL-terminated array of big integers.
+ */
+void bigint_freev(bigint_st **values)
+{
+    for (bigint_st **x = values; *x; x++) {
+        digits_free(*x);
     }
 
-    if (carry != 0) {
-        if (resize_sum(dest, dest->length, 1)) {
-            return NULL;
-        }
+    xfree(values);
+}
 
-        dest->digits[max_length] = carry;
+/**
+ * Convert a string of numerals in any base from 2 to 62 to a big integer. The
+ * numerals are "0" to "9" followed by the letters of the alphabet. For bases
+ * up to 36, letters are case-insensitive, so "z" and "Z" both represent 35.
+ * For larger bases, lowercase letters represent 10 to 35 and uppercase
+ * letters represent 36 to 61. The numerals may be preceded by a sign, and in
+ * bases 2, 8 and 16, the prefixes "0b", "0o" and "0x" are accepted as well.
+ * When the base is 10, the string is parsed like it is by "bigint_strtobi".
+ *
+ * Arguments:
+ * - str: Text to convert to a big integer.
+ * - base: The base of the numerals or 0 to detect the base the same way
+ *   "bigint_strtobi" does.
+ *
+ * Return: A big integer if the parsing succeeds and `NULL` if it fails.
+ * "errno" is set to `EINVAL` when the base is not supported or the string is
+ * malformed.
+ */
+bigint_st *bigint_strtobib(const char *str, unsigned char base)
+{
+    if (base == 1 || base > NUMERAL_BASE_MAX) {
+        errno = EINVAL;
+        return NULL;
     }
 
-done:
-    normalize(dest);
-    return dest;
+    return strntobi_base(str, SIZE_MAX, NULL, NULL, base);
 }
 
+static size_t write_numerals(
+    char *buf,
+    size_t buflen,
+    bigint_st *x,
+    size_t width,
+    const conversion_st *conversion
+);
+
 /**
- * Clean up any resources created by "bigint_init". This function is one of two
- * in this library that is not thread safe with the other being "bigint_init".
+ * Write the numerals of the most significant part of a value on a thread of
+ * the pool.
+ *
+ * Arguments:
+ * - arg: The job.
  */
-void bigint_cleanup(void)
+static void print_job_run(void *arg)
 {
-    bigint_st *value;
+    print_job_st *job = arg;
 
-    if (init_done) {
-        for (size_t n = 0; n <= SMALL_NUMBER_CACHE_MAX; n++) {
-            value = small_number_cache[n];
+    task_state_swap(&job->state);
 
-            if (value) {
-                bigint_free(value);
-                small_number_cache[n] = NULL;
-            }
-        }
+    if ((job->written = write_numerals(
+        job->buf, job->buflen, job->x, job->width, job->conversion
+    )) == SIZE_MAX) {
+        job->state.error = errno;
     }
+
+    task_state_swap(&job->state);
 }
 
 /**
- * Initialize the state required by the library. This function is one of two in
- * this library that is not thread safe with the other being "bigint_cleanup".
- *
- * Return: 0 if the operation succeeds and a negative number if it fails. When
- * specified, the digit super type must be at least twice the width of the base
- * digit type. If this is not the case, this function will set "errno" to
- * `ENOTRECOVERABLE` when it fails.
+ * Implementation of "magnitude_write_numerals" for one level of a
+ * conversion.
  */
-int bigint_init(void)
+static size_t write_numerals(
+    char *buf,
+    size_t buflen,
+    bigint_st *x,
+    size_t width,
+    const conversion_st *conversion
+)
 {
-    bigint_st *value;
+    size_t bits;
+    digit_tt chunk;
+    size_t high;
+    print_job_st job;
+    bigint_st *power;
+    bigint_st *quotient;
+    digit_tt scale;
+    size_t split;
+    pool_task_st task;
+
+    unsigned char base = conversion->base;
+    size_t length = bit_length(x);
+    size_t per_digit = numerals_per_digit(base, &scale);
+    size_t written = 0;
 
-    if (init_done) {
-        return 0;
-    }
+    if (POWER_OF_2(base)) {
+        for (bits = 1; (1u << bits) < base; bits++);
 
-#ifdef DIGIT_SUPER_TYPE
-    if (sizeof(digit_super_tt) / sizeof(digit_tt) < 2) {
-        errno = ENOTRECOVERABLE;
-        return -1;
-    }
-#endif
+        for (size_t offset = 0; offset < length; offset += bits) {
+            if (written == buflen) {
+                goto range_error;
+            }
+
+            chunk = (digit_tt) magnitude_bits(x, offset, bits);
+            buf[written++] = numeral_characters[chunk];
+        }
+    } else if (x->length > threshold(THRESHOLD_PRINT_DC)) {
+        // The split is at most half of the numerals in the value, so the
+        // quotient is never 0.
+        split = numerals_split(
+            (size_t) ((double) length / log2(base)), per_digit
+        );
+
+        if (!(power = conversion_power(conversion, split))) {
+            return SIZE_MAX;
+        }
+
+        if (!(quotient = bigint_from_int(0))) {
+            conversion_release(conversion, power);
+            return SIZE_MAX;
+        }
 
-    for (uintmax_t n = 0; n <= SMALL_NUMBER_CACHE_MAX; n++) {
-        if (!(value = bigint_from_uint(n))) {
-            for (size_t k = 0; k < n; k++) {
-                bigint_free(small_number_cache[k]);
+        // The remainder replaces the value, and it is padded to the full
+        // length of the split because the quotient is written after it.
+        // Since the remainder always takes exactly that many numerals, the
+        // quotient can be written by another thread at the same time.
+        if (magnitude_divmod(quotient, x, NULL, x, power)) {
+            written = SIZE_MAX;
+        } else if (
+            conversion->powers &&
+            CEIL_DIV(length, DIGIT_BITS) >
+                threshold(THRESHOLD_CONVERT_PARALLEL) &&
+            split <= buflen
+        ) {
+            job = (print_job_st) {
+                buf + split,
+                buflen - split,
+                quotient,
+                width > split ? width - split : 0,
+                conversion,
+                task_state_fork(),
+                0
+            };
+            pool_fork(&task, print_job_run, &job);
+            written = write_numerals(buf, buflen, x, split, conversion);
+            pool_join(&task);
+            task_state_merge(&job.state);
+
+            if (written != SIZE_MAX && job.written == SIZE_MAX) {
+                errno = job.state.error;
+                written = SIZE_MAX;
+            } else if (written != SIZE_MAX) {
+                written += job.written;
             }
+        } else if ((written = write_numerals(
+            buf, buflen, x, split, conversion
+        )) != SIZE_MAX) {
+            high = write_numerals(
+                buf + written,
+                buflen - written,
+                quotient,
+                width > split ? width - split : 0,
+                conversion
+            );
+            written = high == SIZE_MAX ? SIZE_MAX : written + high;
+        }
 
-            return -1;
+        conversion_release(conversion, power);
+        bigint_free(quotient);
+        return written;
+    } else {
+        while (bigint_nez(x)) {
+            chunk = magnitude_divmod_digit(x, scale);
+
+            // Every chunk other than the most significant one is padded to
+            // the full number of numerals per digit.
+            for (size_t i = 0; i < per_digit; i++) {
+                if (!chunk && bigint_eqz(x)) {
+                    break;
+                } else if (written == buflen) {
+                    goto range_error;
+                }
+
+                buf[written++] = numeral_characters[chunk % base];
+                chunk /= base;
+            }
+        }
+    }
+
+    for (; written < width; written++) {
+        if (written == buflen) {
+            goto range_error;
         }
 
-        small_number_cache[n] = value;
+        buf[written] = '0';
     }
 
-    init_done = true;
-    return 0;
+    return written;
+
+range_error:
+    errno = ERANGE;
+    return SIZE_MAX;
 }
 
 /**
- * Convert a big integer to a standard unsigned integer. If the big integer
- * cannot be represented as an uintmax_t value, "errno" will be set to
- * `ERANGE`.
+ * Write the numerals of the magnitude of a big integer in reverse order,
+ * starting with the least significant numeral. When the base is a power of
+ * two, the numerals are read directly from the bits of the value. Otherwise
+ * the value is repeatedly divided by the largest power of the base that fits
+ * in a digit, yielding several numerals per division, and values longer than
+ * the "print_dc" threshold are first split in two by dividing them by
+ * a power of the base from the power cache. When the pool has workers, the
+ * two parts of long values are written by different threads.
  *
  * Arguments:
- * - x: Big integer.
+ * - buf: The destination buffer. No NUL byte is written.
+ * - buflen: The maximum number of numerals that can be written.
+ * - x: The big integer to write. Unless the base is a power of two, its value
+ *   is destroyed.
+ * - base: The base. This must be from 2 to `NUMERAL_BASE_MAX`.
+ * - width: Minimum number of numerals to write. Shorter values are padded
+ *   with leading zeroes.
  *
- * Return: A normal integer representing the value.
+ * Return: The number of numerals written if the operation succeeds and
+ * `SIZE_MAX` otherwise. If the buffer is too short, "errno" is set to
+ * `ERANGE`.
  */
-uintmax_t bigint_toui(bigint_st *x)
+static size_t magnitude_write_numerals(
+    char *buf, size_t buflen, bigint_st *x, unsigned char base, size_t width
+)
 {
-    uintmax_t accumulator = 0;
-    uintmax_t previous_accumulator = 0;
+    conversion_st conversion;
+    size_t written;
 
-    if (x->negative) {
-        errno = ERANGE;
-        return 0;
+    size_t numerals = 0;
+
+    // Values in bases that are powers of two are never split.
+    if (!POWER_OF_2(base)) {
+        numerals = (size_t) ((double) bit_length(x) / log2(base));
     }
 
-    if (x->length > DIGITS_FOR_INTMAX) {
-        errno = ERANGE;
-        return UINTMAX_MAX;
+    if (conversion_init(&conversion, base, numerals)) {
+        return SIZE_MAX;
     }
 
-    for (size_t n = 0; n < x->length; n++) {
-        if (!x->digits[n]) {
-            continue;
-        }
+    written = write_numerals(buf, buflen, x, width, &conversion);
+    conversion_free(&conversion);
+    return written;
+}
 
-        accumulator |= (uintmax_t) x->digits[n] << (n * DIGIT_BITS);
+/**
+ * Get the prefix written before the numerals of a number in a given base.
+ *
+ * Arguments:
+ * - base: The base.
+ *
+ * Return: "0b", "0o" or "0x" for bases 2, 8 and 16 respectively and NULL for
+ * every other base.
+ */
+static const char *numeral_prefix(unsigned char base)
+{
+    switch (base) {
+      case 2:
+        return "0b";
 
-        if (accumulator <= previous_accumulator) {
-            errno = ERANGE;
-            return UINTMAX_MAX;
-        }
+      case 8:
+        return "0o";
 
-        previous_accumulator = accumulator;
+      case 16:
+        return "0x";
     }
 
-    return accumulator;
+    return NULL;
 }
 
 /**
- * Convert a big integer to a standard integer. If the big integer cannot be
- * represented as an intmax_t value, "errno" will be set to `ERANGE`.
+ * Count the numerals needed to write the magnitude of a big integer. The
+ * count is derived from a logarithm computed from the leading bits of the
+ * value. Only when the value is so close to a power of the base that the
+ * rounding of the logarithm matters is it compared to that power.
  *
  * Arguments:
- * - x: Big integer.
+ * - x: A big integer.
+ * - base: The base. This must be from 2 to `NUMERAL_BASE_MAX`.
  *
- * Return: A normal integer representing the value.
+ * Return: The exact number of numerals, which is 1 for the value 0, or 0 if
+ * the power needed for the comparison could not be computed.
  */
-intmax_t bigint_toi(bigint_st *x)
+static size_t magnitude_numerals(bigint_st *x, unsigned char base)
 {
-    uintmax_t accumulator = 0;
-    uintmax_t value = 0;
+    size_t bits_per_numeral;
+    double estimate;
+    double fraction;
+    double margin;
+    size_t nearest;
+    size_t numerals;
+    bigint_st *power;
+    size_t shift;
+    uint64_t value;
+
+    size_t bits = bit_length(x);
+
+    if (bits == 0) {
+        return 1;
+    } else if (POWER_OF_2(base)) {
+        for (bits_per_numeral = 1; (1u << bits_per_numeral) < base; ) {
+            bits_per_numeral++;
+        }
 
-    for (size_t n = 0; n < x->length; n++) {
-        value = (uintmax_t) x->digits[n] << (n * DIGIT_BITS);
+        return CEIL_DIV(bits, bits_per_numeral);
+    } else if (bits <= 64) {
+        value = magnitude_bits(x, 0, bits);
 
-        if (x->digits[n] != 0 && !value) {
-            errno = ERANGE;
-            return x->negative ? INTMAX_MIN : INTMAX_MAX;
+        for (numerals = 1; value >= base; numerals++) {
+            value /= base;
         }
 
-        accumulator |= value;
+        return numerals;
     }
 
-    if (!x->negative) {
-        if (accumulator > (uintmax_t) INTMAX_MAX) {
-            errno = ERANGE;
-            return INTMAX_MAX;
+    estimate = (log2(magnitude_tod(&shift, x)) + (double) shift) / log2(base);
+    numerals = (size_t) estimate + 1;
+    fraction = estimate - floor(estimate);
+
+    // The error of the estimate grows with its magnitude, but it is always
+    // far smaller than this margin.
+    margin = 1e-12 * (estimate + 1);
+
+    if (fraction < margin || 1 - fraction < margin) {
+        nearest = (size_t) (estimate + 0.5);
+
+        if (!(power = power_cache_get(base, nearest))) {
+            return 0;
         }
 
-        return (intmax_t) accumulator;
+        numerals = magnitude_cmp(x, power) < 0 ? nearest : nearest + 1;
+        power_cache_release(power);
     }
 
-    if (accumulator > INTMAX_MIN_MAGNITUDE) {
-        errno = ERANGE;
-        return INTMAX_MIN;
-    }
+    return numerals;
+}
 
-#if (INTMAX_MIN + INTMAX_MAX) >= 0
-    return -((intmax_t) accumulator);
-#else
-    if (accumulator <= INTMAX_MAX) {
-        return -((intmax_t) accumulator);
-    } else {
-        // This works even if signed integers don't use two's complement.
-        return -INTMAX_MAX - (intmax_t) (accumulator - INTMAX_MAX);
+/**
+ * Get the length of the representation of a big integer written by
+ * "bigint_snbprint" excluding the terminating NUL byte.
+ *
+ * Arguments:
+ * - x: A big integer.
+ * - base: The base. This must be from 2 to `NUMERAL_BASE_MAX`.
+ *
+ * Return: The length or 0 if it could not be determined.
+ */
+static size_t formatted_length(bigint_st *x, unsigned char base)
+{
+    size_t numerals = magnitude_numerals(x, base);
+
+    if (!numerals) {
+        return 0;
     }
-#endif
+
+    return x->negative + (numeral_prefix(base) ? 2 : 0) + numerals;
 }
 
 /**
- * Convert a big integer to a double. If the big integer cannot be represented
- * as a double, generally because the exponent is too large, "errno" will be
- * set to `EOVERFLOW` and a value representing infinity is returned. The
- * resulting value will be a truncated representation of the integer if it
- * exceeds the precision of the double's mantissa.
+ * Write the representation of a big integer whose length is already known.
+ * No NUL byte is written.
  *
  * Arguments:
- * - x: Big integer.
+ * - buf: The destination buffer.
+ * - length: The length returned by "formatted_length".
+ * - x: The big integer to write.
+ * - base: The base. This must be from 2 to `NUMERAL_BASE_MAX`.
+ * - scratch: Pointer to a big integer that holds a copy of the value while it
+ *   is being written. If it points to NULL, the big integer is allocated, and
+ *   it can be reused for other values until the caller frees it.
  *
- * Return: A double representing the value.
+ * Return: 0 if the operation succeeds and -1 if it fails.
  */
-double bigint_tod(bigint_st *x)
+static int format_known_length(
+    char *buf,
+    size_t length,
+    bigint_st *x,
+    unsigned char base,
+    bigint_st **scratch
+)
 {
-    intmax_t intval;
-    uintmax_t uintval;
-    double coefficient;
-    uintmax_t exponent;
-    double inf;
-    size_t leading_zeroes;
-    uintmax_t mantissa;
+    size_t numerals;
+    bigint_st *source;
 
-#ifdef DIGIT_SUPER_TYPE
-    int from;
-    digit_tt lsb;
-    digit_tt msb;
-#endif
+    const char *prefix = numeral_prefix(base);
 
-    if (bigint_eqz(x)) {
-        return 0.0;
+    if (x->negative) {
+        *buf++ = '-';
+        length--;
     }
 
-    errno = 0;
-
-    if (bigint_ltz(x)) {
-        intval = bigint_toi(x);
+    if (prefix) {
+        memcpy(buf, prefix, 2);
+        buf += 2;
+        length -= 2;
+    }
 
-        if (errno == 0) {
-            return (double) intval;
+    if (POWER_OF_2(base)) {
+        source = x;
+    } else if (*scratch) {
+        if (bigint_mov(*scratch, x)) {
+            return -1;
         }
-    } else {
-        uintval = bigint_toui(x);
 
-        if (errno == 0) {
-            return (double) uintval;
-        }
+        source = *scratch;
+    } else if (!(source = *scratch = bigint_dup(x))) {
+        return -1;
     }
 
-    // The exponent is the number of bits that will be truncated from the least
-    // significant digits of the big integer.
-    // TODO: handle multiplication overflow
-    leading_zeroes = clz(x);
-    exponent = (uintmax_t) (
-        (x->length - DIGITS_FOR_INTMAX) * DIGIT_BITS - leading_zeroes
-    );
+    // The space available and the minimum width are both the number of
+    // numerals, so anything other than an exact fit fails.
+    numerals = magnitude_write_numerals(buf, length, source, base, length);
 
-    if (exponent > DBL_MAX_EXP - 1) {
-        inf = strtod(x->negative ? "-inf" : "inf", NULL);
-        errno = EOVERFLOW;
-        return inf;
-    } else {
-        coefficient = pow(2.0, (double) exponent);
+    if (numerals == SIZE_MAX) {
+        return -1;
     }
 
-    // Generate a uintmax_t by performing a left shift, if needed, so the first
-    // non-zero bit of the big integer becomes the most significant bit of the
-    // uintmax_t. After that, the mantissa is generated doing something akin to
-    // "*((uintmax_t *) reversed(x->digits))".
-    mantissa = 0;
-
-// TODO: are both branches needed?
-#ifdef DIGIT_SUPER_TYPE
-    if (leading_zeroes) {
-        for (size_t i = 0; i < DIGITS_FOR_INTMAX + 1; i++) {
-            from = (int) (x->length - i);
-            msb = x->digits[from - 1];
-            lsb = from >= (int) x->length ? 0 : x->digits[from];
-            mantissa <<= DIGIT_BITS;
-            mantissa |= DIGIT_MAX & (
-                lsb << leading_zeroes | msb >> (DIGIT_BITS - leading_zeroes)
-            );
-        }
-    } else {
-        for (size_t i = 0; i < DIGITS_FOR_INTMAX; i++) {
-            mantissa <<= DIGIT_BITS;
-            mantissa |= x->digits[x->length - i - 1];
-        }
+    for (size_t a = 0, b = numerals - 1; a < b; a++, b--) {
+        char temp = buf[a];
+        buf[a] = buf[b];
+        buf[b] = temp;
     }
-#else
-    if (x->length == 1) {
-        mantissa = x->digits[x->length - 1] << leading_zeroes;
-    } else {
-        mantissa = (
-            x->digits[x->length - 1] << leading_zeroes |
-            x->digits[x->length - 2] >> (DIGIT_BITS - leading_zeroes)
-        );
+
+    return 0;
+}
+
+/**
+ * Get the exact number of characters "bigint_snbprint" writes for a big
+ * integer excluding the terminating NUL byte. This includes the sign and
+ * the prefix of binary, octal and hexadecimal values.
+ *
+ * Arguments:
+ * - x: A big integer.
+ * - base: The base from 2 to 62.
+ *
+ * Return: The number of characters if the operation succeeds and 0 if it
+ * fails.
+ */
+size_t bigint_sizeinbase(bigint_st *x, unsigned char base)
+{
+    if (base < 2 || base > NUMERAL_BASE_MAX) {
+        errno = EINVAL;
+        return 0;
     }
-#endif
 
-    return (
-        coefficient * (x->negative ? -((double) mantissa) : (double) mantissa)
-    );
+    return formatted_length(x, base);
 }
 
 /**
- * Perform a left shift on a big integer with the number of bits specified as
- * a standard integer.
+ * Get an upper bound for the number of characters written for a big integer
+ * in a given base excluding the terminating NUL byte. Unlike
+ * "bigint_sizeinbase", this only depends on the sign and the number of bits
+ * in the value, so it is computed in constant time. A buffer one byte larger
+ * than the bound is large enough for both "bigint_snbprint" and
+ * "bigint_snbprintr".
  *
  * Arguments:
  * - x: A big integer.
- * - n: Number of bits to shift left.
+ * - base: The base from 2 to 62.
  *
- * Return: The result of the calculation or `NULL` if there was an error.
+ * Return: The bound if the operation succeeds and 0 if it fails.
  */
-bigint_st *bigint_shli(bigint_st *dest, bigint_st *x, size_t n)
+size_t bigint_sizeinbase_bound(bigint_st *x, unsigned char base)
 {
-    int from;
-    digit_tt lsb;
-    digit_tt msb;
-    size_t msb_shift;
-    size_t offset;
-    size_t original_length;
-    size_t new_digits;
+    size_t bits = bit_length(x);
+    size_t bound = x->negative + (numeral_prefix(base) ? 2 : 0);
 
-    bool free_on_error = false;
+    if (base < 2 || base > NUMERAL_BASE_MAX) {
+        errno = EINVAL;
+        return 0;
+    }
 
-    if (!dest) {
-        if (!(dest = bigint_dup(x))) {
-            return NULL;
-        }
+    // A value with n bits has at most floor(n / log2(base)) + 1 numerals,
+    // and one more is added to absorb any rounding of the division.
+    bound += (size_t) ((double) bits / log2(base)) + 2;
 
-        free_on_error = true;
+    // The space "bigint_snbprintr" needs to align a copy of the value, and
+    // the value may span one more digit than its bits strictly require.
+    if (!POWER_OF_2(base)) {
+        bound += 2 * sizeof(digit_tt);
     }
 
-    // If the shift is 0 or the value is 0, this function is a no-op.
-    if (n == 0 || bigint_eqz(x)) {
-        if (bigint_mov(dest, x)) {
-            if (free_on_error) {
-                bigint_free(dest);
-            }
+    return bound;
+}
 
-            return NULL;
-        }
+/**
+ * Implementation of "bigint_snbprint" without tracing.
+ */
+static int snbprint_untraced(
+    char *buf, size_t buflen, bigint_st *x, unsigned char base
+)
+{
+    size_t numerals;
+    bigint_st *scratch;
+
+    const char *prefix = numeral_prefix(base);
+    size_t written = 0;
+
+    STATS_OPERATION(tostr, x->length);
+
+    if (base < 2 || base > NUMERAL_BASE_MAX) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // The sign, the prefix, the first numeral and the NUL byte.
+    if (buflen < x->negative + (prefix ? 4u : 2u)) {
+        errno = ERANGE;
+        return -1;
+    }
 
-        goto done;
+    if (x->negative) {
+        buf[written++] = '-';
     }
 
-    offset = n % DIGIT_BITS;
-    original_length = x->length;
-    new_digits = n / DIGIT_BITS + (offset != 0);
+    if (prefix) {
+        memcpy(buf + written, prefix, 2);
+        written += 2;
+    }
 
-    if (resize_sum(dest, x->length, new_digits)) {
-        if (free_on_error) {
-            bigint_free(dest);
-        }
+    if (bigint_eqz(x)) {
+        strcpy(buf + written, "0");
+        return (int) written + 1;
+    }
 
-        return NULL;
+    if (POWER_OF_2(base)) {
+        scratch = x;
+    } else if (!(scratch = bigint_dup(x))) {
+        return -1;
     }
 
-    if (offset == 0) {
-        for (size_t i = 0; i < original_length; i++) {
-            dest->digits[original_length - 1 - i + new_digits] = (
-                x->digits[original_length - 1 - i]
-            );
-        }
-    } else {
-        // When the shifts are not aligned with digit boundaries, "n" bits come
-        // from one digit and a complementary number of bits (`DIGIT_BITS - n`)
-        // come from another.
-        msb_shift = DIGIT_BITS - offset;
+    numerals = magnitude_write_numerals(
+        buf + written, buflen - written - 1, scratch, base, 0
+    );
 
-        for (size_t i = 0; i <= original_length; i++) {
-            from = (int) (original_length - i);
-            msb = from < 1 ? 0 : x->digits[from - 1];
-            lsb = from >= (int) original_length ? 0 : x->digits[from];
-            dest->digits[(size_t) from + new_digits - 1] = (
-                (lsb << offset | msb >> msb_shift) & DIGIT_MAX
-            );
-        }
+    if (scratch != x) {
+        bigint_free(scratch);
     }
 
-    // Zero out any holes that were created.
-    memset(dest->digits, 0, sizeof(digit_tt) * (new_digits - (offset != 0)));
+    if (numerals == SIZE_MAX) {
+        return -1;
+    } else if (numerals > INT_MAX - written) {
+        errno = EOVERFLOW;
+        return -1;
+    }
 
-done:
-    dest->negative = x->negative;
-    normalize(dest);
-    return dest;
+    // Reverse the numerical part of the string because it's generated
+    // starting with the least significant digit.
+    for (size_t a = written, b = written + numerals - 1; a < b; a++, b--) {
+        char temp = buf[a];
+        buf[a] = buf[b];
+        buf[b] = temp;
+    }
+
+    written += numerals;
+    buf[written] = '\0';
+    return (int) written;
 }
 
 /**
- * Perform a left shift with big integers.
+ * Write a representation of a big integer in any base from 2 to 62 to a
+ * string buffer. Numerals are written using the same alphabet accepted by
+ * "bigint_strtobib". Binary, octal and hexadecimal values are written with
+ * the prefixes "0b", "0o" and "0x" respectively.
  *
  * Arguments:
- * - x: A big integer.
- * - n: Number of bits to shift left.
+ * - buf: The destination buffer.
+ * - buflen: The size of the destination buffer.
+ * - x: The big integer to write.
+ * - base: The base.
  *
- * Return: The result of the calculation or `NULL` if there was an error.
+ * Return: If the operation succeeds, the number of characters written
+ * excluding the terminating NUL byte. If the operation fails, a negative value
+ * is returned. The buffer being too short is treated as an error, so this
+ * function will return negative value in that scenario.
  */
-bigint_st *bigint_shl(bigint_st *dest, bigint_st *x, bigint_st* n)
+int bigint_snbprint(char *buf, size_t buflen, bigint_st *x, unsigned char base)
 {
-    uintmax_t bits;
-
-    if (bigint_ltz(n)) {
-        errno = EDOM;
-    } else {
-        errno = 0;
-        bits = bigint_toui(n);
-
-        if (errno == 0) {
-            return bigint_shli(dest, x, (size_t) bits);
-        }
-    }
+    int result;
+    trace_span_st span;
 
-    return NULL;
+    trace_begin(&span, "tostr", x->length, 0);
+    result = snbprint_untraced(buf, buflen, x, base);
+    trace_end(&span, NULL);
+    return result;
 }
 
 /**
- * Perform a right shift on a big integer with the number of bits specified as
- * a standard integer.
+ * Write the decimal representation of a big integer to a string buffer.
  *
  * Arguments:
- * - x: A big integer.
- * - n: Number of bits to shift right.
+ * - buf: The destination buffer.
+ * - buflen: The size of the destination buffer.
+ * - x: The big integer to write.
  *
- * Return: The result of the calculation or `NULL` if there was an error.
+ * Return: If the operation succeeds, the number of characters written
+ * excluding the terminating NUL byte. If the operation fails, a negative value
+ * is returned. The buffer being too short is treated as an error, so this
+ * function will return negative value in that scenario.
  */
-bigint_st *bigint_shri(bigint_st *dest, bigint_st *x, size_t n)
+int bigint_snprint(char *buf, size_t buflen, bigint_st *x)
 {
-    size_t offset;
-    size_t shifted_digits;
+    return bigint_snbprint(buf, buflen, x, 10);
+}
 
-    if (!dest && !(dest = bigint_dup(x))) {
-        return NULL;
-    }
+/**
+ * Implementation of "bigint_snbprintr" without tracing.
+ */
+static char *snbprintr_untraced(
+    char *buf, size_t buflen, bigint_st *x, unsigned char base
+)
+{
+    size_t bits;
+    digit_tt chunk;
+    digit_tt *digits;
+    size_t misalignment;
+    size_t per_digit;
+    digit_tt scale;
+    bigint_st scratch;
 
-    // If the shift is 0 or the value is 0, this function is a no-op.
-    if (n == 0 || bigint_eqz(x)) {
-        if (bigint_mov(dest, x)) {
-            return NULL;
-        }
+    char *cursor = buf + buflen - 1;
+    const char *prefix = numeral_prefix(base);
+    size_t length = bit_length(x);
 
-        goto done;
-    }
+    STATS_OPERATION(tostr, x->length);
 
-    if (n >= (DIGIT_BITS * x->length)) {
-        bigint_movui(dest, 0);
-        goto done;
+    if (base < 2 || base > NUMERAL_BASE_MAX) {
+        errno = EINVAL;
+        return NULL;
+    } else if (buflen <= bigint_sizeinbase_bound(x, base)) {
+        errno = ERANGE;
+        return NULL;
     }
 
-    offset = n % DIGIT_BITS;
-    shifted_digits = n / DIGIT_BITS + (offset != 0);
+    *cursor = '\0';
 
-    if (offset == 0) {
-        for (size_t i = 0; i < x->length; i++) {
-            dest->digits[i] = x->digits[i + shifted_digits];
+    if (bigint_eqz(x)) {
+        *--cursor = '0';
+    } else if (POWER_OF_2(base)) {
+        for (bits = 1; (1u << bits) < base; bits++);
+
+        for (size_t offset = 0; offset < length; offset += bits) {
+            chunk = (digit_tt) magnitude_bits(x, offset, bits);
+            *--cursor = numeral_characters[chunk];
         }
     } else {
-        // As with the left shift logic, shifts for unaligned offsets depend on
-        // two digits instead of one.
+        // A numeral takes up 8 bits of the buffer but only accounts for
+        // log2(base) <= 8 bits of the value, so the space left for the
+        // numerals that are not written yet is never smaller than the part
+        // of the copy that is still in use, and the text never reaches it.
+        misalignment = (uintptr_t) buf % _Alignof(digit_tt);
+        digits = (digit_tt *) (
+            buf + (misalignment ? _Alignof(digit_tt) - misalignment : 0)
+        );
+        memcpy(digits, x->digits, x->length * sizeof(*digits));
+        scratch = (bigint_st) {digits, x->length, x->length, false, true};
+        per_digit = numerals_per_digit(base, &scale);
 
-        for (size_t from, i = 0; i < x->length; i++) {
-            from = shifted_digits + i;
-            digit_tt lsb = x->digits[from - 1];
-            digit_tt msb = from < x->length ? x->digits[from] : 0;
-            dest->digits[i] = DIGIT_MAX & (
-                msb << (DIGIT_BITS - offset) | lsb >> offset
-            );
+        while (bigint_nez(&scratch)) {
+            chunk = magnitude_divmod_digit(&scratch, scale);
+
+            for (size_t i = 0; i < per_digit; i++) {
+                if (!chunk && bigint_eqz(&scratch)) {
+                    break;
+                }
+
+                *--cursor = numeral_characters[chunk % base];
+                chunk /= base;
+            }
         }
     }
 
-    // No error checking since shrinking cannot fail.
-    (void) resize(dest, x->length - shifted_digits + (offset != 0)); // TODO: figure out why this works
+    if (prefix) {
+        cursor -= 2;
+        memcpy(cursor, prefix, 2);
+    }
 
-done:
-    dest->negative = x->negative;
-    normalize(dest);
-    return dest;
+    if (x->negative) {
+        *--cursor = '-';
+    }
+
+    return cursor;
 }
 
 /**
- * Perform a right shift with big integers.
+ * Write a representation of a big integer to the end of a string buffer
+ * without allocating any memory. The text is the same as the text written by
+ * "bigint_snbprint", but it ends at the last byte of the buffer, which is
+ * set to NUL, so its length does not need to be known in advance. A copy of
+ * the value is kept at the start of the buffer while the text is generated,
+ * so the buffer must be larger than the bound returned by
+ * "bigint_sizeinbase_bound" rather than the exact size of the text. The
+ * numerals are generated one digit at a time, so this is slower than
+ * "bigint_snbprint" for very large values.
  *
  * Arguments:
- * - x: A big integer.
- * - n: Number of bits to shift right.
+ * - buf: The destination buffer.
+ * - buflen: The size of the destination buffer.
+ * - x: The big integer to write.
+ * - base: The base from 2 to 62.
  *
- * Return: The result of the calculation or `NULL` if there was an error.
+ * Return: A pointer to the first character of the text within the buffer if
+ * the operation succeeds and NULL if it fails. If the buffer is too short,
+ * "errno" is set to `ERANGE`.
  */
-bigint_st *bigint_shr(bigint_st *dest, bigint_st *x, bigint_st* n)
+char *bigint_snbprintr(
+    char *buf, size_t buflen, bigint_st *x, unsigned char base
+)
 {
-    uintmax_t bits;
+    char *result;
+    trace_span_st span;
 
-    if (bigint_ltz(n)) {
-        errno = EDOM;
+    trace_begin(&span, "tostr", x->length, 0);
+    result = snbprintr_untraced(buf, buflen, x, base);
+    trace_end(&span, NULL);
+    return result;
+}
+
+/**
+ * Implementation of "bigint_tostrb" without tracing.
+ */
+static char *tostrb_untraced(bigint_st *x, unsigned char base)
+{
+    char *buffer;
+    size_t length;
+
+    bigint_st *scratch = NULL;
+
+    STATS_OPERATION(tostr, x->length);
+
+    if (!(length = bigint_sizeinbase(x, base))) {
+        return NULL;
+    }
+
+    if (!(buffer = safe_calloc(length + 1, 1))) {
+        return NULL;
+    }
+
+    if (format_known_length(buffer, length, x, base, &scratch)) {
+        xfree(buffer);
+        buffer = NULL;
     } else {
-        errno = 0;
-        bits = bigint_toui(n);
+        buffer[length] = '\0';
+    }
 
-        if (errno == 0) {
-            return bigint_shri(dest, x, bits);
-        }
+    if (scratch) {
+        bigint_free(scratch);
     }
 
-    return NULL;
+    return buffer;
 }
 
 /**
- * Compare two big integers to determine if the first argument is greater than,
- * equal to or less than the second argument.
+ * Get a representation of a big integer in any base from 2 to 62. See
+ * "bigint_snbprint" for details of the format.
  *
  * Arguments:
- * - a: A big integer.
- * - b: A big integer.
+ * - x: The big integer to write.
+ * - base: The base.
  *
- * Return: A positive number if "a" is greater than "b", 0 if "a" equals "b"
- * and a negative number if "a" is less than "b".
+ * Return: If the operation succeeds, a heap-allocated string of exactly the
+ * size needed is retuned that the caller must free. If the operation fails,
+ * NULL is returned.
  */
-int bigint_cmp(const bigint_st *a, const bigint_st *b)
+char *bigint_tostrb(bigint_st *x, unsigned char base)
 {
-    int cmp;
+    char *result;
+    trace_span_st span;
 
-    if (a->negative == b->negative) {
-        cmp = magnitude_cmp(a, b);
-        return a->negative ? -cmp : cmp;
-    }
-
-    return a->negative ? -1 : 1;
+    trace_begin(&span, "tostr", x->length, 0);
+    result = tostrb_untraced(x, base);
+    trace_end(&span, NULL);
+    return result;
 }
 
 /**
- * Increment the value of a big integer by 1.
+ * Get the decimal representation of a big integer.
  *
- * Arguments:
  * - x: A big integer.
  *
- * Return: 0 if the operation succeeds and a negative value otherwise.
+ * Return: If the operation succeeds, a heap-allocated string is retuned that
+ * the caller must free. If the operation fails, NULL is returned.
  */
-int bigint_inc(bigint_st *x)
+char *bigint_tostr(bigint_st *x)
 {
-    return bigint_ltz(x) ? magnitude_dec(x) : magnitude_inc(x);
+    return bigint_tostrb(x, 10);
 }
 
 /**
- * Decrement the value of a big integer by 1.
+ * Write the values of a group.
  *
  * Arguments:
- * - x: A big integer.
+ * - arg: The group to write.
  *
- * Return: 0 if the operation succeeds and a negative value otherwise.
+ * Return: Always NULL. This signature allows the function to be used as the
+ * start routine of a thread.
  */
-int bigint_dec(bigint_st *x)
+static void *format_group(void *arg)
 {
-    if (bigint_eqz(x)) {
-        x->length = 1;
-        x->digits[0] = 1;
-        x->negative = true;
-        return 0;
+    format_group_st *group = arg;
+    char *cursor = group->buf;
+    bigint_st *scratch = NULL;
+
+    task_state_swap(&group->state);
+
+    for (size_t i = 0; i < group->count; i++) {
+        if (format_known_length(
+            cursor, group->lengths[i], group->values[i], group->base, &scratch
+        )) {
+            group->state.error = errno;
+            break;
+        }
+
+        cursor += group->lengths[i];
+
+        if (i + 1 < group->count || !group->last) {
+            memcpy(cursor, group->separator, group->separator_length);
+            cursor += group->separator_length;
+        }
     }
 
-    return bigint_ltz(x) ? magnitude_inc(x) : magnitude_dec(x);
+    if (scratch) {
+        bigint_free(scratch);
+    }
+
+    task_state_swap(&group->state);
+    return NULL;
 }
 
 /**
- * Add two big integers.
+ * Write an array of big integers to a string buffer with a separator between
+ * each value. This implements "bigint_snbprintv" and "bigint_tostrbv".
  *
  * Arguments:
- * - dest: Pointer to the output destination. If this is NULL, a heap pointer
- *   is returned that the caller is responsible for freeing with "bigint_free".
- * - a: Addend.
- * - b: Addend.
+ * - buf: The destination buffer or NULL to allocate a buffer of the exact
+ *   size needed.
+ * - buflen: The size of the destination buffer.
+ * - length: Output pointer for the number of characters written excluding
+ *   the terminating NUL byte or the number needed if the buffer is too short.
+ * - values: The big integers to write.
+ * - count: The number of big integers.
+ * - base: The base.
+ * - separator: Text written between values.
+ * - threads: Maximum number of threads used to write the values.
  *
- * Return: A pointer to the result of the calculation.
+ * Return: The destination buffer if the operation succeeds and NULL
+ * otherwise.
  */
-bigint_st *bigint_add(bigint_st *dest, bigint_st *a, bigint_st *b)
+static char *format_values(
+    char *buf,
+    size_t buflen,
+    size_t *length,
+    bigint_st **values,
+    size_t count,
+    unsigned char base,
+    const char *separator,
+    unsigned threads
+)
 {
-    int cmp;
-    bigint_st *result;
+    format_group_st *groups;
+    size_t *lengths;
+    size_t offset;
+    size_t start;
+    size_t target;
+    size_t total;
+    pthread_t *workers;
 
-    bool free_dest_on_error = false;
+    char *allocated = NULL;
+    bool failed = false;
+    size_t separator_length = strlen(separator);
 
-    if (!dest) {
-        if (!(dest = bigint_from_int(0))) {
-            return NULL;
+    *length = 0;
+    STATS_ADD(tostrv.calls, 1);
+
+    if (base < 2 || base > NUMERAL_BASE_MAX) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    if (!(lengths = safe_calloc(count ? count : 1, sizeof(*lengths)))) {
+        return NULL;
+    }
+
+    // Compute the exact size of the output before writing anything.
+    total = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        STATS_ADD(tostrv.digits, values[i]->length);
+
+        if (!(lengths[i] = formatted_length(values[i], base))) {
+            goto error;
+        } else if (total > SIZE_MAX - 1 - lengths[i] - separator_length) {
+            errno = EOVERFLOW;
+            goto error;
+        }
+
+        total += lengths[i] + (i + 1 < count ? separator_length : 0);
+    }
+
+    *length = total;
+
+    if (!buf) {
+        if (!(buf = allocated = safe_calloc(total + 1, 1))) {
+            goto error;
         }
-
-        free_dest_on_error = true;
+    } else if (total >= buflen) {
+        errno = ERANGE;
+        goto error;
     }
 
-    cmp = magnitude_cmp(a, b);
+    if (threads > total / BATCH_RANGE_MIN) {
+        threads = (unsigned) (total / BATCH_RANGE_MIN);
+    }
 
-    // TODO: check return value of magnitude_sum, *_delta; free dest if allocated.
-    if (a->negative == b->negative) {
-        dest->negative = a->negative;
-        result = magnitude_sum(dest, a, b);
-    } else if (cmp > 0) {
-        dest->negative = a->negative;
-        result = magnitude_delta(dest, a, b);
-    } else if (cmp < 0) {
-        dest->negative = b->negative;
-        result = magnitude_delta(dest, b, a);
-    } else {
-        bigint_movui(dest, 0);
-        result = dest;
+    if (threads == 0) {
+        threads = 1;
     }
 
-    if (!result && free_dest_on_error) {
-        bigint_free(dest);
+    if (!(groups = safe_calloc(threads, sizeof(*groups)))) {
+        goto error;
     }
 
-    return result;
-}
+    // Divide the values into consecutive groups that produce roughly the same
+    // amount of text. Every group knows exactly where its output begins.
+    start = 0;
+    offset = 0;
 
-/**
- * Subtract one big integer from another.
- *
- * Arguments:
- * - out: Pointer to the output destination. If this is NULL, a heap pointer is
- *   returned that the caller is responsible for freeing with "bigint_free".
- * - a: Minuend.
- * - b: Subtrahend.
- *
- * Return: A pointer to the result of the calculation.
- */
-bigint_st *bigint_sub(bigint_st *dest, bigint_st *a, bigint_st *b)
-{
-    int cmp;
-    bigint_st* result;
+    for (unsigned i = 0; i < threads; i++) {
+        groups[i] = (format_group_st) {
+            buf + offset, values + start, lengths + start, 0,
+            separator, separator_length, base, false, false, task_state_fork()
+        };
+        target = total / threads * (i + 1);
 
-    bool free_dest_on_error = false;
+        while (start < count && (i == threads - 1 || offset < target)) {
+            offset += lengths[start++] + separator_length;
+            groups[i].count++;
+        }
 
-    if (dest) {
-        if (dest != a && dest != b) {
-            bigint_movui(dest, 0);
+        groups[i].last = start == count;
+    }
+
+    workers = threads > 1 ? safe_calloc(threads, sizeof(*workers)) : NULL;
+
+    // A group is written by the calling thread when a thread cannot be
+    // created for it. Either way, it runs with the memory accounting of the
+    // calling thread, so every group is subject to the same limit.
+    for (unsigned i = 1; i < threads; i++) {
+        groups[i].threaded = workers && !pthread_create(
+            &workers[i], NULL, format_group, &groups[i]
+        );
+
+        if (!groups[i].threaded) {
+            format_group(&groups[i]);
+            task_state_merge(&groups[i].state);
         }
-    } else if ((dest = bigint_from_int(0))) {
-        free_dest_on_error = true;
-    } else {
-        return NULL;
     }
 
-    cmp = magnitude_cmp(a, b);
+    format_group(&groups[0]);
+    task_state_merge(&groups[0].state);
 
-    // +a, +b
-    if (!a->negative && !b->negative) {
-        if (cmp >= 0) {
-            result = magnitude_delta(dest, a, b);
-            dest->negative = false;
-        } else {
-            result = magnitude_delta(dest, b, a);
-            dest->negative = true;
+    for (unsigned i = 0; i < threads; i++) {
+        if (groups[i].threaded) {
+            pthread_join(workers[i], NULL);
+            task_state_merge(&groups[i].state);
+        }
+
+        if (groups[i].state.error && !failed) {
+            errno = groups[i].state.error;
+            failed = true;
         }
-    // +a, -b
-    } else if (!a->negative && b->negative) {
-        result = magnitude_sum(dest, a, b);
-        dest->negative = false;
-    // -a, +b
-    } else if (a->negative && !b->negative) {
-        result = magnitude_sum(dest, a, b);
-        dest->negative = (bool) dest->length;
-    // -a, -b
-    } else if (cmp >= 0) {
-        result = magnitude_delta(dest, a, b);
-        dest->negative = (bool) dest->length;
-    } else {
-        result = magnitude_delta(dest, b, a);
-        dest->negative = false;
     }
 
-    if (!result && free_dest_on_error) {
-        bigint_free(dest);
+    xfree(workers);
+    xfree(groups);
+
+    if (failed) {
+        goto error;
     }
 
-    return result;
+    xfree(lengths);
+    buf[total] = '\0';
+    return buf;
+
+error:
+    xfree(allocated);
+    xfree(lengths);
+    return NULL;
 }
 
 /**
- * Multiple two big integers.
+ * Write an array of big integers to a single string buffer with a separator
+ * between each value. Every value is written the same way as it is by
+ * "bigint_snbprint". The exact length of every value is computed before
+ * anything is written, so each value has a known position in the buffer, and
+ * when multiple threads are used, each one writes a group of consecutive
+ * values directly into place. A single big integer is reused by each thread
+ * to hold the values as they are written.
  *
  * Arguments:
- * - dest: Pointer to the output destination. If this is NULL, a heap pointer
- *   is returned that the caller is responsible for freeing with "bigint_free".
- * - a: Multiplicand.
- * - b: Multiplicand.
+ * - buf: The destination buffer.
+ * - buflen: The size of the destination buffer.
+ * - length: Output pointer for the number of characters written excluding
+ *   the terminating NUL byte. If the buffer is too short, this is set to the
+ *   number of characters needed instead.
+ * - values: The big integers to write.
+ * - count: The number of big integers.
+ * - base: The base from 2 to 62.
+ * - separator: Text written between values such as "\n" or ",".
+ * - threads: Maximum number of threads used to write the values. Small
+ *   outputs are always written by the calling thread.
  *
- * Return: A pointer to the result of the calculation if it succeeds and `NULL`
- * otherwise.
+ * Return: 0 if the operation succeeds and -1 if it fails. The buffer being
+ * too short is treated as an error that sets "errno" to `ERANGE`.
  */
-bigint_st *bigint_mul(bigint_st *dest, bigint_st *a, bigint_st *b)
+int bigint_snbprintv(
+    char *buf,
+    size_t buflen,
+    size_t *length,
+    bigint_st **values,
+    size_t count,
+    unsigned char base,
+    const char *separator,
+    unsigned threads
+)
 {
-    digit_tt a_i;
-    digit_tt b_j;
-    size_t max_factor_length;
-    bigint_st *original_dest;
+    return format_values(
+        buf, buflen, length, values, count, base, separator, threads
+    ) ? 0 : -1;
+}
 
-#ifdef DIGIT_SUPER_TYPE
-    digit_super_tt carry;
-    digit_super_tt product;
-#else
-    digit_tt carry;
-    digit_tt product;
-#endif
+/**
+ * Get a string containing an array of big integers with a separator between
+ * each value. See "bigint_snbprintv" for details of the format.
+ *
+ * Arguments:
+ * - length: Output pointer for the length of the string.
+ * - values: The big integers to write.
+ * - count: The number of big integers.
+ * - base: The base from 2 to 62.
+ * - separator: Text written between values.
+ * - threads: Maximum number of threads used to write the values.
+ *
+ * Return: If the operation succeeds, a heap-allocated string of exactly the
+ * size needed is returned that the caller must free. If the operation fails,
+ * NULL is returned.
+ */
+char *bigint_tostrbv(
+    size_t *length,
+    bigint_st **values,
+    size_t count,
+    unsigned char base,
+    const char *separator,
+    unsigned threads
+)
+{
+    return format_values(
+        NULL, 0, length, values, count, base, separator, threads
+    );
+}
 
-    original_dest = dest;
+/**
+ * Implementation of "bigint_logui" without tracing.
+ */
+static bigint_st *logui_untraced(bigint_st *dest, bigint_st *x, uintmax_t base)
+{
+    bigint_st *base_bi;
+    bigint_st *estimate;
+    bigint_st *product;
+    uintmax_t floor_log2;
+    uintmax_t ratio;
+    uintmax_t power;
+    int cmp;
 
-    if (!dest) {
-        dest = bigint_from_int(0);
-    } else if (dest == a || dest == b) {
-        // The destination value is used as an accumulator, so if the
-        // destination happens to also be one of the inputs, we first make a
-        // new structure which will be copied to the destination once the
-        // calculations are done.
-        if (!(dest = bigint_dup(dest))) {
-            return NULL;
-        }
-    }
+    bool free_dest_on_error = false;
 
-    if (!dest) {
-        return NULL;
-    }
+    STATS_OPERATION(logui, x->length);
 
-    if (bigint_eqz(a) || bigint_eqz(b)) {
-        dest->length = 0;
-        dest->negative = false;
-        return dest;
+    if (bigint_lez(x) || base < 2) {
+        errno = EDOM;
+        return NULL;
     }
 
-    if (a->length > 1 && bigint_is_power_of_2(a)) {
-        if (!bigint_shli(dest, b, ctz(a))) {
-            // TODO: free dest if allocated
+    if (POWER_OF_2(base)) {
+        if (SIZE_MAX / x->length < DIGIT_BITS) {
+            errno = ERANGE;
             return NULL;
         }
 
-        goto done;
-    }
+        floor_log2 = DIGIT_BITS * x->length - clz(x) - 1;
 
-    if (b->length > 1 && bigint_is_power_of_2(b)) {
-        if (!bigint_shli(dest, a, ctz(b))) {
-            // TODO: free dest if allocated
+        if (floor_log2 > INTMAX_MAX) {
+            errno = ERANGE;
             return NULL;
         }
 
-        goto done;
-    }
+        for (ratio = 1; base > 2; ratio++) {
+            base /= 2;
+        }
 
-    if (bigint_eqz(a) || bigint_eqz(b)) {
-        bigint_movui(dest, 0);
-        return dest;
-    }
+        if (!dest) {
+            return bigint_from_uint(floor_log2 / ratio);
+        }
 
-    // Allocate as much space as we could possibly need up front.
-    if (resize_sum(dest, a->length, b->length)) {
-        return NULL;
+        bigint_movui(dest, floor_log2 / ratio);
+        return dest;
     } else {
-        // Clear the contents of the destination because its digits are used as
-        // accumulators during intermediate calculations.
-        memset(dest->digits, 0, dest->allocated * sizeof(digit_tt));
-    }
-
-    max_factor_length = a->length > b->length ? a->length : b->length;
+        if (!dest) {
+            if (!(dest = bigint_from_int(0))) {
+                return NULL;
+            }
 
-    for (size_t i = 0; i < max_factor_length; i++) {
-        carry = 0;
+            free_dest_on_error = true;
+        }
 
-        for (size_t j = 0; j < max_factor_length; j++) {
-            a_i = i < a->length ? a->digits[i] : 0;
-            b_j = j < b->length ? b->digits[j] : 0;
+        // Small bases are taken from the constant table instead of being
+        // allocated.
+        if (base <= SMALL_NUMBERS_MAX) {
+            base_bi = SMALL_NUMBER(base);
+        } else if (!(base_bi = bigint_from_uint(base))) {
+            return NULL;
+        }
 
-#ifdef DIGIT_SUPER_TYPE
-            product = dest->digits[i + j] + carry + a_i * b_j;
-            carry = DIGIT_MAX & (product >> DIGIT_BITS);
-            product = DIGIT_MAX & product;
-#else
-            u128fma64(&carry, &product, a_i, b_j, carry);
-            u128add64(&carry, &product, dest->digits[i + j]);
-#endif
-            dest->digits[i + j] = (digit_tt) product;
+        if (base <= SMALL_NUMBERS_MAX) {
+            // Rather than starting from 1, the search starts from a power that
+            // is known to be less than "x" based on its bit length. The
+            // estimate is lowered by one to absorb any floating point error.
+            power = (uintmax_t) (
+                (double) (bit_length(x) - 1) / log2((double) base)
+            );
+            power = power > 0 ? power - 1 : 0;
 
-            if (product != 0 && (i + j + 1 > dest->length)) {
-                dest->length = i + j + 1;
+            if (!(estimate = power_cache_get((unsigned) base, power))) {
+                goto error;
             }
+
+            product = bigint_dup(estimate);
+            power_cache_release(estimate);
+        } else {
+            power = 0;
+            product = bigint_from_int(1);
+        }
+
+        if (!product) {
+            goto error;
         }
 
-        if (carry != 0) {
-            if (i + max_factor_length + 1 > dest->length) {
-                dest->length = i + max_factor_length + 1;
+        for (; (cmp = magnitude_cmp(x, product)) > 0; power++) {
+            if (power == UINTMAX_MAX) {
+                errno = ERANGE;
+                goto error_after_product_alloc;
+            } else if (!bigint_mul(product, product, base_bi)) {
+                goto error_after_product_alloc;
             }
+        }
+
+        // The search stops at the first power that is not less than "x", so
+        // unless it is equal, the logarithm is rounded down to the one before.
+        // The starting power is never greater than "x".
+        bigint_movui(dest, cmp < 0 ? power - 1 : power);
+        bigint_free(product);
+
+        if (base > SMALL_NUMBERS_MAX) {
+            bigint_free(base_bi);
+        }
+
+        return dest;
+
+error_after_product_alloc:
+        bigint_free(product);
+
+error:
+        if (base > SMALL_NUMBERS_MAX) {
+            bigint_free(base_bi);
+        }
 
-            dest->digits[i + max_factor_length] = (digit_tt) carry;
+        if (free_dest_on_error) {
+            bigint_free(dest);
         }
+
+        return NULL;
     }
+}
 
-done:
-    if (original_dest && dest != original_dest) {
-        xfree(original_dest->digits);
-        *original_dest = *dest;
-        xfree(dest);
-        dest = original_dest;
+/**
+ * Compute the logarithm of a big integer with the base specified as a standard
+ * unsigned integer.
+ *
+ * Arguments:
+ * - dest: Output destination. If this is NULL, it will be allocated.
+ * - x: Value for which the logarithm should be computed.
+ * - base: Logarithm base.
+ *
+ * Return: A pointer to the absolute value or NULL if the function failed. If
+ * the base is less than two, this function will fail with errno set to EDOM.
+ */
+bigint_st *bigint_logui(bigint_st *dest, bigint_st *x, uintmax_t base)
+{
+    bigint_st *result;
+    trace_span_st span;
+
+    trace_begin(&span, "logui", x->length, 0);
+    result = logui_untraced(dest, x, base);
+    trace_end(&span, result);
+    return result;
+}
+
+/**
+ * Compute the absolute value of a big integer.
+ *
+ * Arguments:
+ * - dest: Output destination. If this is NULL, it will be allocated.
+ * - x: Target value.
+ *
+ * Return: A pointer to the absolute value or NULL if the function failed.
+ */
+bigint_st *bigint_abs(bigint_st *dest, bigint_st *x)
+{
+    if (dest != x) {
+        if (!dest) {
+            dest = bigint_dup(x);
+        } else if (bigint_mov(dest, x)) {
+            dest = NULL;
+        }
+    }
+
+    if (dest) {
+        dest->negative = false;
     }
 
-    dest->negative = a->negative != b->negative;
-    normalize(dest);
     return dest;
 }
 
 /**
- * Divide one big integer by another.
- *
- * Arguments:
- * - q: Quotient; pointer to the output destination. If this is NULL, a heap
- *   pointer is returned that the caller is responsible for freeing with
- *   "bigint_free".
- * - r: Optional output pointer for the remainder.
- * - n: Numerator.
- * - d: Denominator.
- *
- * Return: A pointer to the result of the calculation. If there were any
- * errors, this will be `NULL` and "errno" will be set accordingly. "EDOM" is
- * used to indicate division by zero.
+ * Implementation of "bigint_gcd" without tracing.
  */
-bigint_st *bigint_div(bigint_st *q, bigint_st **r, bigint_st *n, bigint_st *d)
+static bigint_st *gcd_untraced(bigint_st *dest, bigint_st *a, bigint_st* b)
 {
-    // TODO: handle q and/or r being n and/or d.
-    int cmp;
+    size_t a_zeroes;
+    size_t b_zeroes;
+    size_t common_zeroes;
+    bigint_st *temp;
 
-    bigint_st *accumulator = NULL;
-    bool free_q_on_failure = false;
-    size_t hidden_digits = 0;
-    bigint_st *intermediate = NULL;
-    size_t quotient_digits = 0;
+    bool free_dest_on_error = false;
 
-    // Cannot divide by 0.
-    if (bigint_eqz(d)) {
-        errno = EDOM;
+    STATS_OPERATION(gcd, a->length + b->length);
+
+    if (!(a = bigint_dup(a))) {
         return NULL;
     }
 
-    if (!q) {
-        if (!(q = bigint_from_int(0))) {
-            return NULL;
-        }
-
-        free_q_on_failure = true;
+    if (!(b = bigint_dup(b))) {
+        goto error_after_a_dup;
     }
 
-    if (d->length == 1 && d->digits[0] == 1) {
-        // Anything divided by 1 is itself with a remainder of 0.
-        if (r) {
-            if (*r) {
-                bigint_movui(*r, 0);
-            } else if (!(*r = bigint_from_int(0))) {
-                goto error;
-            }
-        }
-
-        if (bigint_mov(q, n)) {
-            goto error;
+    if (!dest) {
+        if (!(dest = bigint_from_int(0))) {
+            goto error_after_b_dup;
         }
 
-        goto set_signs;
+        free_dest_on_error = true;
     }
 
-    cmp = magnitude_cmp(n, d);
-
-    if (cmp == 0) {
-        // If the numerator and denominator are equal, the result is always 1
-        // with a remainder of 0.
-        if (r) {
-            if (*r) {
-                bigint_movui(*r, 0);
-            } else if (!(*r = bigint_from_int(0))) {
-                goto error;
-            }
-        }
-
-        bigint_movui(q, 1);
-        goto set_signs;
-    } else if (cmp < 0) {
-        // If the numerator has a magnitude less than the denominator, the
-        // result will always be 0 and the remainder will be the numerator.
-        if (r) {
-            if (*r) {
-                if (bigint_mov(*r, n)) {
-                    goto error;
-                }
-            } else if (!(*r = bigint_dup(n))) {
-                goto error;
-            }
-        }
-
-        bigint_movui(q, 0);
-        goto set_signs;
-    }
+    // This function was adapted from
+    // <https://en.wikipedia.org/w/index.php?title=Binary_GCD_algorithm&oldid=1203806811#Implementation>.
+    a->negative = false;
+    b->negative = false;
 
-    if (bigint_is_power_of_2(d)) {
-        if (!bigint_shri(q, n, ctz(d))) {
-            goto error;
+    if (bigint_eqz(a)) {
+        if (bigint_mov(dest, b)) {
+            goto error_after_dest_alloc;
         }
-
-        if (r) {
-            if (*r) {
-                bigint_movui(*r, 0);
-            } else if (!(*r = bigint_dup(n))) {
-                goto error;
-            } else {
-                bigint_movui(*r, 0);
-            }
+    } else if (bigint_eqz(b)) {
+        if (bigint_mov(dest, a)) {
+            goto error_after_dest_alloc;
         }
+    } else {
+        a_zeroes = ctz(a);
+        b_zeroes = ctz(b);
+        common_zeroes = a_zeroes < b_zeroes ? a_zeroes : b_zeroes;
 
-        goto set_signs;
-    }
-
-    if (!(accumulator = bigint_from_int(0))) {
-        goto error;
-    }
-
-    if (r && *r) {
-        if (bigint_mov((intermediate = *r), n)) {
-            goto error;
+        if (!bigint_shri(a, a, a_zeroes)) {
+            goto error_after_dest_alloc;
         }
-    } else if (!(intermediate = bigint_dup(n))) {
-        goto error;
-    }
-
-    if (resize(q, n->length)) {
-        goto error;
-    }
-
-    // The intermediate quotient starts out with the contents of the numerator.
-    // Then we truncate it so it has the same length as the denominator. The
-    // truncation is done by modifying the metadata and array offset so the
-    // hidden digits can be unveiled by undoing these adjustments.
-    hidden_digits = n->length - d->length;
-    intermediate->digits += hidden_digits;
-    intermediate->length = d->length;
 
-    do {
-        // While the intermediate quotient is less than the divisor, pull down
-        // a digit from the numerator by unveiling the next value in the digits
-        // array.
-        cmp = magnitude_cmp(intermediate, d);
-
-        while (cmp < 0) {
-            if (hidden_digits == 0) {
-                goto quotient_complete;
-            }
-
-            intermediate->length++;
-            intermediate->digits--;
-            hidden_digits--;
-
-            // If pulling down a digit did not create a number greater than or
-            // equal to the divisor, the corresponding quotient digit is 0.
-            if ((cmp = magnitude_cmp(intermediate, d)) < 0) {
-                q->digits[q->length - quotient_digits++ - 1] = 0;
-            }
+        if (!bigint_shri(b, b, b_zeroes)) {
+            goto error_after_dest_alloc;
         }
 
-        // Once we have an intermediate quotient that is larger than the
-        // denominator, we need to figure out what factor to multiply the
-        // denominator by to get the largest value that is less than or equal
-        // to the intermediate quotient.
-        bigint_movui(accumulator, 0);
-
-        for (digit_tt factor = 1; factor <= DIGIT_MAX; factor++) {
-            if (!magnitude_sum(accumulator, accumulator, d)) {
-                goto error;
+        while (1) {
+            if (magnitude_cmp(a, b) > 0) {
+                temp = a;
+                a = b;
+                b = temp;
             }
 
-            cmp = magnitude_cmp(accumulator, intermediate);
+            MAGNITUDE_RDELTA(b, a);
 
-            if (cmp >= 0 || factor == DIGIT_MAX) {
-                // If accumulator overshot the intermediate quotient, undo the
-                // last increment.
-                if (cmp > 0) {
-                    MAGNITUDE_RDELTA(accumulator, d);
-                    factor--;
+            if (bigint_eqz(b)) {
+                if (bigint_shli(dest, a, common_zeroes)) {
+                    break;
                 }
 
-                MAGNITUDE_RDELTA(intermediate, accumulator);
-                q->digits[q->length - quotient_digits++ - 1] = factor;
-                break;
+                goto error_after_dest_alloc;
             }
-        }
-    } while (hidden_digits);
-
-quotient_complete:
-    bigint_free(accumulator);
-
-    // The final value of the intermediate quotient is the remainder.
-    if (r) {
-        *r = intermediate;
-    } else {
-        bigint_free(intermediate);
-    }
-
-    // When generating the result, we fill the quotient starting at the most
-    // significant digit, so we need to shift the result to get rid of the
-    // digits that were never populated.
-    bigint_shri(q, q, DIGIT_BITS * (q->length - quotient_digits));
-    q->length = quotient_digits;
-
-set_signs:
-    // Sign rules for the quotient and remainder use the same rules that C does
-    // for standard integer types.
-    if (n->negative && d->negative) {
-        q->negative = false;
-
-        if (r && bigint_nez(*r)) {
-            (*r)->negative = true;
-        }
-    } else if (n->negative && !d->negative) {
-        if (bigint_nez(q)) {
-            q->negative = true;
-        }
-
-        if (r && bigint_nez(*r)) {
-            (*r)->negative = true;
-        }
-    } else if (!n->negative && d->negative) {
-        if (bigint_nez(q)) {
-            q->negative = true;
-        }
 
-        if (r) {
-            (*r)->negative = false;
+            if (!bigint_shri(b, b, ctz(b))) {
+                goto error_after_dest_alloc;
+            }
         }
     }
 
-    return q;
-
-error:
-    // We need to move the intermediate quotient's digits pointer back to its
-    // original position so free(3) works.
-    intermediate->digits -= hidden_digits;
+    bigint_free(b);
+    bigint_free(a);
+    return dest;
 
-    if (free_q_on_failure) {
-        bigint_free(q);
+error_after_dest_alloc:
+    if (free_dest_on_error) {
+        bigint_free(dest);
     }
 
-    if (intermediate) {
-        bigint_free(intermediate);
-    }
+error_after_b_dup:
+    bigint_free(b);
 
-    if (accumulator) {
-        bigint_free(accumulator);
-    }
+error_after_a_dup:
+    bigint_free(a);
 
     return NULL;
 }
 
 /**
- * Compute the module of one integer by another.
+ * Get the greatest common denominator of two big integers.
  *
  * Arguments:
- * - r: Remainder; pointer to the output destination. If this is NULL, a heap
- *   pointer is returned that the caller is responsible for freeing with
- *   "bigint_free".
- * - n: Numerator.
- * - d: Denominator.
+ * - a: A big integer.
+ * - b: A big integer.
  *
- * Return: A pointer to the result of the calculation. If there were any
- * errors, this will be `NULL` and "errno" will be set accordingly. "EDOM" is
- * used to indicate division by zero.
+ * Return: A pointer to the destination if the operation succeeded or NULL if
+ * it failed.
  */
-bigint_st *bigint_mod(bigint_st *r, bigint_st *n, bigint_st *d)
+bigint_st *bigint_gcd(bigint_st *dest, bigint_st *a, bigint_st* b)
 {
-    bool free_r_on_error = false;
-    bigint_st *q = NULL;
-
-    if (!r) {
-        if (!(r = bigint_from_int(0))) {
-            return NULL;
-        }
-
-        free_r_on_error = true;
-    }
-
-    if (!bigint_div(q, &r, n, d)) {
-        if (free_r_on_error) {
-            bigint_free(r);
-        }
-
-        r = NULL;
-    }
+    bigint_st *result;
+    trace_span_st span;
 
-    bigint_free(q);
-    return r;
+    trace_begin(&span, "gcd", a->length, b->length);
+    result = gcd_untraced(dest, a, b);
+    trace_end(&span, result);
+    return result;
 }
 
 /**
- * Compute the value of a number raise to an exponent.
+ * Get the mask of the bits of the most significant digit of the values of a
+ * vector.
  *
  * Arguments:
- * - base: The base big integer.
- * - exp: The exponent the base is raised to as a big integer.
+ * - vec: A vector.
  *
- * Return: A pointer to the result of the calculation if it succeeds or `NULL`
- * if it fails. If the exponent is less than 0, "errno" is set to `EDOM`.
+ * Return: The mask.
  */
-bigint_st *bigint_pow(bigint_st* dest, bigint_st *base, bigint_st* exp)
+static digit_tt vec_top_mask(const bigint_vec_st *vec)
 {
-    bool free_dest_on_error = false;
-    bool negative = bigint_nez(exp) && bigint_ltz(base) && exp->digits[0] & 1;
-
-    if (bigint_ltz(exp)) {
-        errno = EDOM;
-        return NULL;
-    }
-
-    // TODO: handle exp = 1 and base = 0 in a way that avoid unnecessary dup
-    // calls.
-    if (!(exp = bigint_dup(exp))) {
-        goto error;
-    }
-
-    if (!(base = bigint_dup(base))) {
-        goto error;
-    }
-
-    if (dest) {
-        bigint_movui(dest, 1);
-    } else {
-        dest = bigint_from_int(1);
-        free_dest_on_error = true;
+    if (vec->bits % DIGIT_BITS == 0) {
+        return DIGIT_MAX;
     }
 
-    if (bigint_eqz(exp)) {
-        bigint_movui(dest, 1);
-        goto done;
-    }
+    return (digit_tt) (((digit_tt) 1 << vec->bits % DIGIT_BITS) - 1);
+}
 
-    if (bigint_eqz(base)) {
-        bigint_movui(dest, 0);
-        goto done;
-    }
+/**
+ * Get one digit of a block of values of a vector.
+ *
+ * Arguments:
+ * - vec: A vector.
+ * - digit: Index of the digit.
+ * - first: Index of the first value of the block.
+ *
+ * Return: The digits of the `VEC_LANES` values of the block. Values are
+ * zero-extended, so this is a row of zeroes if they have fewer digits.
+ */
+static const digit_tt *vec_row(
+    const bigint_vec_st *vec, size_t digit, size_t first
+)
+{
+    static const digit_tt zeroes[VEC_LANES];
 
-    if (!dest) {
-        goto error;
+    if (digit >= vec->length) {
+        return zeroes;
     }
 
-    while (1) {
-        if ((exp->digits[0] & 1) && !bigint_mul(dest, dest, base)) {
-            goto error;
-        }
-
-        bigint_shri(exp, exp, 1);
-
-        if (bigint_eqz(exp)) {
-            break;
-        }
-
-        if (!bigint_mul(base, base, base)) {
-            goto error;
-        }
-    }
+    return vec->digits + digit * vec->stride + first;
+}
 
-done:
-    dest->negative = negative;
-    bigint_free(base);
-    bigint_free(exp);
-    return dest;
+/**
+ * Clear the bits of the most significant digit of the values of a vector
+ * that are beyond its width.
+ *
+ * Arguments:
+ * - vec: A vector.
+ */
+static void vec_truncate(bigint_vec_st *vec)
+{
+    digit_tt mask = vec_top_mask(vec);
+    digit_tt *row = vec->digits + (vec->length - 1) * vec->stride;
 
-error:
-    if (base) {
-        bigint_free(base);
+    for (size_t i = 0; i < vec->stride; i++) {
+        row[i] &= mask;
     }
+}
 
-    if (free_dest_on_error) {
-        bigint_free(dest);
+/**
+ * Check that the vectors of an element-wise operation hold the same number
+ * of values.
+ *
+ * Arguments:
+ * - dest: The destination.
+ * - a: The first operand.
+ * - b: The second operand.
+ *
+ * Return: 0 if the vectors match and -1 with "errno" set to `EINVAL` if they
+ * do not.
+ */
+static int vec_check(
+    const bigint_vec_st *dest, const bigint_vec_st *a, const bigint_vec_st *b
+)
+{
+    if (a->count != dest->count || b->count != dest->count) {
+        errno = EINVAL;
+        return -1;
     }
 
-    if (exp) {
-        bigint_free(exp);
+    return 0;
+}
+
+/**
+ * Add or subtract two vectors. The carries of a block are kept in an array
+ * with one entry per value, and every loop over the values of a block is
+ * free of branches so it can be vectorized.
+ *
+ * Arguments:
+ * - dest: The destination which may be the same as either operand.
+ * - a: The first operand.
+ * - b: The second operand.
+ * - subtract: Value indicating whether `b` is subtracted instead of added.
+ */
+static void vec_sum(
+    bigint_vec_st *dest,
+    const bigint_vec_st *a,
+    const bigint_vec_st *b,
+    bool subtract
+)
+{
+    digit_tt carry[VEC_LANES];
+    digit_tt high;
+    digit_tt low;
+    digit_tt *r;
+    const digit_tt *x;
+    const digit_tt *y;
+
+    for (size_t first = 0; first < dest->stride; first += VEC_LANES) {
+        memset(carry, 0, sizeof(carry));
+
+        for (size_t d = 0; d < dest->length; d++) {
+            r = dest->digits + d * dest->stride + first;
+            x = vec_row(a, d, first);
+            y = vec_row(b, d, first);
+
+            if (subtract) {
+                for (size_t k = 0; k < VEC_LANES; k++) {
+                    low = (digit_tt) (x[k] - y[k]);
+                    high = x[k] < y[k];
+                    r[k] = (digit_tt) (low - carry[k]);
+                    carry[k] = high | (low < carry[k]);
+                }
+            } else {
+                for (size_t k = 0; k < VEC_LANES; k++) {
+                    low = (digit_tt) (x[k] + y[k]);
+                    high = low < x[k];
+                    r[k] = (digit_tt) (low + carry[k]);
+                    carry[k] = high | (r[k] < low);
+                }
+            }
+        }
     }
 
-    return NULL;
+    vec_truncate(dest);
 }
 
 /**
- * Convert a string to a big integer. This function supports hexadecimal
- * indicated by the prefix "0x" and "0X"; octal octal by "0o", "0O" or simply
- * "0"; and binary by "0b" and "0B". Otherwise, the string is parsed as a
- * decimal value. Decimal parsing supports scientific notation with integer
- * coefficients and positive exponents like "1e100" and "12E3".
+ * Create a vector of unsigned integers of a fixed width, all of which are
+ * initially 0. The values are stored digit-major so the element-wise
+ * operations on vectors process several values with each vector
+ * instruction, which is much faster than operating on as many separate big
+ * integers when the values are of moderate size.
  *
  * Arguments:
- * - str: Text to convert to a big integer.
- * - fraction: Optional output pointer that will be used to indicate where the
- *   unused fractional value of the input begins. It ends at the first
- *   non-decimal-digit character following this pointer.
+ * - count: The number of values.
+ * - bits: The width of every value in bits. Results of operations on the
+ *   vector are reduced modulo 2 raised to this number.
  *
- * Return: A big integer if the parsing succeeds and `NULL` if it fails.
- * "errno" is set to `EINVAL` when the string is malformed.
+ * Return: A pointer to the vector if the operation succeeds and NULL if it
+ * fails. If either argument is 0, "errno" is set to `EINVAL`.
  */
-bigint_st *bigint_strtobif(const char *str, const char **fraction)
+bigint_vec_st *bigint_vec_new(size_t count, size_t bits)
 {
-    bigint_st *dest;
-    bigint_st *result;
-    unsigned char value;
+    bigint_vec_st *vec;
 
-    const char *decimal = NULL;
-    const char *eom = NULL;
-    unsigned char base = 10;
-    bigint_st *exponent = NULL;
-    bool negative = false;
-
-    if (!(result = bigint_from_int(0))) {
+    if (!count || !bits) {
+        errno = EINVAL;
         return NULL;
     }
 
-    dest = result;
-
-    if (*str == '+') {
-        str++;
-    } else if (*str == '-') {
-        str++;
-        negative = true;
+    if (count > SIZE_MAX - VEC_LANES) {
+        errno = EOVERFLOW;
+        return NULL;
     }
 
-    if (*str == '0') {
-        switch (*++str) {
-          case 'b':
-          case 'B':
-            base = 2;
-            str++;
-            break;
+    if (!(vec = safe_calloc(1, sizeof(*vec)))) {
+        return NULL;
+    }
 
-          case 'o':
-          case 'O':
-            base = 8;
-            str++;
-            break;
+    vec->count = count;
+    vec->stride = CEIL_DIV(count, VEC_LANES) * VEC_LANES;
+    vec->length = CEIL_DIV(bits, DIGIT_BITS);
+    vec->bits = bits;
 
-          case 'x':
-          case 'X':
-            base = 16;
-            str++;
-            break;
+    if (vec->length > SIZE_MAX / vec->stride) {
+        errno = EOVERFLOW;
+        xfree(vec);
+        return NULL;
+    }
 
-          default:
-            // TODO: deal with 0e123
-            base = strchr(str, '.') ? 10 : 8;
-        }
-    }
-
-    for (; *str; str++) {
-        if (base == 10) {
-            if ((*str | 32) == 'e') {
-                if (exponent) {
-                    errno = EINVAL;
-                    goto error;
-                } else if (!(exponent = bigint_from_int(0))) {
-                    goto error;
-                } else {
-                    if (decimal) {
-                        eom = str - 1;
-                    }
+    if (!(vec->digits = digits_alloc(vec->length * vec->stride))) {
+        xfree(vec);
+        return NULL;
+    }
 
-                    dest = exponent;
-                    continue;
-                }
-            } else if (*str == '.') {
-                // A decimal point can only appear before the exponent and only
-                // once.
-                if (exponent || decimal) {
-                    errno = EINVAL;
-                    goto error;
-                }
+    memset(vec->digits, 0, vec->length * vec->stride * sizeof(digit_tt));
+    return vec;
+}
 
-                decimal = str;
-                continue;
-            }
-        }
+/**
+ * Release the memory used by a vector.
+ *
+ * Arguments:
+ * - vec: The vector to free.
+ */
+void bigint_vec_free(bigint_vec_st *vec)
+{
+    if (vec) {
+        digits_free(&(bigint_st) {
+            vec->digits, vec->length * vec->stride, 0, false, false
+        });
+        xfree(vec);
+    }
+}
 
-        if (*str >= '0' && *str <= '9') {
-            value = (unsigned char) *str - '0';
-        } else if ((*str | 32) >= 'a' && (*str | 32) <= 'z') {
-            value = (unsigned char) (*str | 32) - 'a' + 10;
-        } else {
-            errno = EINVAL;
-            goto error;
-        }
+/**
+ * Get the number of values in a vector.
+ *
+ * Arguments:
+ * - vec: A vector.
+ *
+ * Return: The number of values.
+ */
+size_t bigint_vec_count(const bigint_vec_st *vec)
+{
+    return vec->count;
+}
 
-        if (value >= base) {
-            errno = EINVAL;
-            goto error;
-        }
+/**
+ * Get the width in bits of the values of a vector.
+ *
+ * Arguments:
+ * - vec: A vector.
+ *
+ * Return: The number of bits.
+ */
+size_t bigint_vec_bits(const bigint_vec_st *vec)
+{
+    return vec->bits;
+}
 
-        // This loop only processes values to the left of any decimal point and
-        // in the exponent.
-        if (!decimal || exponent) {
-            if (!bigint_mul(dest, dest, small_number_cache[base])) {
-                goto error;
-            }
+/**
+ * Store a big integer in a vector. The value is reduced modulo 2 raised to
+ * the width of the vector, so negative values are stored in two's
+ * complement.
+ *
+ * Arguments:
+ * - vec: The vector.
+ * - index: Index of the value to replace.
+ * - x: The big integer.
+ *
+ * Return: 0 if the operation succeeds and -1 if the index is out of range, in
+ * which case "errno" is set to `EINVAL`.
+ */
+int bigint_vec_set(bigint_vec_st *vec, size_t index, const bigint_st *x)
+{
+    digit_tt digit;
 
-            if (!magnitude_sum(dest, dest, small_number_cache[value])) {
-                goto error;
-            }
-        }
-    }
+    digit_tt carry = x->negative;
 
-    // Fail if there's no exponent after "e" or "E".
-    if (exponent && (*(str - 1) | 32) == 'e') {
+    if (index >= vec->count) {
         errno = EINVAL;
-        goto error;
+        return -1;
     }
 
-    if (exponent && decimal /* && base == 10 */) {
-        if (!eom) {
-            eom = str - 1;
-        }
+    for (size_t d = 0; d < vec->length; d++) {
+        digit = d < x->length ? x->digits[d] : 0;
 
-        // Move end-of-mantissa marker to the last significant digit after the
-        // decimal point.
-        while (*eom == '0') {
-            eom--;
+        if (x->negative) {
+            digit = (digit_tt) (~digit + carry);
+            carry = carry && !digit;
         }
 
-        if (eom != decimal) {
-            decimal++;
-
-            while (bigint_nez(exponent) && decimal <= eom) {
-                if (bigint_dec(exponent) || !bigint_mul(result, result, TEN)) {
-                    goto error;
-                }
+        vec->digits[d * vec->stride + index] = digit;
+    }
 
-                value = (unsigned char) *decimal++ - '0';
+    vec->digits[(vec->length - 1) * vec->stride + index] &= vec_top_mask(vec);
+    return 0;
+}
 
-                if (!magnitude_sum(result, result, small_number_cache[value])) {
-                    goto error;
-                }
-            }
+/**
+ * Load a value of a vector into a big integer.
+ *
+ * Arguments:
+ * - dest: Destination of the value. If this is NULL, a new big integer is
+ *   allocated.
+ * - vec: The vector.
+ * - index: Index of the value.
+ *
+ * Return: A pointer to the big integer or NULL if the operation failed. If
+ * the index is out of range, "errno" is set to `EINVAL`.
+ */
+bigint_st *bigint_vec_get(
+    bigint_st *dest, const bigint_vec_st *vec, size_t index
+)
+{
+    bool free_dest_on_error = false;
 
-            if (fraction && decimal != eom) {
-                *fraction = decimal;
-            }
-        }
+    if (index >= vec->count) {
+        errno = EINVAL;
+        return NULL;
     }
 
-    normalize(result);
-
-    if (exponent) {
-        if (!bigint_pow(exponent, TEN, exponent)) {
-            goto error;
+    if (!dest) {
+        if (!(dest = bigint_from_int(0))) {
+            return NULL;
         }
 
-        if (!bigint_mul(result, result, exponent)) {
-            goto error;
+        free_dest_on_error = true;
+    }
+
+    if (resize(dest, vec->length)) {
+        if (free_dest_on_error) {
+            bigint_free(dest);
         }
 
-        bigint_free(exponent);
+        return NULL;
     }
 
-    if (bigint_nez(result)) {
-        result->negative = negative; // TODO: this used to be dest. Verify correct.
+    for (size_t d = 0; d < vec->length; d++) {
+        dest->digits[d] = vec->digits[d * vec->stride + index];
     }
 
-    return result;
+    dest->negative = false;
+    normalize(dest);
+    return dest;
+}
 
-error:
-    if (exponent) {
-        bigint_free(exponent);
+/**
+ * Add two vectors element-wise. The operands are zero-extended or truncated
+ * to the width of the destination, and the sums are reduced modulo 2 raised
+ * to that width.
+ *
+ * Arguments:
+ * - dest: Destination of the sums which may be the same as either operand.
+ * - a: The first addends.
+ * - b: The second addends.
+ *
+ * Return: 0 if the operation succeeds and -1 if the vectors do not hold the
+ * same number of values, in which case "errno" is set to `EINVAL`.
+ */
+int bigint_vec_add(
+    bigint_vec_st *dest, const bigint_vec_st *a, const bigint_vec_st *b
+)
+{
+    if (vec_check(dest, a, b)) {
+        return -1;
     }
 
-    bigint_free(dest);
-    return NULL;
+    vec_sum(dest, a, b, false);
+    return 0;
 }
 
-bigint_st *bigint_strtobi(const char *str)
+/**
+ * Subtract two vectors element-wise. The operands are zero-extended or
+ * truncated to the width of the destination, and the differences are reduced
+ * modulo 2 raised to that width, so they wrap around when `b` is larger.
+ *
+ * Arguments:
+ * - dest: Destination of the differences which may be the same as either
+ *   operand.
+ * - a: The minuends.
+ * - b: The subtrahends.
+ *
+ * Return: 0 if the operation succeeds and -1 if the vectors do not hold the
+ * same number of values, in which case "errno" is set to `EINVAL`.
+ */
+int bigint_vec_sub(
+    bigint_vec_st *dest, const bigint_vec_st *a, const bigint_vec_st *b
+)
 {
-    return bigint_strtobif(str, NULL);
+    if (vec_check(dest, a, b)) {
+        return -1;
+    }
+
+    vec_sum(dest, a, b, true);
+    return 0;
 }
 
 /**
- * Write a binary, octal, decimal or hexadecimal representation of a big
- * integer to a string buffer.
+ * Multiply two vectors element-wise with the schoolbook algorithm. The
+ * products are reduced modulo 2 raised to the width of the destination, and
+ * only the digits below that width are computed, so a destination twice as
+ * wide as the operands receives the full products.
  *
  * Arguments:
- * - buf: The destination buffer.
- * - buflen: The size of the destination buffer.
- * - x: The big integer to write.
- * - base: The base. This must be 2, 8, 10 or 16.
+ * - dest: Destination of the products which may be the same as either
+ *   operand.
+ * - a: The multiplicands.
+ * - b: The multipliers.
  *
- * Return: If the operation succeeds, the number of characters written
- * excluding the terminating NUL byte. If the operation fails, a negative value
- * is returned. The buffer being too short is treated as an error, so this
- * function will return negative value in that scenario.
+ * Return: 0 if the operation succeeds and -1 if it fails. If the vectors do
+ * not hold the same number of values, "errno" is set to `EINVAL`.
  */
-int bigint_snbprint(char *buf, size_t buflen, bigint_st *x, unsigned char base)
+int bigint_vec_mul(
+    bigint_vec_st *dest, const bigint_vec_st *a, const bigint_vec_st *b
+)
 {
-    char *number_start;
-    char hexoctbuf[33];
-    int result;
-
-    bigint_st *accumulator = NULL;
-    char *cursor = buf;
-    digit_tt numeral = 0;
-    bigint_st *remainder = NULL;
-    size_t written = 0;
+    digit_tt carry[VEC_LANES];
+    digit_tt *p;
+    digit_tt *product;
+    const digit_tt *x;
+    const digit_tt *y;
 
-    if (base != 2 && base != 8 && base != 10 && base != 16) {
-        errno = EINVAL;
-        return -1;
-    } else if (base != 10) {
-        if (buflen < 4 /* "0x", first digit, '\0' */ + x->negative) {
-            errno = ERANGE;
-            return -1;
-        }
+#ifdef DIGIT_SUPER_TYPE
+    digit_super_tt sum;
+#else
+    digit_tt high;
+    digit_tt low;
+#endif
 
-        if (base == 2) {
-            strcpy(buf, x->negative ? "-0b" : "0b");
-        } else if (base == 8) {
-            strcpy(buf, x->negative ? "-0o" : "0o");
-        } else if (base == 16) {
-            strcpy(buf, x->negative ? "-0x" : "0x");
-        }
+    size_t n = dest->length;
+    size_t an = a->length < n ? a->length : n;
 
-        written = 2 /* "0x" */ + x->negative;
-        cursor += written;
-    } else if (buflen < 2 /* len(first digit + '\0') */ + x->negative) {
-        errno = ERANGE;
+    if (vec_check(dest, a, b)) {
         return -1;
-    } else if (x->negative) {
-        *cursor++ = '-';
-        written++;
     }
 
-    if (bigint_eqz(x)) {
-        strcpy(cursor, "0");
-        written++;
-        return (int) written;
+    // The products of a block are accumulated in separate rows so the
+    // destination may be one of the operands.
+    if (!(product = digits_alloc(n * VEC_LANES))) {
+        return -1;
     }
 
-    number_start = cursor;
-
-    if (base == 8 || base == 16) {
-        for (size_t n = 0; n < x->length; n++) {
-            if (base == 8) {
-                result = sprintf(
-                    hexoctbuf, DIGIT_OCT_TEMPLATE, x->digits[x->length - n - 1]
-                );
-            } else if (base == 16) {
-                result = sprintf(
-                    hexoctbuf, DIGIT_HEX_TEMPLATE, x->digits[x->length - n - 1]
-                );
-            } else {
-                // This should be unreachable.
-                errno = EINVAL;
-                result = -1;
-            }
-
-            if (result < 0) {
-                return -1;
-            }
-
-            written += (size_t) result;
+    for (size_t first = 0; first < dest->stride; first += VEC_LANES) {
+        memset(product, 0, n * VEC_LANES * sizeof(digit_tt));
 
-            if (written + 1 > buflen) {
-                errno = ERANGE;
-                return -1;
-            }
+        for (size_t i = 0; i < an; i++) {
+            x = vec_row(a, i, first);
+            memset(carry, 0, sizeof(carry));
 
-            strcat(buf, hexoctbuf);
-        }
+            for (size_t j = 0; j < b->length && i + j < n; j++) {
+                y = vec_row(b, j, first);
+                p = product + (i + j) * VEC_LANES;
 
-        // Trim leading zeroes.
-        if (*number_start == '0') {
-            while (*++cursor == '0');
-            while ((*number_start++ = *cursor++));
-        }
-    } else if (!(accumulator = bigint_dup(x))) {
-        goto error;
-    } else if (base == 10 && !(remainder = bigint_from_int(0))) {
-        goto error;
-    } else {
-        while (bigint_nez(accumulator)) {
-            if (base == 10) {
-                if (!bigint_div(accumulator, &remainder, accumulator, TEN)) {
-                    goto error;
+                for (size_t k = 0; k < VEC_LANES; k++) {
+#ifdef DIGIT_SUPER_TYPE
+                    sum = (digit_super_tt) x[k] * y[k] + p[k] + carry[k];
+                    p[k] = (digit_tt) sum;
+                    carry[k] = (digit_tt) (sum >> DIGIT_BITS);
+#else
+                    u128fma64(&high, &low, x[k], y[k], carry[k]);
+                    u128add64(&high, &low, p[k]);
+                    p[k] = low;
+                    carry[k] = high;
+#endif
                 }
-
-                numeral = remainder->digits[0];
-            } else if (base == 2) {
-                numeral = accumulator->digits[0] & 1;
-                bigint_shri(accumulator, accumulator, 1);
-            } else {
-                // This should be unreachable.
-                errno = EINVAL;
-                goto error;
             }
 
-            if (written + 2 /* +1 for next char, +1 for NUL */ > buflen) {
-                errno = ERANGE;
-                goto error;
+            // The row above the last partial product has not been written
+            // by any earlier row.
+            if (i + b->length < n) {
+                memcpy(
+                    product + (i + b->length) * VEC_LANES,
+                    carry,
+                    sizeof(carry)
+                );
             }
-
-            *cursor++ = (char) ((numeral > 9 ? 'a' - 10 : '0') + numeral);
-            written++;
         }
 
-        *cursor = '\0';
-
-        if (remainder) {
-            bigint_free(remainder);
-        }
-
-        bigint_free(accumulator);
-
-        // Reverse the numerical part of the string because it's generated
-        // starting with the least significant digit.
-        for (char temp, *a = number_start, *b = cursor - 1; a < b; a++, b--) {
-            temp = *a;
-            *a = *b;
-            *b = temp;
+        for (size_t d = 0; d < n; d++) {
+            memcpy(
+                dest->digits + d * dest->stride + first,
+                product + d * VEC_LANES,
+                sizeof(carry)
+            );
         }
     }
 
-    return (int) written;
-
-error:
-    if (accumulator) {
-        bigint_free(accumulator);
-    }
-
-    if (remainder) {
-        bigint_free(remainder);
-    }
-
-    return -1;
-}
-
-/**
- * Write the decimal representation of a big integer to a string buffer.
- *
- * Arguments:
- * - buf: The destination buffer.
- * - buflen: The size of the destination buffer.
- * - x: The big integer to write.
- *
- * Return: If the operation succeeds, the number of characters written
- * excluding the terminating NUL byte. If the operation fails, a negative value
- * is returned. The buffer being too short is treated as an error, so this
- * function will return negative value in that scenario.
- */
-int bigint_snprint(char *buf, size_t buflen, bigint_st *x)
-{
-    return bigint_snbprint(buf, buflen, x, 10);
+    digits_free(&(bigint_st) {product, n * VEC_LANES, 0, false, false});
+    vec_truncate(dest);
+    return 0;
 }
 
 /**
- * Get a binary, octal, decimal or hexadecimal representation of a big
- * integer.
+ * Compare two vectors element-wise. Every digit of a block is compared for
+ * all of its values at once, starting with the most significant one, and the
+ * first difference of each value is kept without branching.
  *
  * Arguments:
- * - buf: The destination buffer.
- * - buflen: The size of the destination buffer.
- * - x: The big integer to write.
- * - base: The base. This must be 2, 8, 10 or 16.
+ * - results: Output array with one entry per value, which is set to a
+ *   negative number if the value of `a` is less than that of `b`, a positive
+ *   number if it is greater and 0 if they are equal.
+ * - a: The first vector.
+ * - b: The second vector.
  *
- * Return: If the operation succeeds, a heap-allocated string is retuned that
- * the caller must free. If the operation fails, NULL is returned.
+ * Return: 0 if the operation succeeds and -1 if the vectors do not hold the
+ * same number of values, in which case "errno" is set to `EINVAL`.
  */
-char *bigint_tostrb(bigint_st *x, unsigned char base)
+int bigint_vec_cmp(
+    int *results, const bigint_vec_st *a, const bigint_vec_st *b
+)
 {
-    char *buffer;
-    size_t bits_per_numeral;
-    size_t max_length;
-
-    size_t bits_in_value = DIGIT_BITS * (x->length != 0 ? x->length : 1);
-
-    switch (base) {
-      case 2:
-        bits_per_numeral = 1;
-        break;
-
-      case 8:
-      case 10:
-        bits_per_numeral = 3;
-        break;
+    int block[VEC_LANES];
+    size_t lanes;
+    const digit_tt *x;
+    const digit_tt *y;
 
-      case 16:
-        bits_per_numeral = 4;
-        break;
+    size_t n = a->length > b->length ? a->length : b->length;
 
-      default:
+    if (a->count != b->count) {
         errno = EINVAL;
-        return NULL;
+        return -1;
     }
 
-    max_length = (
-        x->negative +                               // '-'
-        (base == 10 ? 0 : 2) +                      // "0b"/"0o/"0x"
-        CEIL_DIV(bits_in_value, bits_per_numeral) + // Space for numerals
-        1                                           // '\0'
-    );
+    for (size_t first = 0; first < a->stride; first += VEC_LANES) {
+        memset(block, 0, sizeof(block));
 
-    if (!(buffer = malloc(max_length))) {
-        return NULL;
-    }
+        for (size_t d = n; d-- > 0; ) {
+            x = vec_row(a, d, first);
+            y = vec_row(b, d, first);
 
-    if (bigint_snbprint(buffer, max_length, x, base) < 0) {
-        xfree(buffer);
-        return NULL;
+            for (size_t k = 0; k < VEC_LANES; k++) {
+                block[k] = block[k] ? block[k] : (x[k] > y[k]) - (x[k] < y[k]);
+            }
+        }
+
+        lanes = a->count - first < VEC_LANES ? a->count - first : VEC_LANES;
+        memcpy(results + first, block, lanes * sizeof(int));
     }
 
-    return buffer;
+    return 0;
 }
 
 /**
- * Get the decimal representation of a big integer.
+ * Extend the digits of a value of an array in place. This is only possible
+ * when they are the last digits handed out by the current slab and the slab
+ * has room for the rest.
  *
- * - x: A big integer.
+ * Arguments:
+ * - array: The array.
+ * - value: A value of the array.
+ * - length: The number of digits needed.
  *
- * Return: If the operation succeeds, a heap-allocated string is retuned that
- * the caller must free. If the operation fails, NULL is returned.
+ * Return: Value indicating whether the digits were extended.
  */
-char *bigint_tostr(bigint_st *x)
+static bool array_extend(
+    bigint_array_st *array, bigint_st *value, size_t length
+)
 {
-    return bigint_tostrb(x, 10);
+    array_slab_st *slab = array->slabs;
+
+    if (
+        !slab ||
+        value->digits + value->allocated != slab->digits + slab->used ||
+        length - value->allocated > slab->size - slab->used
+    ) {
+        return false;
+    }
+
+    slab->used += length - value->allocated;
+    value->allocated = length;
+    return true;
 }
 
 /**
- * Compute the logarithm of a big integer with the base specified as a standard
- * unsigned integer.
+ * Take digits for a value from the slabs of an array, adding a slab if
+ * there is not enough room in the current one.
  *
  * Arguments:
- * - dest: Output destination. If this is NULL, it will be allocated.
- * - x: Value for which the logarithm should be computed.
- * - base: Logarithm base.
+ * - array: The array.
+ * - length: The number of digits.
  *
- * Return: A pointer to the absolute value or NULL if the function failed. If
- * the base is less than two, this function will fail with errno set to EDOM.
+ * Return: A pointer to the digits or NULL if a slab could not be allocated.
  */
-bigint_st *bigint_logui(bigint_st *dest, bigint_st *x, uintmax_t base)
+static digit_tt *array_reserve(bigint_array_st *array, size_t length)
 {
-    bigint_st *base_bi;
-    bigint_st *product;
-    uintmax_t floor_log2;
-    uintmax_t ratio;
-    uintmax_t power;
-    int cmp;
-
-    bool free_dest_on_error = false;
+    array_slab_st *slab = array->slabs;
 
-    if (bigint_lez(x) || base < 2) {
-        errno = EDOM;
-        return NULL;
+    if (slab && length <= slab->size - slab->used) {
+        slab->used += length;
+        return slab->digits + slab->used - length;
     }
 
-    if (!dest) {
-        dest = bigint_from_int(0);
-        free_dest_on_error = true;
+    if (!(slab = safe_calloc(1, sizeof(*slab)))) {
+        return NULL;
     }
 
-    if (POWER_OF_2(base)) {
-        if (SIZE_MAX / x->length < DIGIT_BITS) {
-            errno = ERANGE;
-            return NULL;
-        }
-
-        floor_log2 = DIGIT_BITS * x->length - clz(x) - 1;
-
-        if (floor_log2 > INTMAX_MAX) {
-            errno = ERANGE;
-            return NULL;
-        }
+    slab->size = length > ARRAY_SLAB_DIGITS ? length : ARRAY_SLAB_DIGITS;
+    slab->used = length;
 
-        for (ratio = 1; base > 2; ratio++) {
-            base /= 2;
-        }
+    if (!(slab->digits = digits_alloc(slab->size))) {
+        xfree(slab);
+        return NULL;
+    }
 
-        return bigint_from_uint(floor_log2 / ratio);
+    // A slab holding a single large value is put behind the current slab so
+    // the room left in the current one is still used.
+    if (array->slabs && slab->size == length) {
+        slab->next = array->slabs->next;
+        array->slabs->next = slab;
     } else {
-        base_bi = bigint_from_uint(base);
-
-        if (!base_bi) {
-            return NULL;
-        }
-
-        product = bigint_from_int(1);
-
-        if (!product) {
-            goto error;
-        }
+        slab->next = array->slabs;
+        array->slabs = slab;
+    }
 
-        for (power = 0; (cmp = magnitude_cmp(x, product)) > 0; power++) {
-            if (power == UINTMAX_MAX) {
-                errno = ERANGE;
-                goto error_after_product_alloc;
-            } else if (!bigint_mul(product, product, base_bi)) {
-                goto error_after_product_alloc;
-            }
-        }
+    return slab->digits;
+}
 
-        if (cmp == 0 && magnitude_inc(product)) {
-            goto error_after_product_alloc;
-        }
+/**
+ * Create an empty array of big integers. Storing many values in an array
+ * instead of allocating each one separately packs their digits into a few
+ * large slabs that are released all at once, and keeps values that are
+ * traversed in order next to each other in memory.
+ *
+ * Return: A pointer to the array if the operation succeeds and NULL if it
+ * fails.
+ */
+bigint_array_st *bigint_array_new(void)
+{
+    bigint_array_st *array = safe_calloc(1, sizeof(bigint_array_st));
 
-        bigint_movui(dest, power);
-        bigint_free(product);
-        bigint_free(base_bi);
-        return dest;
+    if (array) {
+        *array = (bigint_array_st) {NULL, 0, 0, NULL};
+    }
 
-error_after_product_alloc:
-        bigint_free(product);
+    return array;
+}
 
-error:
-        bigint_free(base_bi);
+/**
+ * Release an array and every value in it. This frees the slabs that hold the
+ * digits and the array of values, so the cost does not depend on the number
+ * of values.
+ *
+ * Arguments:
+ * - array: The array to free.
+ */
+void bigint_array_free(bigint_array_st *array)
+{
+    array_slab_st *next;
 
-        if (free_dest_on_error) {
-            bigint_free(dest);
-        }
+    if (!array) {
+        return;
+    }
 
-        return NULL;
+    for (array_slab_st *slab = array->slabs; slab; slab = next) {
+        next = slab->next;
+        digits_free(&(bigint_st) {slab->digits, slab->size, 0, false, false});
+        xfree(slab);
     }
+
+    xfree(array->values);
+    xfree(array);
 }
 
 /**
- * Compute the absolute value of a big integer.
+ * Get the number of values in an array.
  *
  * Arguments:
- * - dest: Output destination. If this is NULL, it will be allocated.
- * - x: Target value.
+ * - array: An array.
  *
- * Return: A pointer to the absolute value or NULL if the function failed.
+ * Return: The number of values.
  */
-bigint_st *bigint_abs(bigint_st *dest, bigint_st *x)
+size_t bigint_array_count(const bigint_array_st *array)
 {
-    if (dest != x) {
-        if (!dest) {
-            dest = bigint_dup(x);
-        } else if (bigint_mov(dest, x)) {
-            dest = NULL;
-        }
-    }
+    return array->count;
+}
 
-    if (dest) {
-        dest->negative = false;
+/**
+ * Get a value of an array. The value may be passed as an operand to any
+ * other function, but it must not be used as a destination or freed; it is
+ * changed with "bigint_array_set". The pointer is valid until a value is
+ * added to the array, so values should be referred to by their index.
+ *
+ * Arguments:
+ * - array: An array.
+ * - index: Index of the value.
+ *
+ * Return: A pointer to the value or NULL if the index is out of range, in
+ * which case "errno" is set to `EINVAL`.
+ */
+bigint_st *bigint_array_get(bigint_array_st *array, size_t index)
+{
+    if (index >= array->count) {
+        errno = EINVAL;
+        return NULL;
     }
 
-    return dest;
+    return array->values + index;
 }
 
 /**
- * Get the greatest common denominator of two big integers.
+ * Replace a value of an array with a copy of a big integer. The digits are
+ * overwritten in place when the new value fits in the space of the old one
+ * or that space can be extended at the end of the current slab. Otherwise
+ * new space is taken from the slabs, and the old space is only reclaimed
+ * when the array is freed.
  *
  * Arguments:
- * - a: A big integer.
- * - b: A big integer.
+ * - array: An array.
+ * - index: Index of the value to replace.
+ * - x: The new value, which may be a value of the same array.
  *
- * Return: A pointer to the destination if the operation succeeded or NULL if
- * it failed.
+ * Return: 0 if the operation succeeds and -1 if it fails. If the index is
+ * out of range, "errno" is set to `EINVAL`.
  */
-bigint_st *bigint_gcd(bigint_st *dest, bigint_st *a, bigint_st* b)
+int bigint_array_set(bigint_array_st *array, size_t index, const bigint_st *x)
 {
-    size_t a_zeroes;
-    size_t b_zeroes;
-    size_t common_zeroes;
-    bigint_st *temp;
-
-    bool free_dest_on_error = false;
+    digit_tt *digits;
+    bigint_st *value;
 
-    if (!(a = bigint_dup(a))) {
-        return NULL;
+    if (index >= array->count) {
+        errno = EINVAL;
+        return -1;
     }
 
-    if (!(b = bigint_dup(b))) {
-        goto error_after_a_dup;
-    }
+    value = array->values + index;
 
-    if (!dest) {
-        if (!(dest = bigint_from_int(0))) {
-            goto error_after_b_dup;
+    if (
+        x->length > value->allocated &&
+        !array_extend(array, value, x->length)
+    ) {
+        if (!(digits = array_reserve(array, x->length))) {
+            return -1;
         }
 
-        free_dest_on_error = true;
+        value->digits = digits;
+        value->allocated = x->length;
     }
 
-    // This function was adapted from
-    // <https://en.wikipedia.org/w/index.php?title=Binary_GCD_algorithm&oldid=1203806811#Implementation>.
-    a->negative = false;
-    b->negative = false;
+    memmove(value->digits, x->digits, x->length * sizeof(digit_tt));
+    value->length = x->length;
+    value->negative = x->negative;
+    return 0;
+}
 
-    if (bigint_eqz(a)) {
-        if (bigint_mov(dest, b)) {
-            goto error_after_dest_alloc;
-        }
-    } else if (bigint_eqz(b)) {
-        if (bigint_mov(dest, a)) {
-            goto error_after_dest_alloc;
+/**
+ * Append a copy of a big integer to an array.
+ *
+ * Arguments:
+ * - array: An array.
+ * - x: The value to append, which may be a value of the same array.
+ *
+ * Return: 0 if the operation succeeds and -1 if it fails.
+ */
+int bigint_array_push(bigint_array_st *array, const bigint_st *x)
+{
+    digit_tt *digits;
+    size_t index;
+    bigint_st *values;
+
+    size_t capacity = array->capacity ? array->capacity * 2 : 16;
+    size_t source = SIZE_MAX;
+
+    if (array->count == array->capacity) {
+        // Values that are being appended from the same array move with it,
+        // so they are found again by their index once it is reallocated.
+        if (
+            array->count &&
+            x >= array->values && x < array->values + array->count
+        ) {
+            source = (size_t) (x - array->values);
         }
-    } else {
-        a_zeroes = ctz(a);
-        b_zeroes = ctz(b);
-        common_zeroes = a_zeroes < b_zeroes ? a_zeroes : b_zeroes;
 
-        if (!bigint_shri(a, a, a_zeroes)) {
-            goto error_after_dest_alloc;
+        if (!(values = safe_reallocarray(
+            array->values, capacity, sizeof(bigint_st)
+        ))) {
+            return -1;
         }
 
-        if (!bigint_shri(b, b, b_zeroes)) {
-            goto error_after_dest_alloc;
+        if (source != SIZE_MAX) {
+            x = values + source;
         }
 
-        while (1) {
-            if (magnitude_cmp(a, b) > 0) {
-                temp = a;
-                a = b;
-                b = temp;
-            }
+        array->values = values;
+        array->capacity = capacity;
+    }
 
-            MAGNITUDE_RDELTA(b, a);
+    // Every value gets at least one digit so its digits are never NULL.
+    if (!(digits = array_reserve(array, x->length ? x->length : 1))) {
+        return -1;
+    }
 
-            if (bigint_eqz(b)) {
-                if (bigint_shli(dest, a, common_zeroes)) {
-                    break;
-                }
+    index = array->count++;
+    array->values[index] = (bigint_st) {
+        digits, x->length ? x->length : 1, 0, false, true
+    };
+    return bigint_array_set(array, index, x);
+}
 
-                goto error_after_dest_alloc;
-            }
+/**
+ * Sort the values of an array in ascending order with "bigint_sort". Only
+ * the headers of the values are reordered, so their digits stay where they
+ * are in the slabs.
+ *
+ * Arguments:
+ * - array: An array.
+ *
+ * Return: 0 if the operation succeeds and -1 if it fails.
+ */
+int bigint_array_sort(bigint_array_st *array)
+{
+    bigint_st **order;
+    bigint_st *values;
 
-            if (!bigint_shri(b, b, ctz(b))) {
-                goto error_after_dest_alloc;
-            }
-        }
+    int status = -1;
+
+    if (array->count < 2) {
+        return 0;
     }
 
-    bigint_free(b);
-    bigint_free(a);
-    return dest;
+    if (!(order = safe_calloc(array->count, sizeof(*order)))) {
+        return -1;
+    }
 
-error_after_dest_alloc:
-    if (free_dest_on_error) {
-        bigint_free(dest);
+    if (!(values = safe_calloc(array->capacity, sizeof(*values)))) {
+        goto done;
     }
 
-error_after_b_dup:
-    bigint_free(b);
+    for (size_t i = 0; i < array->count; i++) {
+        order[i] = array->values + i;
+    }
 
-error_after_a_dup:
-    bigint_free(a);
+    if (bigint_sort(order, array->count)) {
+        xfree(values);
+        goto done;
+    }
 
-    return NULL;
+    for (size_t i = 0; i < array->count; i++) {
+        values[i] = *order[i];
+    }
+
+    xfree(array->values);
+    array->values = values;
+    status = 0;
+
+done:
+    xfree(order);
+    return status;
 }
@@ -38,12 +38,114 @@ typedef DIGIT_SUPER_TYPE digit_super_tt;
 #endif
 
 typedef struct bigint_st bigint_st;
+typedef struct bigint_vec_st bigint_vec_st;
+typedef struct bigint_array_st bigint_array_st;
+
+/*
+ * Ways in which "bigint_divmod" rounds the quotient.
+ */
+typedef enum {
+    /* Toward zero, like the "/" operator of C. */
+    BIGINT_ROUND_TRUNC,
+    /* Toward negative infinity. */
+    BIGINT_ROUND_FLOOR,
+    /* Toward positive infinity. */
+    BIGINT_ROUND_CEIL,
+    /* So that the remainder is never negative. */
+    BIGINT_ROUND_EUCLID,
+} bigint_round_tt;
+
+/*
+ * Operations counted when the library is built with COLLECT_STATS. Each one
+ * covers a public function and its variants, e.g. "strtobi" also counts
+ * "bigint_strtobif", "bigint_strntobi" and "bigint_strtobib". Every use of
+ * this list passes a macro that is expanded once per operation name.
+ */
+#define BIGINT_STATS_OPERATIONS(X) \
+    X(mov) \
+    X(dup) \
+    X(cmp) \
+    X(inc) \
+    X(dec) \
+    X(add) \
+    X(sub) \
+    X(mul) \
+    X(addmul) \
+    X(div) \
+    X(mod) \
+    X(pow) \
+    X(gcd) \
+    X(logui) \
+    X(shli) \
+    X(shri) \
+    X(tod) \
+    X(strtobi) \
+    X(strntobiv) \
+    X(tostr) \
+    X(tostrv)
+
+/*
+ * Counters of a single operation.
+ */
+typedef struct {
+    /* Number of calls including those made by other library functions. */
+    uint64_t calls;
+    /* Total number of digits in the big integer operands of every call. */
+    uint64_t digits;
+} bigint_operation_stats_st;
+
+/*
+ * Counters kept for each thread when the library is built with COLLECT_STATS.
+ */
+typedef struct {
+#define BIGINT_STATS_MEMBER(name) bigint_operation_stats_st name;
+    BIGINT_STATS_OPERATIONS(BIGINT_STATS_MEMBER)
+#undef BIGINT_STATS_MEMBER
+    /* Number of new blocks of memory allocated. */
+    uint64_t allocations;
+    /* Number of blocks of memory reallocated. */
+    uint64_t reallocations;
+    /* Total size in bytes of the allocations and reallocations. */
+    uint64_t bytes;
+    /* Number of blocks of memory freed. */
+    uint64_t frees;
+    /* Number of times the digits of a number had to grow. */
+    uint64_t resizes;
+} bigint_stats_st;
+
+/*
+ * An operation reported to the hook set with "bigint_set_trace".
+ */
+typedef struct {
+    /* Name of the operation as it appears in "BIGINT_STATS_OPERATIONS". */
+    const char *operation;
+    /* Number of digits in each big integer operand, 0 if there is none. */
+    size_t operands[2];
+    /* Number of digits in the result, 0 if there is no big integer result. */
+    size_t result;
+    /* Time the operation took in seconds. */
+    double seconds;
+} bigint_trace_st;
+
+/*
+ * Function called with a reported operation and the context given to
+ * "bigint_set_trace".
+ */
+typedef void (*bigint_trace_ft)(const bigint_trace_st *, void *);
 
 // Memory Management
 int bigint_init(void);
 void bigint_cleanup(void);
 void bigint_free(bigint_st *);
+void bigint_freev(bigint_st **);
 bigint_st *bigint_dup(bigint_st *);
+void bigint_set_power_cache_limit(size_t);
+size_t bigint_power_cache_usage(void);
+void bigint_set_memory_limit(size_t);
+size_t bigint_memory_usage(void);
+int bigint_set_threshold(const char *, size_t);
+size_t bigint_get_threshold(const char *);
+int bigint_set_threads(unsigned);
 
 // Initialization and Assignments
 void bigint_movi(bigint_st *, intmax_t);
@@ -51,12 +153,22 @@ void bigint_movui(bigint_st *, uintmax_t);
 int bigint_mov(bigint_st *, bigint_st *);
 bigint_st *bigint_from_int(intmax_t);
 bigint_st *bigint_from_uint(uintmax_t);
+bigint_st *bigint_from_double(double);
 
 // Arithmetic and Bitwise Operations
 bigint_st *bigint_div(bigint_st *, bigint_st **, bigint_st *, bigint_st *);
+int bigint_divmod(
+    bigint_st *, bigint_st *, bigint_st *, bigint_st *, bigint_round_tt
+);
+bigint_st *bigint_divexact(bigint_st *, bigint_st *, bigint_st *);
+bigint_st *bigint_divexactui(bigint_st *, bigint_st *, uintmax_t);
 bigint_st *bigint_add(bigint_st *, bigint_st *, bigint_st *);
 bigint_st *bigint_sub(bigint_st *dest, bigint_st *a, bigint_st *b);
 bigint_st *bigint_mul(bigint_st *, bigint_st *, bigint_st *);
+bigint_st *bigint_addmul(bigint_st *, bigint_st *, bigint_st *);
+bigint_st *bigint_submul(bigint_st *, bigint_st *, bigint_st *);
+bigint_st *bigint_addmului(bigint_st *, bigint_st *, uintmax_t);
+bigint_st *bigint_submului(bigint_st *, bigint_st *, uintmax_t);
 bigint_st *bigint_shli(bigint_st *, bigint_st *, size_t);
 bigint_st *bigint_shl(bigint_st *, bigint_st *, bigint_st*);
 bigint_st *bigint_shri(bigint_st *, bigint_st *, size_t);
@@ -71,12 +183,26 @@ int bigint_dec(bigint_st *);
 uintmax_t bigint_toui(bigint_st *);
 intmax_t bigint_toi(bigint_st *);
 double bigint_tod(bigint_st *);
+double bigint_tod_2exp(size_t *, bigint_st *);
 bigint_st *bigint_strtobif(const char *str, const char **fraction);
 bigint_st *bigint_strtobi(const char *);
+bigint_st *bigint_strntobi(const char *, size_t, const char **);
+bigint_st **bigint_strntobiv(size_t *, const char *, size_t, char, unsigned);
+bigint_st *bigint_strtobib(const char *, unsigned char);
+size_t bigint_sizeinbase(bigint_st *, unsigned char);
+size_t bigint_sizeinbase_bound(bigint_st *, unsigned char);
 int bigint_snbprint(char *, size_t, bigint_st *, unsigned char);
 int bigint_snprint(char *, size_t, bigint_st *);
+char *bigint_snbprintr(char *, size_t, bigint_st *, unsigned char);
 char *bigint_tostrb(bigint_st *, unsigned char);
 char *bigint_tostr(bigint_st *);
+int bigint_snbprintv(
+    char *, size_t, size_t *, bigint_st **, size_t, unsigned char, const char *,
+    unsigned
+);
+char *bigint_tostrbv(
+    size_t *, bigint_st **, size_t, unsigned char, const char *, unsigned
+);
 
 // Comparators
 int bigint_cmp(const bigint_st *, const bigint_st *);
@@ -88,9 +214,43 @@ bool bigint_gtz(const bigint_st *);
 bool bigint_gez(const bigint_st *);
 bigint_st *bigint_max(bigint_st *, bigint_st *);
 bigint_st *bigint_min(bigint_st *, bigint_st *);
+int bigint_sort(bigint_st **, size_t);
+uint64_t bigint_hash(const bigint_st *, uint64_t);
 
 // Miscellaneous
 bigint_st *bigint_logui(bigint_st *, bigint_st *, uintmax_t);
 bigint_st *bigint_gcd(bigint_st *, bigint_st *, bigint_st *);
 bool bigint_is_power_of_2(bigint_st *);
+
+// Vectors
+bigint_vec_st *bigint_vec_new(size_t, size_t);
+void bigint_vec_free(bigint_vec_st *);
+size_t bigint_vec_count(const bigint_vec_st *);
+size_t bigint_vec_bits(const bigint_vec_st *);
+int bigint_vec_set(bigint_vec_st *, size_t, const bigint_st *);
+bigint_st *bigint_vec_get(bigint_st *, const bigint_vec_st *, size_t);
+int bigint_vec_add(
+    bigint_vec_st *, const bigint_vec_st *, const bigint_vec_st *
+);
+int bigint_vec_sub(
+    bigint_vec_st *, const bigint_vec_st *, const bigint_vec_st *
+);
+int bigint_vec_mul(
+    bigint_vec_st *, const bigint_vec_st *, const bigint_vec_st *
+);
+int bigint_vec_cmp(int *, const bigint_vec_st *, const bigint_vec_st *);
+
+// Arrays
+bigint_array_st *bigint_array_new(void);
+void bigint_array_free(bigint_array_st *);
+size_t bigint_array_count(const bigint_array_st *);
+bigint_st *bigint_array_get(bigint_array_st *, size_t);
+int bigint_array_set(bigint_array_st *, size_t, const bigint_st *);
+int bigint_array_push(bigint_array_st *, const bigint_st *);
+int bigint_array_sort(bigint_array_st *);
+
+// Instrumentation
+int bigint_stats_get(bigint_stats_st *);
+void bigint_stats_reset(void);
+void bigint_set_trace(bigint_trace_ft, void *, size_t, double);
 #endif
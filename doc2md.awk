@@ -32,6 +32,25 @@ inside_doc && /^ \*\/$/ {
     inside_doc = 0
 }
 
+# Parameters of a signature that is wrapped over several lines are joined
+# into a single line.
+signature {
+    line = $0
+    sub(/^ +/, "", line)
+
+    if (line ~ /^\)/ || signature ~ /\($/) {
+        signature = signature line
+    } else {
+        signature = signature " " line
+    }
+
+    if (line ~ /^\)/) {
+        add_entry()
+    }
+
+    next
+}
+
 NF == 0 || $1 == "{" {
     buffer = ""
 }
@@ -44,12 +63,11 @@ FILENAME ~ /\.c$/ && /^[a-z].*bigint_[a-z0-9_]+\(/ {
     }
 
     name = substr($0, RSTART, RLENGTH - 1)
-    entries[name] = sprintf( \
-        "### %s ###\n\n**Signature:** `%s`\n\n**Description:**\n%s", \
-        name, $0, buffer \
-    )
+    signature = $0
 
-    buffer = ""
+    if ($0 !~ /\($/) {
+        add_entry()
+    }
 }
 
 FILENAME ~ /\.h/ {
@@ -67,3 +85,13 @@ FILENAME ~ /\.h/ {
         }
     }
 }
+
+function add_entry() {
+    entries[name] = sprintf( \
+        "### %s ###\n\n**Signature:** `%s`\n\n**Description:**\n%s", \
+        name, signature, buffer \
+    )
+
+    buffer = ""
+    signature = ""
+}
@@ -0,0 +1,2197 @@
+/**
+ * Differential fuzzer for the public big integer functions. Each input is
+ * read as a program that loads values into a small set of registers and
+ * applies operations to them. Operations run with every algorithm threshold
+ * lowered so that small operands reach the faster algorithms, and the result
+ * of every operation is checked three ways: against the same operation
+ * computed with every threshold raised so that only the simplest algorithms
+ * run, against algebraic identities that relate it to other operations, and,
+ * when the program is built with USE_GMP, against the GNU Multiple Precision
+ * Arithmetic Library. A mismatch is written to standard error and the
+ * program aborts.
+ *
+ * The program can be built as a libFuzzer target by defining LIBFUZZER:
+ *
+ *     clang -fsanitize=fuzzer,address -DLIBFUZZER fuzz.c bigint.c -pthread -lm
+ *
+ * Otherwise it is a standalone program that replays the files named on the
+ * command line or runs pseudo-random inputs. "fuzz.sh" builds and runs the
+ * standalone program for every supported digit width.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef USE_GMP
+#include <gmp.h>
+#endif
+
+#include "bigint.h"
+
+/**
+ * Number of registers the operations read and write.
+ */
+#define REGISTERS 4
+
+/**
+ * Maximum number of bytes in a loaded value.
+ */
+#define MAX_LOAD_BYTES 96
+
+/**
+ * Maximum number of hexadecimal numerals in the result of an operation.
+ * Operations whose result could be larger are skipped so that inputs that
+ * repeatedly square a value stay fast.
+ */
+#define MAX_RESULT_NUMERALS 8192
+
+/**
+ * Maximum number of temporary values that an operation may keep.
+ */
+#define MAX_TEMPORARIES 64
+
+/**
+ * Number of values sorted by the sort operation, which is enough for the
+ * radix passes of "bigint_sort" to run before it switches to insertion sort.
+ */
+#define SORT_VALUES 48
+
+/**
+ * Number of values appended to an array by the array operation, which is
+ * enough for it to grow.
+ */
+#define ARRAY_VALUES 16
+
+/**
+ * Number of single-digit fields in the batch parsed by the memory parsing
+ * operation. "fuzz.sh" lowers BATCH_RANGE_MIN so that even a batch this small
+ * is split between threads.
+ */
+#define BATCH_FIELDS 256
+
+/**
+ * Separator used by the batch operations.
+ */
+#define SEPARATOR ","
+
+/**
+ * Number of threads that may work on a single multiplication.
+ */
+#define THREADS 4
+
+/**
+ * Unread part of an input.
+ */
+typedef struct {
+    /**
+     * The next byte.
+     */
+    const uint8_t *data;
+    /**
+     * The number of bytes left.
+     */
+    size_t size;
+} input_st;
+
+/**
+ * An operation applied to the registers.
+ */
+typedef struct {
+    /**
+     * Name written when the operation fails a check.
+     */
+    const char *name;
+    /**
+     * Function that reads its arguments from the input, performs the
+     * operation and checks the result.
+     */
+    void (*run)(input_st *);
+} operation_st;
+
+/**
+ * Operations reported to the trace hook.
+ */
+typedef struct {
+    /**
+     * Number of reported operations.
+     */
+    size_t calls;
+    /**
+     * The last reported operation.
+     */
+    bigint_trace_st event;
+} trace_st;
+
+/**
+ * A threshold that selects a faster algorithm once operands are large enough.
+ */
+typedef struct {
+    /**
+     * Name passed to "bigint_set_threshold".
+     */
+    const char *name;
+    /**
+     * Value used outside of the reference computations. It is low enough
+     * that the small operands of the fuzzer reach the faster algorithm.
+     */
+    size_t value;
+} threshold_st;
+
+/**
+ * Thresholds of the library. Setting all of them to `SIZE_MAX` leaves only
+ * the simplest algorithms.
+ */
+static const threshold_st thresholds[] = {
+    {"parse_dc", 2},
+    {"print_dc", 2},
+    {"mul_karatsuba", 1},
+    {"mul_parallel", 8},
+    {"mul_ntt", 4},
+    {"convert_parallel", 4},
+};
+
+/**
+ * Limits of the cache of powers in bytes used by the conversions.
+ */
+static const size_t cache_limits[] = {0, 4096, 16 * 1024 * 1024};
+
+/**
+ * Registers holding the values of the current input.
+ */
+static bigint_st *registers[REGISTERS];
+
+/**
+ * Values freed when the current operation finishes.
+ */
+static bigint_st *temporaries[MAX_TEMPORARIES];
+
+/**
+ * Number of values in "temporaries".
+ */
+static size_t temporary_count;
+
+/**
+ * Name of the operation being checked.
+ */
+static const char *current;
+
+/**
+ * Operands of the operation being checked, written when a check fails.
+ */
+static bigint_st *operands[2];
+
+/**
+ * Read a byte from an input. Exhausted inputs read as zeroes.
+ *
+ * Arguments:
+ * - in: The input.
+ *
+ * Return: The byte.
+ */
+static uint8_t next_byte(input_st *in)
+{
+    if (!in->size) {
+        return 0;
+    }
+
+    in->size--;
+    return *in->data++;
+}
+
+/**
+ * Write a value to standard error in hexadecimal.
+ *
+ * Arguments:
+ * - label: Text written before the value.
+ * - x: The value.
+ */
+static void dump(const char *label, bigint_st *x)
+{
+    char *text = x ? bigint_tostrb(x, 16) : NULL;
+
+    fprintf(stderr, "  %s: %s\n", label, x ? (text ? text : "?") : "NULL");
+    free(text);
+}
+
+/**
+ * Report a failed check and abort.
+ *
+ * Arguments:
+ * - what: Description of the check.
+ * - expected: Optional expected value.
+ * - actual: Optional actual value.
+ */
+static void fail(const char *what, bigint_st *expected, bigint_st *actual)
+{
+    fprintf(
+        stderr, "fuzz: DIGIT_WIDTH %d: %s: %s\n", DIGIT_WIDTH, current, what
+    );
+
+    for (size_t i = 0; i < sizeof(operands) / sizeof(operands[0]); i++) {
+        if (operands[i]) {
+            dump(i ? "b" : "a", operands[i]);
+        }
+    }
+
+    if (expected || actual) {
+        dump("expected", expected);
+        dump("actual", actual);
+    }
+
+    abort();
+}
+
+/**
+ * Fail unless a condition holds.
+ *
+ * Arguments:
+ * - condition: The condition.
+ * - what: Description of the check.
+ */
+static void expect(bool condition, const char *what)
+{
+    if (!condition) {
+        fail(what, NULL, NULL);
+    }
+}
+
+/**
+ * Fail unless two values are equal.
+ *
+ * Arguments:
+ * - expected: The expected value.
+ * - actual: The actual value.
+ * - what: Description of the check.
+ */
+static void expect_equal(
+    bigint_st *expected, bigint_st *actual, const char *what
+)
+{
+    if (!expected || !actual || bigint_cmp(expected, actual)) {
+        fail(what, expected, actual);
+    }
+}
+
+/**
+ * Free a value when the current operation finishes. Functions that are
+ * expected to succeed are wrapped in this, so a failure is reported here.
+ *
+ * Arguments:
+ * - x: The value returned by a library function.
+ *
+ * Return: The value.
+ */
+static bigint_st *keep(bigint_st *x)
+{
+    if (!x) {
+        fail(strerror(errno), NULL, NULL);
+    }
+
+    if (temporary_count == MAX_TEMPORARIES) {
+        fail("too many temporaries", NULL, NULL);
+    }
+
+    temporaries[temporary_count++] = x;
+    return x;
+}
+
+/**
+ * Free the temporary values of the current operation.
+ */
+static void release(void)
+{
+    while (temporary_count) {
+        bigint_free(temporaries[--temporary_count]);
+    }
+}
+
+/**
+ * Select whether the simplest algorithms are used regardless of the size of
+ * the operands.
+ *
+ * Arguments:
+ * - enabled: Value indicating whether the simplest algorithms are used.
+ */
+static void use_reference(bool enabled)
+{
+    for (size_t i = 0; i < sizeof(thresholds) / sizeof(thresholds[0]); i++) {
+        if (bigint_set_threshold(
+            thresholds[i].name, enabled ? SIZE_MAX : thresholds[i].value
+        )) {
+            fail("unknown threshold", NULL, NULL);
+        }
+    }
+}
+
+/**
+ * Read a register from an input.
+ *
+ * Arguments:
+ * - in: The input.
+ *
+ * Return: The register.
+ */
+static bigint_st *next_register(input_st *in)
+{
+    return registers[next_byte(in) % REGISTERS];
+}
+
+/**
+ * Get the number of hexadecimal numerals in the magnitude of a value.
+ *
+ * Arguments:
+ * - x: The value.
+ *
+ * Return: The number of numerals.
+ */
+static size_t numerals(bigint_st *x)
+{
+    // The size includes the "0x" prefix and, for negative values, the sign.
+    return bigint_sizeinbase(x, 16) - 2 - bigint_ltz(x);
+}
+
+/**
+ * Create a value that is a small integer.
+ *
+ * Arguments:
+ * - value: The integer.
+ *
+ * Return: The value, which is freed when the operation finishes.
+ */
+static bigint_st *small(intmax_t value)
+{
+    return keep(bigint_from_int(value));
+}
+
+/**
+ * Compute two raised to a power.
+ *
+ * Arguments:
+ * - exponent: The power.
+ *
+ * Return: The value, which is freed when the operation finishes.
+ */
+static bigint_st *power_of_2(size_t exponent)
+{
+    return keep(bigint_shli(NULL, small(1), exponent));
+}
+
+#ifdef USE_GMP
+/**
+ * Convert a big integer to a GMP integer.
+ *
+ * Arguments:
+ * - out: An initialized GMP integer.
+ * - x: The big integer.
+ */
+static void to_mpz(mpz_t out, bigint_st *x)
+{
+    char *text = bigint_tostrb(x, 16);
+
+    if (!text || mpz_set_str(out, text, 0)) {
+        fail("cannot convert to GMP", x, NULL);
+    }
+
+    free(text);
+}
+
+/**
+ * Fail unless a big integer is equal to a GMP integer.
+ *
+ * Arguments:
+ * - expected: The GMP integer.
+ * - actual: The big integer.
+ */
+static void expect_mpz(mpz_t expected, bigint_st *actual)
+{
+    bigint_st *value;
+    char *text = mpz_get_str(NULL, 16, expected);
+
+    if (!text) {
+        fail("cannot convert from GMP", NULL, actual);
+    }
+
+    value = keep(bigint_strtobib(text, 16));
+    free(text);
+    expect_equal(value, actual, "GMP");
+}
+
+/**
+ * Check the result of a binary GMP operation.
+ *
+ * Arguments:
+ * - operation: The GMP function.
+ * - a: First operand.
+ * - b: Second operand.
+ * - actual: The result of the library.
+ */
+static void check_mpz(
+    void (*operation)(mpz_ptr, mpz_srcptr, mpz_srcptr),
+    bigint_st *a,
+    bigint_st *b,
+    bigint_st *actual
+)
+{
+    mpz_t x;
+    mpz_t y;
+    mpz_t z;
+
+    mpz_inits(x, y, z, NULL);
+    to_mpz(x, a);
+    to_mpz(y, b);
+    operation(z, x, y);
+    expect_mpz(z, actual);
+    mpz_clears(x, y, z, NULL);
+}
+#endif
+
+/**
+ * Load a value into a register. The first byte selects the kind of value and
+ * its sign, the second its length, and the rest are its bytes. Besides
+ * arbitrary bytes, the kinds include runs of set bits and powers of two
+ * which exercise carries and borrows across every digit.
+ */
+static void op_load(input_st *in)
+{
+    char text[2 * MAX_LOAD_BYTES + 3];
+
+    size_t length = 0;
+    bigint_st *x = next_register(in);
+    uint8_t kind = next_byte(in);
+    size_t bytes = 1 + next_byte(in) % MAX_LOAD_BYTES;
+
+    if (kind & 1) {
+        text[length++] = '-';
+    }
+
+    for (size_t i = 0; i < bytes; i++) {
+        uint8_t byte;
+
+        switch (kind >> 1 & 3) {
+          case 0:
+            byte = next_byte(in);
+            break;
+
+          case 1:
+            byte = 0xff;
+            break;
+
+          case 2:
+            byte = i ? 0 : 1;
+            break;
+
+          default:
+            byte = i ? next_byte(in) & 0x81 : 0x80;
+        }
+
+        length += (size_t) sprintf(text + length, "%02x", byte);
+    }
+
+    expect(!bigint_mov(x, keep(bigint_strtobib(text, 16))), "bigint_mov");
+}
+
+/**
+ * Compute a binary operation once with the simplest algorithms, once into a
+ * new destination and once into a register that may be one of the operands,
+ * and check that the results match.
+ *
+ * Arguments:
+ * - in: The input.
+ * - operation: The operation.
+ * - a: Output pointer for a copy of the first operand.
+ * - b: Output pointer for a copy of the second operand.
+ *
+ * Return: The result of the operation, which is freed when the operation
+ * finishes. The destination register holds the same value.
+ */
+static bigint_st *binary(
+    input_st *in,
+    bigint_st *(*operation)(bigint_st *, bigint_st *, bigint_st *),
+    bigint_st **a,
+    bigint_st **b
+)
+{
+    bigint_st *actual;
+    bigint_st *expected;
+
+    bigint_st *dest = next_register(in);
+    bigint_st *x = next_register(in);
+    bigint_st *y = next_register(in);
+
+    // The destination may be one of the operands, so the checks that follow
+    // use copies.
+    operands[0] = *a = keep(bigint_dup(x));
+    operands[1] = *b = keep(bigint_dup(y));
+
+    use_reference(true);
+    expected = keep(operation(NULL, *a, *b));
+    use_reference(false);
+    actual = keep(operation(NULL, *a, *b));
+    expect_equal(expected, actual, "reference");
+
+    if (operation(dest, x, y) != dest) {
+        fail("wrong destination", NULL, NULL);
+    }
+
+    expect_equal(expected, dest, "aliased destination");
+    return expected;
+}
+
+static void op_add(input_st *in)
+{
+    bigint_st *a;
+    bigint_st *b;
+    bigint_st *sum = binary(in, bigint_add, &a, &b);
+
+    expect_equal(a, keep(bigint_sub(NULL, sum, b)), "(a + b) - b");
+#ifdef USE_GMP
+    check_mpz(mpz_add, a, b, sum);
+#endif
+}
+
+static void op_sub(input_st *in)
+{
+    bigint_st *a;
+    bigint_st *b;
+    bigint_st *difference = binary(in, bigint_sub, &a, &b);
+
+    expect_equal(a, keep(bigint_add(NULL, difference, b)), "(a - b) + b");
+#ifdef USE_GMP
+    check_mpz(mpz_sub, a, b, difference);
+#endif
+}
+
+static void op_mul(input_st *in)
+{
+    bigint_st *a;
+    bigint_st *b;
+    bigint_st *product;
+
+    bigint_st *remainder = NULL;
+    input_st peek = *in;
+
+    next_byte(&peek);
+
+    if (
+        numerals(registers[next_byte(&peek) % REGISTERS]) +
+        numerals(registers[next_byte(&peek) % REGISTERS]) > MAX_RESULT_NUMERALS
+    ) {
+        *in = peek;
+        return;
+    }
+
+    product = binary(in, bigint_mul, &a, &b);
+
+    if (bigint_nez(b)) {
+        expect_equal(
+            a, keep(bigint_div(NULL, &remainder, product, b)), "(a * b) / b"
+        );
+        keep(remainder);
+        expect(bigint_eqz(remainder), "(a * b) % b");
+    }
+
+#ifdef USE_GMP
+    check_mpz(mpz_mul, a, b, product);
+#endif
+}
+
+/**
+ * Add the product of two registers to a third or subtract it, with the
+ * variants that take big integers or an unsigned integer built from the
+ * input. The destination may be one of the operands. The result must equal
+ * the separately computed product added to or subtracted from the original
+ * value.
+ */
+static void op_addmul(input_st *in)
+{
+    bigint_st *expected;
+    bigint_st *product;
+    bigint_st *y;
+
+    uintmax_t word = 0;
+    unsigned variant = next_byte(in) % 4;
+    bigint_st *dest = next_register(in);
+    bigint_st *x = next_register(in);
+    bigint_st *original = keep(bigint_dup(dest));
+
+    if (variant < 2) {
+        y = next_register(in);
+    } else {
+        for (size_t i = 0; i < sizeof(word); i++) {
+            word = word << 8 | next_byte(in);
+        }
+
+        y = keep(bigint_from_uint(word));
+    }
+
+    if (numerals(x) + numerals(y) > MAX_RESULT_NUMERALS) {
+        return;
+    }
+
+    operands[0] = keep(bigint_dup(x));
+    operands[1] = keep(bigint_dup(y));
+    product = keep(bigint_mul(NULL, x, y));
+    expected = keep(
+        variant % 2 ?
+        bigint_sub(NULL, original, product) :
+        bigint_add(NULL, original, product)
+    );
+
+    switch (variant) {
+      case 0:
+        expect(bigint_addmul(dest, x, y) == dest, "bigint_addmul");
+        break;
+
+      case 1:
+        expect(bigint_submul(dest, x, y) == dest, "bigint_submul");
+        break;
+
+      case 2:
+        expect(bigint_addmului(dest, x, word) == dest, "bigint_addmului");
+        break;
+
+      case 3:
+        expect(bigint_submului(dest, x, word) == dest, "bigint_submului");
+        break;
+    }
+
+    expect_equal(expected, dest, "accumulated product");
+}
+
+/**
+ * Divide one register by another and check the quotient, the remainder and
+ * "bigint_mod". Division by zero must fail with `EDOM`.
+ */
+static void op_div(input_st *in)
+{
+    bigint_st *expected_q;
+    bigint_st *q;
+
+    bigint_st *expected_r = NULL;
+    bigint_st *r = NULL;
+    bigint_st *dest_q = next_register(in);
+    bigint_st *dest_r = next_register(in);
+    bigint_st *n = operands[0] = next_register(in);
+    bigint_st *d = operands[1] = next_register(in);
+
+    if (bigint_eqz(d)) {
+        errno = 0;
+        expect(!bigint_div(NULL, NULL, n, d) && errno == EDOM, "n / 0");
+        errno = 0;
+        expect(!bigint_mod(NULL, n, d) && errno == EDOM, "n % 0");
+        return;
+    }
+
+    use_reference(true);
+    expected_q = keep(bigint_div(NULL, &expected_r, n, d));
+    keep(expected_r);
+    use_reference(false);
+    q = keep(bigint_div(NULL, &r, n, d));
+    keep(r);
+    expect_equal(expected_q, q, "reference quotient");
+    expect_equal(expected_r, r, "reference remainder");
+
+    expect_equal(
+        n, keep(bigint_add(NULL, keep(bigint_mul(NULL, q, d)), r)), "q * d + r"
+    );
+    expect(
+        bigint_cmp(keep(bigint_abs(NULL, r)), keep(bigint_abs(NULL, d))) < 0,
+        "|r| < |d|"
+    );
+    expect(bigint_eqz(r) || bigint_ltz(r) == bigint_ltz(n), "sign of r");
+    expect_equal(r, keep(bigint_mod(NULL, n, d)), "n % d");
+
+#ifdef USE_GMP
+    check_mpz(mpz_tdiv_q, n, d, q);
+    check_mpz(mpz_tdiv_r, n, d, r);
+#endif
+
+    // The quotient and the remainder may be written to the operands, but not
+    // to the same register.
+    if (dest_q == dest_r) {
+        expect_equal(r, bigint_mod(dest_r, n, d), "aliased remainder");
+    } else if (bigint_div(dest_q, &dest_r, n, d) != dest_q) {
+        fail("wrong destination", NULL, NULL);
+    } else {
+        expect_equal(q, dest_q, "aliased quotient");
+        expect_equal(r, dest_r, "aliased remainder");
+    }
+}
+
+/**
+ * Divide one register by another with "bigint_divmod" in a rounding mode
+ * chosen by the input, writing both outputs or only one of them to
+ * registers that may be the operands. The results must match the truncated
+ * quotient and remainder moved by one step where the mode rounds the other
+ * way.
+ */
+static void op_divmod(input_st *in)
+{
+    bool adjust;
+    bigint_st *q;
+
+    bigint_round_tt rounding = next_byte(in) % 4;
+    unsigned outputs = next_byte(in) % 3;
+    bigint_st *dest_q = next_register(in);
+    bigint_st *dest_r = next_register(in);
+    bigint_st *x = next_register(in);
+    bigint_st *y = next_register(in);
+    bigint_st *n = operands[0] = keep(bigint_dup(x));
+    bigint_st *d = operands[1] = keep(bigint_dup(y));
+    bigint_st *r = NULL;
+
+    if (bigint_eqz(d)) {
+        errno = 0;
+        expect(
+            bigint_divmod(dest_q, NULL, x, y, rounding) && errno == EDOM,
+            "bigint_divmod by 0"
+        );
+        return;
+    }
+
+    q = keep(bigint_div(NULL, &r, n, d));
+    keep(r);
+
+    switch (rounding) {
+      case BIGINT_ROUND_FLOOR:
+        adjust = bigint_ltz(n) != bigint_ltz(d);
+        break;
+
+      case BIGINT_ROUND_CEIL:
+        adjust = bigint_ltz(n) == bigint_ltz(d);
+        break;
+
+      case BIGINT_ROUND_EUCLID:
+        adjust = bigint_ltz(n);
+        break;
+
+      default:
+        adjust = false;
+        break;
+    }
+
+    if (adjust && bigint_nez(r)) {
+        if (bigint_ltz(n) == bigint_ltz(d)) {
+            expect(!bigint_inc(q) && bigint_sub(r, r, d), "q + 1, r - d");
+        } else {
+            expect(!bigint_dec(q) && bigint_add(r, r, d), "q - 1, r + d");
+        }
+    }
+
+#ifdef USE_GMP
+    if (rounding == BIGINT_ROUND_FLOOR) {
+        check_mpz(mpz_fdiv_q, n, d, q);
+        check_mpz(mpz_fdiv_r, n, d, r);
+    } else if (rounding == BIGINT_ROUND_CEIL) {
+        check_mpz(mpz_cdiv_q, n, d, q);
+        check_mpz(mpz_cdiv_r, n, d, r);
+    }
+#endif
+
+    // The outputs must not be the same register.
+    if (dest_q == dest_r && outputs == 0) {
+        outputs = 1;
+    }
+
+    expect(
+        !bigint_divmod(
+            outputs == 2 ? NULL : dest_q, outputs == 1 ? NULL : dest_r, x, y,
+            rounding
+        ),
+        "bigint_divmod"
+    );
+
+    if (outputs != 2) {
+        expect_equal(q, dest_q, "rounded quotient");
+    }
+
+    if (outputs != 1) {
+        expect_equal(r, dest_r, "rounded remainder");
+    }
+}
+
+/**
+ * Multiply two registers and divide the product by one of them with
+ * "bigint_divexact", or by a word from the input with "bigint_divexactui",
+ * writing the quotient to a register that may be the product. Division by
+ * zero must fail with `EDOM`.
+ */
+static void op_divexact(input_st *in)
+{
+    bigint_st *b;
+    bigint_st *n;
+    bigint_st *x;
+    bigint_st *y;
+
+    uintmax_t word = 0;
+    bool variant = next_byte(in) % 2;
+    bigint_st *dest = next_register(in);
+    bigint_st *a = next_register(in);
+
+    if (!variant) {
+        b = next_register(in);
+    } else {
+        for (size_t i = 0; i < sizeof(word); i++) {
+            word = word << 8 | next_byte(in);
+        }
+
+        b = keep(bigint_from_uint(word));
+    }
+
+    if (numerals(a) + numerals(b) > MAX_RESULT_NUMERALS) {
+        return;
+    }
+
+    if (bigint_eqz(b)) {
+        errno = 0;
+        expect(!bigint_divexact(NULL, a, b) && errno == EDOM, "divexact by 0");
+        return;
+    }
+
+    x = operands[0] = keep(bigint_dup(a));
+    y = operands[1] = keep(bigint_dup(b));
+
+    // The product is left in the destination unless that is the divisor.
+    n = dest == b ? keep(bigint_from_int(0)) : dest;
+    expect(bigint_mul(n, x, y) == n, "product");
+
+    if (variant) {
+        expect(bigint_divexactui(dest, n, word) == dest, "bigint_divexactui");
+    } else {
+        expect(bigint_divexact(dest, n, b) == dest, "bigint_divexact");
+    }
+
+    expect_equal(x, dest, "exact quotient");
+}
+
+/**
+ * Raise a register to a small power and compare the result with repeated
+ * multiplication.
+ */
+static void op_pow(input_st *in)
+{
+    bigint_st *actual;
+    bigint_st *expected;
+
+    bigint_st *dest = next_register(in);
+    bigint_st *base = operands[0] = next_register(in);
+    unsigned exponent = next_byte(in) % 24;
+
+    while (exponent && numerals(base) * exponent > MAX_RESULT_NUMERALS) {
+        exponent /= 2;
+    }
+
+    operands[1] = small(exponent);
+    expected = small(1);
+
+    for (unsigned i = 0; i < exponent; i++) {
+        expected = keep(bigint_mul(NULL, expected, base));
+    }
+
+    actual = keep(bigint_pow(NULL, base, operands[1]));
+    expect_equal(expected, actual, "repeated multiplication");
+    errno = 0;
+    expect(
+        !bigint_pow(NULL, base, small(-1)) && errno == EDOM, "negative exponent"
+    );
+
+#ifdef USE_GMP
+    mpz_t x;
+
+    mpz_init(x);
+    to_mpz(x, base);
+    mpz_pow_ui(x, x, exponent);
+    expect_mpz(x, actual);
+    mpz_clear(x);
+#endif
+
+    if (bigint_pow(dest, base, operands[1]) != dest) {
+        fail("wrong destination", NULL, NULL);
+    }
+
+    expect_equal(expected, dest, "aliased destination");
+}
+
+static void op_gcd(input_st *in)
+{
+    bigint_st *a;
+    bigint_st *b;
+    bigint_st *gcd = binary(in, bigint_gcd, &a, &b);
+
+    expect(bigint_gez(gcd), "gcd >= 0");
+
+    if (bigint_eqz(gcd)) {
+        expect(bigint_eqz(a) && bigint_eqz(b), "gcd(a, b) = 0");
+    } else {
+        expect(bigint_eqz(keep(bigint_mod(NULL, a, gcd))), "a % gcd");
+        expect(bigint_eqz(keep(bigint_mod(NULL, b, gcd))), "b % gcd");
+        expect_equal(
+            small(1),
+            keep(bigint_gcd(
+                NULL,
+                keep(bigint_div(NULL, NULL, a, gcd)),
+                keep(bigint_div(NULL, NULL, b, gcd))
+            )),
+            "gcd(a / gcd, b / gcd)"
+        );
+    }
+
+#ifdef USE_GMP
+    check_mpz(mpz_gcd, a, b, gcd);
+#endif
+}
+
+/**
+ * Shift a register left and right. A left shift must equal multiplying by a
+ * power of two, and a right shift must equal dividing by one, which rounds
+ * toward zero.
+ */
+static void op_shift(input_st *in)
+{
+    bigint_st *left;
+    bigint_st *right;
+
+    bigint_st *dest = next_register(in);
+    bigint_st *x = operands[0] = next_register(in);
+    size_t bits = next_byte(in);
+
+    // Shifts of whole digits follow a different path than partial ones.
+    bits += (size_t) (next_byte(in) % 4) * DIGIT_WIDTH;
+    operands[1] = small((intmax_t) bits);
+
+    if (numerals(x) + bits / 4 > MAX_RESULT_NUMERALS) {
+        return;
+    }
+
+    left = keep(bigint_shli(NULL, x, bits));
+    expect_equal(
+        keep(bigint_mul(NULL, x, power_of_2(bits))), left, "x << n = x * 2^n"
+    );
+    right = keep(bigint_shri(NULL, x, bits));
+    expect_equal(
+        keep(bigint_div(NULL, NULL, x, power_of_2(bits))), right,
+        "x >> n = x / 2^n"
+    );
+    expect_equal(x, keep(bigint_shri(NULL, left, bits)), "(x << n) >> n");
+
+#ifdef USE_GMP
+    mpz_t z;
+
+    mpz_init(z);
+    to_mpz(z, x);
+    mpz_mul_2exp(z, z, bits);
+    expect_mpz(z, left);
+    to_mpz(z, x);
+    mpz_tdiv_q_2exp(z, z, bits);
+    expect_mpz(z, right);
+    mpz_clear(z);
+#endif
+
+    errno = 0;
+    expect(
+        !bigint_shl(NULL, x, small(-1)) && errno == EDOM, "negative left shift"
+    );
+    errno = 0;
+    expect(
+        !bigint_shr(NULL, x, small(-1)) && errno == EDOM,
+        "negative right shift"
+    );
+
+    switch (next_byte(in) % 4) {
+      case 0:
+        expect_equal(left, bigint_shli(dest, x, bits), "aliased left shift");
+        break;
+
+      case 1:
+        expect_equal(right, bigint_shri(dest, x, bits), "aliased right shift");
+        break;
+
+      case 2:
+        expect_equal(left, bigint_shl(dest, x, operands[1]), "bigint_shl");
+        break;
+
+      case 3:
+        expect_equal(right, bigint_shr(dest, x, operands[1]), "bigint_shr");
+        break;
+    }
+}
+
+/**
+ * Increment or decrement a register in place.
+ */
+static void op_step(input_st *in)
+{
+    bigint_st *expected;
+
+    bigint_st *x = operands[0] = next_register(in);
+    bool increment = next_byte(in) & 1;
+
+    operands[1] = NULL;
+
+    if (increment) {
+        expected = keep(bigint_add(NULL, x, small(1)));
+        expect(!bigint_inc(x), "bigint_inc");
+    } else {
+        expected = keep(bigint_sub(NULL, x, small(1)));
+        expect(!bigint_dec(x), "bigint_dec");
+    }
+
+    expect_equal(expected, x, increment ? "x + 1" : "x - 1");
+}
+
+/**
+ * Assign a signed or unsigned word from the input to a register.
+ */
+static void op_move(input_st *in)
+{
+    uintmax_t word = 0;
+    bigint_st *dest = next_register(in);
+    bool is_signed = next_byte(in) & 1;
+
+    for (size_t i = 0; i < sizeof(word); i++) {
+        word = word << 8 | next_byte(in);
+    }
+
+    operands[0] = operands[1] = NULL;
+
+    if (is_signed) {
+        bigint_movi(dest, (intmax_t) word);
+        expect_equal(small((intmax_t) word), dest, "bigint_movi");
+        expect(bigint_toi(dest) == (intmax_t) word, "bigint_toi");
+    } else {
+        bigint_movui(dest, word);
+        expect_equal(keep(bigint_from_uint(word)), dest, "bigint_movui");
+        expect(bigint_toui(dest) == word, "bigint_toui");
+    }
+}
+
+/**
+ * Compare two registers with every comparator.
+ */
+static void op_compare(input_st *in)
+{
+    bigint_st *a = operands[0] = next_register(in);
+    bigint_st *b = operands[1] = next_register(in);
+    bigint_st *difference = keep(bigint_sub(NULL, a, b));
+    int cmp = bigint_cmp(a, b);
+
+    expect(
+        (cmp < 0) == bigint_ltz(difference) &&
+        (cmp > 0) == bigint_gtz(difference) &&
+        (cmp == 0) == bigint_eqz(difference),
+        "sign of a - b"
+    );
+    expect(bigint_cmp(b, a) == -cmp, "symmetry");
+    expect(bigint_eqz(a) == !bigint_nez(a), "bigint_nez");
+    expect(bigint_lez(a) == (bigint_ltz(a) || bigint_eqz(a)), "bigint_lez");
+    expect(bigint_gez(a) == !bigint_ltz(a), "bigint_gez");
+    expect(bigint_max(a, b) == (cmp >= 0 ? a : b), "bigint_max");
+    expect(bigint_min(a, b) == (cmp <= 0 ? a : b), "bigint_min");
+    expect(cmp || bigint_hash(a, 1) == bigint_hash(b, 1), "bigint_hash");
+#ifdef USE_GMP
+    mpz_t x;
+    mpz_t y;
+    int gmp_cmp;
+
+    mpz_inits(x, y, NULL);
+    to_mpz(x, a);
+    to_mpz(y, b);
+    gmp_cmp = mpz_cmp(x, y);
+    expect((cmp > 0) - (cmp < 0) == (gmp_cmp > 0) - (gmp_cmp < 0), "GMP");
+    mpz_clears(x, y, NULL);
+#endif
+}
+
+/**
+ * Sort copies of the registers moved by small steps and check that the
+ * result is an ordered permutation of the values in which equal values have
+ * equal hashes.
+ */
+static void op_sort(input_st *in)
+{
+    size_t matches;
+    int steps;
+
+    bigint_st *sorted[SORT_VALUES];
+    bigint_st *values[SORT_VALUES];
+
+    operands[0] = operands[1] = NULL;
+
+    for (size_t i = 0; i < SORT_VALUES; i++) {
+        if (!(values[i] = bigint_dup(registers[i % REGISTERS]))) {
+            fail(strerror(errno), NULL, NULL);
+        }
+
+        for (steps = next_byte(in) % 5 - 2; steps > 0; steps--) {
+            expect(!bigint_inc(values[i]), "bigint_inc");
+        }
+
+        for (; steps < 0; steps++) {
+            expect(!bigint_dec(values[i]), "bigint_dec");
+        }
+    }
+
+    memcpy(sorted, values, sizeof(sorted));
+    expect(!bigint_sort(sorted, SORT_VALUES), "bigint_sort");
+
+    for (size_t i = 0; i < SORT_VALUES; i++) {
+        matches = 0;
+
+        for (size_t j = 0; j < SORT_VALUES; j++) {
+            matches += sorted[j] == values[i];
+        }
+
+        expect(matches == 1, "bigint_sort permutation");
+
+        if (i > 0) {
+            operands[0] = sorted[i - 1];
+            operands[1] = sorted[i];
+            expect(bigint_cmp(sorted[i - 1], sorted[i]) <= 0, "bigint_sort");
+            expect(
+                bigint_cmp(sorted[i - 1], sorted[i]) ||
+                bigint_hash(sorted[i - 1], 0) == bigint_hash(sorted[i], 0),
+                "bigint_hash"
+            );
+        }
+    }
+
+    operands[0] = operands[1] = NULL;
+
+    for (size_t i = 0; i < SORT_VALUES; i++) {
+        bigint_free(values[i]);
+    }
+}
+
+/**
+ * Write a register in a base and parse it back, checking every printing
+ * function and the size queries along the way. The limit of the cache of
+ * powers is chosen by the input, so conversions run with the cache disabled,
+ * evicting values and unconstrained.
+ */
+static void op_convert(input_st *in)
+{
+    char *buf;
+    char *reference;
+    char *right;
+    char *text;
+    size_t bound;
+    size_t length;
+
+    bigint_st *x = operands[0] = next_register(in);
+    unsigned char base = (unsigned char) (2 + next_byte(in) % 61);
+    size_t cache_limit = cache_limits[next_byte(in) % 3];
+
+    operands[1] = NULL;
+    bigint_set_power_cache_limit(cache_limit);
+    expect(bigint_power_cache_usage() <= cache_limit, "power cache limit");
+
+    use_reference(true);
+    reference = bigint_tostrb(x, base);
+    use_reference(false);
+    text = bigint_tostrb(x, base);
+    expect(text && reference && !strcmp(text, reference), "reference print");
+    free(reference);
+
+    length = strlen(text);
+    bound = bigint_sizeinbase_bound(x, base);
+    expect(bigint_sizeinbase(x, base) == length, "bigint_sizeinbase");
+    expect(bound >= length, "bigint_sizeinbase_bound");
+
+    if (!(buf = malloc(bound + 1))) {
+        fail(strerror(errno), NULL, NULL);
+    }
+
+    expect(
+        bigint_snbprint(buf, length + 1, x, base) == (int) length &&
+        !strcmp(buf, text),
+        "bigint_snbprint"
+    );
+    right = bigint_snbprintr(buf, bound + 1, x, base);
+    expect(right && !strcmp(right, text), "bigint_snbprintr");
+    free(buf);
+
+    use_reference(true);
+    expect_equal(x, keep(bigint_strtobib(text, base)), "reference parse");
+    use_reference(false);
+    expect_equal(x, keep(bigint_strtobib(text, base)), "parse");
+    free(text);
+    expect(bigint_power_cache_usage() <= cache_limit, "power cache limit");
+
+#ifdef USE_GMP
+    mpz_t z;
+    char *decimal;
+
+    mpz_init(z);
+    to_mpz(z, x);
+    decimal = mpz_get_str(NULL, 10, z);
+    text = bigint_tostr(x);
+    expect(text && decimal && !strcmp(text, decimal), "GMP decimal");
+    free(text);
+    free(decimal);
+    mpz_clear(z);
+#endif
+}
+
+/**
+ * Parse a register written in scientific notation with a decimal point
+ * placed by the input. The exponent either covers every fractional numeral,
+ * which scales the register by a power of ten, or leaves some unused, which
+ * truncates it and must point the fraction at them when they are not all
+ * zero. The register must also survive a round trip through each prefix
+ * detected by "bigint_strtobi".
+ */
+static void op_scientific(input_st *in)
+{
+    char *buf;
+    const char *digits;
+    bigint_st *expected;
+    bigint_st *power;
+    char *text;
+    size_t length;
+    size_t offset;
+
+    static const unsigned char bases[] = {2, 8, 10, 16};
+    const char *fraction = NULL;
+    bigint_st *remainder = NULL;
+    bigint_st *x = operands[0] = next_register(in);
+    unsigned shift = next_byte(in);
+    unsigned exponent = next_byte(in) % 24;
+    char marker = next_byte(in) & 1 ? 'e' : 'E';
+
+    operands[1] = NULL;
+
+    for (size_t i = 0; i < sizeof(bases); i++) {
+        if (!(text = bigint_tostrb(x, bases[i]))) {
+            fail(strerror(errno), NULL, NULL);
+        }
+
+        expect_equal(x, keep(bigint_strtobi(text)), "bigint_strtobi");
+        free(text);
+    }
+
+    if (!(text = bigint_tostr(x)) || !(buf = malloc(strlen(text) + 8))) {
+        fail(strerror(errno), NULL, NULL);
+    }
+
+    digits = text + bigint_ltz(x);
+    length = strlen(digits);
+    shift %= length + 1;
+    offset = (size_t) sprintf(
+        buf, "%s%.*s.", bigint_ltz(x) ? "-" : "", (int) (length - shift),
+        digits
+    );
+    sprintf(buf + offset, "%s%c%u", digits + length - shift, marker, exponent);
+
+    if (exponent >= shift) {
+        power = keep(bigint_pow(NULL, small(10), small(exponent - shift)));
+        expected = keep(bigint_mul(NULL, x, power));
+    } else {
+        power = keep(bigint_pow(NULL, small(10), small(shift - exponent)));
+        expected = keep(bigint_div(NULL, &remainder, x, power));
+        keep(remainder);
+        offset += exponent;
+    }
+
+    expect_equal(
+        expected, keep(bigint_strtobif(buf, &fraction)), "bigint_strtobif"
+    );
+    expect(
+        exponent < shift && bigint_nez(remainder) ?
+        fraction == buf + offset : !fraction,
+        "unused fraction"
+    );
+    expect_equal(expected, keep(bigint_strtobi(buf)), "bigint_strtobi");
+
+    errno = 0;
+    expect(
+        !bigint_strtobi("1e99999999999999999999999") && errno == ERANGE,
+        "exponent out of range"
+    );
+    free(buf);
+    free(text);
+}
+
+/**
+ * Parse a register from a buffer that is not NUL-terminated and is followed
+ * by a numeral, once with the length of the register and once with a length
+ * chosen by the input. Parsing must stop at the length and agree with the
+ * same prefix parsed as a string.
+ */
+static void op_strntobi(input_st *in)
+{
+    char *buf;
+    char *prefix;
+    bigint_st *parsed;
+    char *text;
+    size_t length;
+
+    const char *end = NULL;
+    bigint_st *x = operands[0] = next_register(in);
+    uint8_t byte = next_byte(in);
+
+    operands[1] = NULL;
+
+    if (!(text = bigint_tostr(x))) {
+        fail(strerror(errno), NULL, NULL);
+    }
+
+    // The numeral that follows the number lies past the length, and the
+    // buffer has no room for a terminator, so reading past the length is
+    // caught by the address sanitizer.
+    length = strlen(text);
+
+    if (!(buf = malloc(length + 1)) || !(prefix = malloc(length + 1))) {
+        fail(strerror(errno), NULL, NULL);
+    }
+
+    memcpy(buf, text, length);
+    buf[length] = '7';
+    expect_equal(
+        x, keep(bigint_strntobi(buf, length, &end)), "bigint_strntobi"
+    );
+    expect(end == buf + length, "end of the number");
+
+    length = 1 + byte % length;
+    memcpy(prefix, buf, length);
+    prefix[length] = '\0';
+    errno = 0;
+    parsed = bigint_strntobi(buf, length, &end);
+
+    if (!strcmp(prefix, "-")) {
+        expect(!parsed && errno == EINVAL && end == buf, "sign alone");
+    } else {
+        expect_equal(keep(bigint_strtobi(prefix)), keep(parsed), "prefix");
+        expect(end == buf + length, "end of the prefix");
+    }
+
+    free(prefix);
+    free(buf);
+    free(text);
+}
+
+/**
+ * Write every register into one buffer with the batch formatter, compare it
+ * with the same values written into a caller's buffer and one at a time, and
+ * parse the buffer back with the batch parser.
+ */
+static void op_batch(input_st *in)
+{
+    bigint_st **parsed;
+    char *buf;
+    char *joined;
+    char *text;
+    size_t count;
+    size_t length;
+    size_t written;
+
+    size_t offset = 0;
+    unsigned threads = 1 + next_byte(in) % 4;
+
+    operands[0] = operands[1] = NULL;
+
+    if (!(joined = bigint_tostrbv(
+        &length, registers, REGISTERS, 10, SEPARATOR, threads
+    ))) {
+        fail(strerror(errno), NULL, NULL);
+    }
+
+    expect(strlen(joined) == length, "length");
+
+    if (!(buf = malloc(length + 1))) {
+        fail(strerror(errno), NULL, NULL);
+    }
+
+    expect(
+        !bigint_snbprintv(
+            buf, length + 1, &written, registers, REGISTERS, 10, SEPARATOR,
+            threads
+        ) && written == length && !strcmp(buf, joined),
+        "bigint_snbprintv"
+    );
+    errno = 0;
+    expect(
+        bigint_snbprintv(
+            buf, length, &written, registers, REGISTERS, 10, SEPARATOR,
+            threads
+        ) && errno == ERANGE && written == length,
+        "bigint_snbprintv with a short buffer"
+    );
+
+    for (size_t i = 0; i < REGISTERS; i++) {
+        text = bigint_tostr(registers[i]);
+        expect(
+            text && !strncmp(joined + offset, text, strlen(text)),
+            "bigint_tostrbv"
+        );
+        expect(
+            bigint_snprint(buf, strlen(text) + 1, registers[i]) ==
+                (int) strlen(text) && !strcmp(buf, text),
+            "bigint_snprint"
+        );
+        expect(
+            bigint_snprint(buf, strlen(text), registers[i]) < 0,
+            "bigint_snprint with a short buffer"
+        );
+        offset += strlen(text) + (i + 1 < REGISTERS);
+        free(text);
+    }
+
+    free(buf);
+
+    parsed = bigint_strntobiv(&count, joined, length, SEPARATOR[0], threads);
+    expect(parsed && count == REGISTERS, "bigint_strntobiv");
+
+    for (size_t i = 0; i < REGISTERS; i++) {
+        expect_equal(registers[i], parsed[i], "bigint_strntobiv");
+    }
+
+    bigint_freev(parsed);
+    free(joined);
+}
+
+/**
+ * Reduce a value modulo a power of two.
+ *
+ * Arguments:
+ * - x: The value.
+ * - bits: The exponent of the modulus.
+ *
+ * Return: The residue from 0 up to but not including the modulus, which is
+ * freed when the operation finishes.
+ */
+static bigint_st *residue(bigint_st *x, size_t bits)
+{
+    bigint_st *modulus = power_of_2(bits);
+    bigint_st *r = keep(bigint_mod(NULL, x, modulus));
+
+    if (bigint_ltz(r) && !bigint_add(r, r, modulus)) {
+        fail(strerror(errno), NULL, NULL);
+    }
+
+    return r;
+}
+
+/**
+ * Store the registers in vectors of arbitrary widths, apply an element-wise
+ * operation to them and check every element against the same operation on
+ * the registers reduced modulo the widths. The second operand of each
+ * element is the register that follows the first.
+ */
+static void op_vector(input_st *in)
+{
+    bigint_vec_st *a;
+    bigint_vec_st *b;
+    int cmp;
+    bigint_vec_st *dest;
+    bigint_st *expected;
+    bigint_st *x;
+    bigint_st *y;
+
+    int results[REGISTERS];
+    int status = 0;
+    unsigned operation = next_byte(in) % 4;
+    size_t a_bits = 1 + next_byte(in) * 2u;
+    size_t b_bits = 1 + next_byte(in) * 2u;
+    size_t dest_bits = 1 + next_byte(in) * 4u;
+    bool aliased = next_byte(in) % 2;
+
+    operands[0] = operands[1] = NULL;
+    a = bigint_vec_new(REGISTERS, a_bits);
+    b = bigint_vec_new(REGISTERS, b_bits);
+    dest = aliased ? a : bigint_vec_new(REGISTERS, dest_bits);
+
+    if (!a || !b || !dest) {
+        fail(strerror(errno), NULL, NULL);
+    }
+
+    for (size_t i = 0; i < REGISTERS; i++) {
+        expect(
+            !bigint_vec_set(a, i, registers[i]) &&
+            !bigint_vec_set(b, i, registers[(i + 1) % REGISTERS]),
+            "bigint_vec_set"
+        );
+        expect_equal(
+            residue(registers[i], a_bits), keep(bigint_vec_get(NULL, a, i)),
+            "bigint_vec_get"
+        );
+    }
+
+    switch (operation) {
+      case 0:
+        status = bigint_vec_add(dest, a, b);
+        break;
+
+      case 1:
+        status = bigint_vec_sub(dest, a, b);
+        break;
+
+      case 2:
+        status = bigint_vec_mul(dest, a, b);
+        break;
+
+      case 3:
+        status = bigint_vec_cmp(results, a, b);
+        break;
+    }
+
+    expect(!status, "vector operation");
+
+    for (size_t i = 0; i < REGISTERS; i++) {
+        x = operands[0] = residue(registers[i], a_bits);
+        y = operands[1] = residue(registers[(i + 1) % REGISTERS], b_bits);
+
+        if (operation == 3) {
+            cmp = bigint_cmp(x, y);
+            expect(
+                (results[i] > 0) == (cmp > 0) && (results[i] < 0) == (cmp < 0),
+                "bigint_vec_cmp"
+            );
+            continue;
+        }
+
+        if (operation == 0) {
+            expected = keep(bigint_add(NULL, x, y));
+        } else if (operation == 1) {
+            expected = keep(bigint_sub(NULL, x, y));
+        } else {
+            expected = keep(bigint_mul(NULL, x, y));
+        }
+
+        expect_equal(
+            residue(expected, bigint_vec_bits(dest)),
+            keep(bigint_vec_get(NULL, dest, i)),
+            "vector element"
+        );
+    }
+
+    if (!aliased) {
+        bigint_vec_free(dest);
+    }
+
+    bigint_vec_free(b);
+    bigint_vec_free(a);
+}
+
+/**
+ * Copy the registers into an array, replace some of its values with other
+ * registers or with values of the same array, and check that every value
+ * still matches the register it was last copied from. The array is then
+ * sorted and compared with the same registers sorted by "bigint_sort", and
+ * its own values are appended to it until it grows.
+ */
+static void op_array(input_st *in)
+{
+    bigint_array_st *array;
+    size_t index;
+    size_t source;
+
+    bigint_st *sorted[REGISTERS];
+    size_t sources[REGISTERS];
+    unsigned steps = next_byte(in) % 8;
+
+    operands[0] = operands[1] = NULL;
+
+    if (!(array = bigint_array_new())) {
+        fail(strerror(errno), NULL, NULL);
+    }
+
+    for (size_t i = 0; i < REGISTERS; i++) {
+        expect(!bigint_array_push(array, registers[i]), "bigint_array_push");
+        sources[i] = i;
+    }
+
+    for (unsigned i = 0; i < steps; i++) {
+        index = next_byte(in) % REGISTERS;
+        source = next_byte(in) % (2 * REGISTERS);
+
+        if (source < REGISTERS) {
+            expect(
+                !bigint_array_set(array, index, registers[source]),
+                "bigint_array_set"
+            );
+            sources[index] = source;
+        } else {
+            source -= REGISTERS;
+            expect(
+                !bigint_array_set(
+                    array, index, bigint_array_get(array, source)
+                ),
+                "bigint_array_set"
+            );
+            sources[index] = sources[source];
+        }
+    }
+
+    expect(bigint_array_count(array) == REGISTERS, "bigint_array_count");
+
+    for (size_t i = 0; i < REGISTERS; i++) {
+        expect_equal(
+            registers[sources[i]], bigint_array_get(array, i),
+            "bigint_array_get"
+        );
+        sorted[i] = registers[sources[i]];
+    }
+
+    expect(!bigint_sort(sorted, REGISTERS), "bigint_sort");
+    expect(!bigint_array_sort(array), "bigint_array_sort");
+
+    for (size_t i = 0; i < REGISTERS; i++) {
+        expect_equal(sorted[i], bigint_array_get(array, i), "sorted array");
+    }
+
+    // Appending values of the array itself grows it while the appended
+    // value is inside it.
+    for (size_t i = REGISTERS; i <= ARRAY_VALUES; i++) {
+        expect(
+            !bigint_array_push(array, bigint_array_get(array, i % REGISTERS)),
+            "bigint_array_push"
+        );
+        expect_equal(
+            sorted[i % REGISTERS], bigint_array_get(array, i),
+            "appended array value"
+        );
+    }
+
+    bigint_array_free(array);
+}
+
+/**
+ * Compute the integer logarithm of a register. The result "r" must satisfy
+ * `base^r <= |x| < base^(r + 1)`. Non-positive values must fail with `EDOM`.
+ */
+static void op_logui(input_st *in)
+{
+    bigint_st *log;
+    uintmax_t r;
+
+    bigint_st *x = operands[0] = next_register(in);
+    uintmax_t base = 2 + next_byte(in) % 35;
+
+    operands[1] = small((intmax_t) base);
+
+    if (bigint_lez(x)) {
+        errno = 0;
+        expect(!bigint_logui(NULL, x, base) && errno == EDOM, "log of x <= 0");
+        return;
+    }
+
+    log = keep(bigint_logui(NULL, x, base));
+    r = bigint_toui(log);
+    expect(
+        bigint_cmp(keep(bigint_pow(NULL, operands[1], log)), x) <= 0,
+        "base^r <= x"
+    );
+    expect(
+        bigint_cmp(
+            keep(bigint_pow(NULL, operands[1], small((intmax_t) r + 1))), x
+        ) > 0,
+        "x < base^(r + 1)"
+    );
+}
+
+/**
+ * Convert a register to standard integers and back when it fits, and to a
+ * double when the conversion is exact. The fraction and exponent from
+ * "bigint_tod_2exp" must match the magnitude of the register, and it must be
+ * a power of two exactly when it is equal to the power of two the exponent
+ * implies.
+ */
+static void op_integer(input_st *in)
+{
+    size_t bits;
+    size_t exponent;
+    double fraction;
+    intmax_t value;
+    uintmax_t unsigned_value;
+
+    bigint_st *x = operands[0] = next_register(in);
+
+    operands[1] = NULL;
+    errno = 0;
+    value = bigint_toi(x);
+
+    if (!errno) {
+        expect_equal(x, small(value), "bigint_toi");
+    }
+
+    errno = 0;
+    unsigned_value = bigint_toui(x);
+
+    if (!errno) {
+        expect_equal(x, keep(bigint_from_uint(unsigned_value)), "bigint_toui");
+    }
+
+    // Every integer of up to 53 bits is exactly representable as a double.
+    if (numerals(x) <= 13) {
+        expect(bigint_tod(x) == (double) value, "bigint_tod");
+        expect_equal(
+            x, keep(bigint_from_double((double) value)), "bigint_from_double"
+        );
+    }
+
+    fraction = bigint_tod_2exp(&exponent, x);
+
+    if (bigint_eqz(x)) {
+        expect(fraction == 0 && exponent == 0, "bigint_tod_2exp of 0");
+        expect(!bigint_is_power_of_2(x), "bigint_is_power_of_2");
+        return;
+    }
+
+    // Rounding the fraction up to 1 carries into the exponent.
+    bits = bigint_sizeinbase(x, 2) - 2 - bigint_ltz(x);
+    expect(
+        fabs(fraction) >= 0.5 && fabs(fraction) < 1 &&
+        (fraction < 0) == bigint_ltz(x) && (
+            exponent == bits || (exponent == bits + 1 && fabs(fraction) == 0.5)
+        ),
+        "bigint_tod_2exp"
+    );
+
+    if (exponent <= 1000) {
+        expect(ldexp(fraction, (int) exponent) == bigint_tod(x), "bigint_tod");
+    }
+
+    expect(
+        bigint_is_power_of_2(x) ==
+        !bigint_cmp(keep(bigint_abs(NULL, x)), power_of_2(bits - 1)),
+        "bigint_is_power_of_2"
+    );
+}
+
+/**
+ * Divide the larger of two registers by the smaller with the outputs
+ * preallocated, so the only memory the division needs is its working space,
+ * and check that it fails with `ENOMEM` once the memory limit leaves no room
+ * for that space. A failed operation must not change the memory usage, and
+ * the same division must succeed once the limit is removed.
+ */
+static void op_memory(input_st *in)
+{
+    bigint_st *d;
+    bigint_st *n;
+    bigint_st *q;
+    bigint_st *r;
+    size_t usage;
+
+    bigint_st *x = next_register(in);
+    bigint_st *y = next_register(in);
+
+    if (bigint_cmp(keep(bigint_abs(NULL, x)), keep(bigint_abs(NULL, y))) < 0) {
+        n = operands[0] = y;
+        d = operands[1] = x;
+    } else {
+        n = operands[0] = x;
+        d = operands[1] = y;
+    }
+
+    if (bigint_eqz(d)) {
+        return;
+    }
+
+    q = keep(bigint_dup(n));
+    r = keep(bigint_dup(n));
+    usage = bigint_memory_usage();
+    bigint_set_memory_limit(usage);
+    errno = 0;
+    expect(
+        bigint_divmod(q, r, n, d, BIGINT_ROUND_TRUNC) && errno == ENOMEM,
+        "bigint_divmod over the limit"
+    );
+    errno = 0;
+    expect(
+        !bigint_mod(r, n, d) && errno == ENOMEM, "bigint_mod over the limit"
+    );
+    expect(bigint_memory_usage() == usage, "bigint_memory_usage");
+    bigint_set_memory_limit(0);
+    expect(
+        !bigint_divmod(q, r, n, d, BIGINT_ROUND_TRUNC),
+        "bigint_divmod without a limit"
+    );
+    expect_equal(keep(bigint_div(NULL, NULL, n, d)), q, "quotient");
+}
+
+/**
+ * Parse decimals with many distinct exponents one at a time under a limit
+ * that only leaves room for a few of their powers, so powers adopted by the
+ * cache must stop counting against it, and check that a batch with a field
+ * that is too large for the limit fails the same way whether or not its
+ * ranges are parsed by helper threads. Every value is freed, so the memory
+ * usage must always return to where it started.
+ */
+static void op_memory_parse(input_st *in)
+{
+    char *buf;
+    char field[32];
+    bigint_st **parsed;
+    bigint_st *x;
+    size_t count;
+    size_t length;
+
+    static const unsigned threads[] = {1, THREADS};
+    size_t usage = bigint_memory_usage();
+    unsigned base = 100 + next_byte(in) * 4u;
+    size_t cache_limit = cache_limits[next_byte(in) % 3];
+
+    operands[0] = operands[1] = NULL;
+    bigint_set_power_cache_limit(cache_limit);
+    bigint_set_memory_limit(usage + 16 * (base + 32));
+
+    for (unsigned i = 0; i < 32; i++) {
+        sprintf(field, "1e%u", base + i);
+        expect((x = bigint_strtobi(field)), field);
+        bigint_free(x);
+        expect(bigint_memory_usage() == usage, "bigint_memory_usage");
+    }
+
+    // The field that is too large is last, so it is in a range of its own
+    // that a helper thread parses when there is more than one.
+    if (!(buf = malloc(BATCH_FIELDS * 2 + sizeof(field)))) {
+        fail(strerror(errno), NULL, NULL);
+    }
+
+    for (size_t i = 0; i < BATCH_FIELDS; i++) {
+        buf[i * 2] = '1';
+        buf[i * 2 + 1] = SEPARATOR[0];
+    }
+
+    length = BATCH_FIELDS * 2;
+    length += (size_t) sprintf(buf + length, "1e3000000");
+    bigint_set_memory_limit(usage + 1024 * 1024);
+
+    for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+        errno = 0;
+        parsed = bigint_strntobiv(
+            &count, buf, length, SEPARATOR[0], threads[i]
+        );
+        expect(
+            !parsed && errno == ENOMEM && count == BATCH_FIELDS,
+            "bigint_strntobiv over the limit"
+        );
+        expect(bigint_memory_usage() == usage, "bigint_memory_usage");
+    }
+
+    bigint_set_memory_limit(0);
+    free(buf);
+}
+
+/**
+ * Record an operation reported to the trace hook.
+ *
+ * Arguments:
+ * - event: The operation.
+ * - context: The "trace_st" that records it.
+ */
+static void trace_hook(const bigint_trace_st *event, void *context)
+{
+    trace_st *trace = context;
+    char *text;
+
+    trace->calls++;
+    trace->event = *event;
+
+    // Operations called by the hook must not be reported.
+    text = bigint_tostr(registers[0]);
+    free(text);
+}
+
+/**
+ * Multiply and exponentiate registers with a trace hook set and check what
+ * it reports. With COLLECT_STATS, the counters of the same operations are
+ * checked as well; otherwise they must be unavailable.
+ */
+static void op_instrument(input_st *in)
+{
+    bigint_st *product;
+    bigint_stats_st stats;
+
+    trace_st trace = {0, {NULL, {0, 0}, 0, 0}};
+    bigint_st *a = operands[0] = next_register(in);
+    bigint_st *b = operands[1] = next_register(in);
+    size_t expected = bigint_nez(a) || bigint_nez(b);
+
+    if (numerals(a) + numerals(b) > MAX_RESULT_NUMERALS) {
+        return;
+    }
+
+    bigint_stats_reset();
+
+    // Only 0 has no digits, so every operation with a non-zero operand is
+    // large enough to be reported.
+    bigint_set_trace(trace_hook, &trace, 1, 0);
+    product = keep(bigint_mul(NULL, a, b));
+    expect(trace.calls == expected, "traced multiplication");
+
+    if (expected) {
+        expect(!strcmp(trace.event.operation, "mul"), "traced operation");
+        expect(trace.event.seconds >= 0, "traced duration");
+        expect(trace.event.result == 0 || bigint_nez(product), "result size");
+    }
+
+    // The exponent is a non-zero operand, and the multiplications done by
+    // the exponentiation are not reported.
+    keep(bigint_pow(NULL, a, small(2)));
+    expect(trace.calls == ++expected, "traced exponentiation");
+    expect(!strcmp(trace.event.operation, "pow"), "traced operation");
+
+    // Neither condition is met or both are disabled.
+    bigint_set_trace(trace_hook, &trace, SIZE_MAX, 1e9);
+    keep(bigint_mul(NULL, a, b));
+    bigint_set_trace(trace_hook, &trace, 0, 0);
+    keep(bigint_mul(NULL, a, b));
+    bigint_set_trace(NULL, NULL, 0, 0);
+    expect(trace.calls == expected, "untraced multiplication");
+
+#ifdef COLLECT_STATS
+    expect(!bigint_stats_get(&stats), "bigint_stats_get");
+    expect(stats.mul.calls >= 3, "counted multiplications");
+    expect(stats.pow.calls == 1, "counted exponentiation");
+    expect(stats.allocations > 0, "counted allocations");
+    bigint_stats_reset();
+    expect(!bigint_stats_get(&stats), "bigint_stats_get");
+    expect(!stats.mul.calls && !stats.allocations, "bigint_stats_reset");
+#else
+    errno = 0;
+    expect(bigint_stats_get(&stats) && errno == ENOTSUP, "bigint_stats_get");
+#endif
+}
+
+/**
+ * Operations selected by the first byte of each instruction.
+ */
+static const operation_st operations[] = {
+    {"load", op_load},
+    {"add", op_add},
+    {"sub", op_sub},
+    {"mul", op_mul},
+    {"addmul", op_addmul},
+    {"div", op_div},
+    {"divmod", op_divmod},
+    {"divexact", op_divexact},
+    {"pow", op_pow},
+    {"gcd", op_gcd},
+    {"shift", op_shift},
+    {"step", op_step},
+    {"move", op_move},
+    {"compare", op_compare},
+    {"sort", op_sort},
+    {"convert", op_convert},
+    {"scientific", op_scientific},
+    {"strntobi", op_strntobi},
+    {"batch", op_batch},
+    {"vector", op_vector},
+    {"array", op_array},
+    {"logui", op_logui},
+    {"integer", op_integer},
+    {"memory", op_memory},
+    {"memory_parse", op_memory_parse},
+    {"instrument", op_instrument},
+};
+
+/**
+ * Run one input. This is the entry point used by libFuzzer.
+ *
+ * Arguments:
+ * - data: The input.
+ * - size: Length of the input.
+ *
+ * Return: 0.
+ */
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    const operation_st *operation;
+
+    input_st in = {data, size};
+    static bool started = false;
+
+    // The threads persist across inputs because starting them for each one
+    // would dominate the time spent on small inputs.
+    if (!started) {
+        if (bigint_set_threads(THREADS)) {
+            fail(strerror(errno), NULL, NULL);
+        }
+
+        started = true;
+    }
+
+    use_reference(false);
+
+    for (size_t i = 0; i < REGISTERS; i++) {
+        if (!(registers[i] = bigint_from_int((intmax_t) i))) {
+            fail(strerror(errno), NULL, NULL);
+        }
+    }
+
+    while (in.size) {
+        operation = &operations[
+            next_byte(&in) % (sizeof(operations) / sizeof(operations[0]))
+        ];
+        current = operation->name;
+        operands[0] = operands[1] = NULL;
+        operation->run(&in);
+        release();
+    }
+
+    for (size_t i = 0; i < REGISTERS; i++) {
+        bigint_free(registers[i]);
+    }
+
+    return 0;
+}
+
+#ifndef LIBFUZZER
+/**
+ * Generate the next value of a xorshift pseudo-random number generator.
+ *
+ * Arguments:
+ * - state: The state of the generator which must not be 0.
+ *
+ * Return: A pseudo-random number.
+ */
+static uint64_t next_random(uint64_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+ * Run the contents of a file as an input.
+ *
+ * Arguments:
+ * - path: Path of the file.
+ *
+ * Return: 0 if the file was run and -1 if it could not be read.
+ */
+static int replay(const char *path)
+{
+    FILE *file;
+    uint8_t *data;
+    long size;
+
+    if (!(file = fopen(path, "rb"))) {
+        return -1;
+    }
+
+    if (
+        fseek(file, 0, SEEK_END) || (size = ftell(file)) < 0 ||
+        fseek(file, 0, SEEK_SET) || !(data = malloc((size_t) size + 1))
+    ) {
+        fclose(file);
+        return -1;
+    }
+
+    if (fread(data, 1, (size_t) size, file) != (size_t) size) {
+        free(data);
+        fclose(file);
+        return -1;
+    }
+
+    fclose(file);
+    LLVMFuzzerTestOneInput(data, (size_t) size);
+    free(data);
+    return 0;
+}
+
+static void usage(FILE *stream, const char *self)
+{
+    fprintf(
+        stream,
+        "Usage: %s [-s SEED] [-n RUNS] [-l MAX_LENGTH] [FILE...]\n"
+        "\n"
+        "Check the library against simpler algorithms, algebraic identities\n"
+        "and, when built with USE_GMP, GMP. Files are replayed as inputs;\n"
+        "without them, pseudo-random inputs are generated.\n"
+        "\n"
+        "  -s SEED        Seed of the generated inputs. Default: 1.\n"
+        "  -n RUNS        Number of generated inputs. Default: 10000.\n"
+        "  -l MAX_LENGTH  Maximum length of an input in bytes. Default: 256.\n",
+        self
+    );
+}
+
+int main(int argc, char **argv)
+{
+    int option;
+    uint8_t *data;
+    uint64_t state;
+
+    uint64_t seed = 1;
+    unsigned long runs = 10000;
+    size_t max_length = 256;
+
+    while ((option = getopt(argc, argv, "hs:n:l:")) != -1) {
+        switch (option) {
+          case 'h':
+            usage(stdout, argv[0]);
+            return 0;
+
+          case 's':
+            seed = strtoull(optarg, NULL, 10);
+            break;
+
+          case 'n':
+            runs = strtoul(optarg, NULL, 10);
+            break;
+
+          case 'l':
+            max_length = strtoul(optarg, NULL, 10);
+            break;
+
+          default:
+            usage(stderr, argv[0]);
+            return 1;
+        }
+    }
+
+    if (bigint_init()) {
+        perror(argv[0]);
+        return 1;
+    }
+
+    if (optind < argc) {
+        for (int i = optind; i < argc; i++) {
+            if (replay(argv[i])) {
+                fprintf(
+                    stderr, "%s: %s: %s\n", argv[0], argv[i], strerror(errno)
+                );
+                return 1;
+            }
+        }
+
+        bigint_cleanup();
+        return 0;
+    }
+
+    if (!(data = malloc(max_length + 1))) {
+        perror(argv[0]);
+        return 1;
+    }
+
+    // The generator state must not be 0, and consecutive seeds should not
+    // produce similar inputs.
+    state = seed * 0x9e3779b97f4a7c15u | 1;
+
+    for (unsigned long run = 0; run < runs; run++) {
+        size_t length = (size_t) (next_random(&state) % (max_length + 1));
+
+        for (size_t i = 0; i < length; i++) {
+            data[i] = (uint8_t) next_random(&state);
+        }
+
+        LLVMFuzzerTestOneInput(data, length);
+    }
+
+    free(data);
+    bigint_cleanup();
+    printf("DIGIT_WIDTH %d: %lu inputs passed\n", DIGIT_WIDTH, runs);
+    return 0;
+}
+#endif
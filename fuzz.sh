@@ -0,0 +1,41 @@
+#!/bin/sh
+# Usage: fuzz.sh [-s SEED] [-n RUNS] [-l MAX_LENGTH] [FILE...]
+#
+# Build the fuzzer once for every digit width and run it with the given
+# options, which are the same as those of "fuzz.c". The fuzzer is compiled
+# with the address and undefined behavior sanitizers, COLLECT_STATS and a
+# small BATCH_RANGE_MIN so that small batches are split between threads, and
+# when GMP can be linked, it is checked against GMP. The compiler and its
+# flags can be changed with CC and CFLAGS, and setting GMP to 0 disables the
+# GMP checks.
+set -eu
+
+cd "$(dirname "$0")"
+
+CC="${CC:-cc}"
+CFLAGS="${CFLAGS:--O1 -g -fsanitize=address,undefined}"
+
+workspace="$(mktemp -d)"
+trap 'rm -rf "$workspace"' EXIT
+
+gmp=
+if [ "${GMP:-1}" != 0 ]; then
+    echo '#include <gmp.h>
+int main(void) { mpz_t x; mpz_init(x); mpz_clear(x); return 0; }' \
+        > "$workspace/gmp.c"
+
+    if $CC -o "$workspace/gmp" "$workspace/gmp.c" -lgmp 2>/dev/null; then
+        gmp="-DUSE_GMP -lgmp"
+    fi
+fi
+
+for width in 8 16 32 64; do
+    # The GMP flags are deliberately split into words.
+    $CC $CFLAGS -std=c11 -DDIGIT_WIDTH="$width" -DCOLLECT_STATS \
+        -DBATCH_RANGE_MIN=64 \
+        -o "$workspace/fuzz$width" fuzz.c bigint.c -pthread -lm $gmp
+done
+
+for width in 8 16 32 64; do
+    "$workspace/fuzz$width" "$@"
+done
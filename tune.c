@@ -0,0 +1,505 @@
+/**
+ * Measure the crossover points between the algorithms the library chooses
+ * from based on operand size, and write them as a header that can be used to
+ * build the library with thresholds that suit the machine. The header only
+ * applies to the digit width this program was compiled with; "tune.sh"
+ * builds and runs it for every supported width.
+ *
+ * Each threshold is found by timing the same input with the threshold set to
+ * the size of the input, which selects the simpler algorithm, and to one less
+ * than that, which applies the more complex algorithm once before falling
+ * back to the simpler one. The threshold is placed just below the first size
+ * at which the more complex algorithm wins several times in a row. Each
+ * threshold is set to its measured value before the next one is measured,
+ * and every threshold is searched over a range of sizes around its default,
+ * so the number-theoretic transform and the thresholds that hand work to
+ * other threads are measured at the millions of bits where they apply. The
+ * thresholds that use other threads are only measured when more than one
+ * thread is available.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bigint.h"
+
+/**
+ * Number of consecutive sizes at which the more complex algorithm must be
+ * faster before the crossover is accepted.
+ */
+#define CONSECUTIVE_WINS 3
+
+/**
+ * Number of trials of each measurement. The fastest trial is used.
+ */
+#define TRIALS 5
+
+/**
+ * An input used to time one size.
+ */
+typedef struct {
+    /**
+     * A value with the number of digits being measured.
+     */
+    bigint_st *value;
+    /**
+     * Decimal numerals that fill the number of digits being measured when
+     * they are parsed.
+     */
+    char *decimal;
+} sample_st;
+
+/**
+ * A threshold to measure.
+ */
+typedef struct {
+    /**
+     * Name passed to "bigint_set_threshold".
+     */
+    const char *name;
+    /**
+     * Name of the macro that sets the default value of the threshold when
+     * the library is built.
+     */
+    const char *macro;
+    /**
+     * Function that performs the operation that depends on the threshold
+     * once. It returns 0 if the operation succeeds and -1 otherwise.
+     */
+    int (*run)(sample_st *);
+    /**
+     * Size in bits at which the search starts.
+     */
+    size_t min_bits;
+    /**
+     * Size in bits at which the search stops unless a smaller limit is given
+     * on the command line.
+     */
+    size_t max_bits;
+    /**
+     * Value indicating whether the threshold hands work to other threads,
+     * so it is only measured when more than one thread is available.
+     */
+    bool parallel;
+} tunable_st;
+
+static int run_parse(sample_st *sample)
+{
+    bigint_st *x = bigint_strtobi(sample->decimal);
+
+    if (!x) {
+        return -1;
+    }
+
+    bigint_free(x);
+    return 0;
+}
+
+static int run_print(sample_st *sample)
+{
+    char *str = bigint_tostr(sample->value);
+
+    if (!str) {
+        return -1;
+    }
+
+    free(str);
+    return 0;
+}
+
+static int run_convert(sample_st *sample)
+{
+    return run_parse(sample) || run_print(sample) ? -1 : 0;
+}
+
+static int run_mul(sample_st *sample)
+{
+    bigint_st *x = bigint_mul(NULL, sample->value, sample->value);
+
+    if (!x) {
+        return -1;
+    }
+
+    bigint_free(x);
+    return 0;
+}
+
+/**
+ * Thresholds in the order they are measured.
+ */
+static const tunable_st tunables[] = {
+    {
+        "parse_dc", "PARSE_DC_THRESHOLD", run_parse,
+        2 * DIGIT_WIDTH, 1024 * DIGIT_WIDTH, false
+    },
+    {
+        "print_dc", "PRINT_DC_THRESHOLD", run_print,
+        2 * DIGIT_WIDTH, 1024 * DIGIT_WIDTH, false
+    },
+    {
+        "mul_karatsuba", "MUL_KARATSUBA_THRESHOLD", run_mul,
+        2 * DIGIT_WIDTH, 1024 * DIGIT_WIDTH, false
+    },
+    {"mul_ntt", "MUL_NTT_THRESHOLD", run_mul, 4096, 1048576, false},
+    {"mul_parallel", "MUL_PARALLEL_THRESHOLD", run_mul, 8192, 4194304, true},
+    {
+        "convert_parallel", "CONVERT_PARALLEL_THRESHOLD", run_convert,
+        4096, 1048576, true
+    },
+};
+
+/**
+ * Get the value of a monotonic clock.
+ *
+ * Return: The time in seconds.
+ */
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+/**
+ * Generate the next value of a xorshift pseudo-random number generator.
+ *
+ * Arguments:
+ * - state: The state of the generator which must not be 0.
+ *
+ * Return: A pseudo-random number.
+ */
+static uint64_t next_random(uint64_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/**
+ * Get the number of decimal numerals that fit in a single digit, which is the
+ * number of numerals the parser handles as one unit.
+ *
+ * Return: The number of numerals.
+ */
+static size_t decimal_numerals_per_digit(void)
+{
+    size_t count = 1;
+    uint64_t max = DIGIT_WIDTH == 64 ? UINT64_MAX : (1ull << DIGIT_WIDTH) - 1;
+
+    for (uint64_t scale = 10; scale <= max / 10; scale *= 10) {
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * Create a string of pseudo-random numerals without a leading zero.
+ *
+ * Arguments:
+ * - length: The number of numerals.
+ * - alphabet: The numerals to choose from, the first of which is zero.
+ * - state: The state of the pseudo-random number generator.
+ *
+ * Return: The string or NULL if it could not be allocated.
+ */
+static char *random_numerals(
+    size_t length, const char *alphabet, uint64_t *state
+)
+{
+    char *str;
+
+    size_t base = strlen(alphabet);
+
+    if (!(str = malloc(length + 1))) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        str[i] = alphabet[next_random(state) % base];
+    }
+
+    str[0] = alphabet[1 + next_random(state) % (base - 1)];
+    str[length] = '\0';
+    return str;
+}
+
+static void free_sample(sample_st *sample)
+{
+    if (sample->value) {
+        bigint_free(sample->value);
+    }
+
+    free(sample->decimal);
+}
+
+/**
+ * Create the inputs for one size.
+ *
+ * Arguments:
+ * - sample: Output pointer for the inputs.
+ * - digits: The size in digits.
+ * - state: The state of the pseudo-random number generator.
+ *
+ * Return: 0 if the operation succeeds and -1 if it fails.
+ */
+static int make_sample(sample_st *sample, size_t digits, uint64_t *state)
+{
+    char *hex;
+
+    memset(sample, 0, sizeof(*sample));
+
+    if (!(hex = random_numerals(
+        digits * DIGIT_WIDTH / 4, "0123456789abcdef", state
+    ))) {
+        return -1;
+    }
+
+    sample->value = bigint_strtobib(hex, 16);
+    free(hex);
+
+    if (
+        !sample->value ||
+        !(sample->decimal = random_numerals(
+            digits * decimal_numerals_per_digit(), "0123456789", state
+        ))
+    ) {
+        free_sample(sample);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Time an operation. The operation is run in batches that double in size
+ * until each trial takes at least the minimum time.
+ *
+ * Arguments:
+ * - seconds: Output pointer for the time of one call in the fastest trial.
+ * - tunable: The threshold whose operation is timed.
+ * - sample: The input.
+ * - min_time: The minimum time of a trial in seconds.
+ *
+ * Return: 0 if the operation succeeds and -1 if it fails.
+ */
+static int measure(
+    double *seconds,
+    const tunable_st *tunable,
+    sample_st *sample,
+    double min_time
+)
+{
+    double elapsed;
+    double start;
+
+    size_t batch = 1;
+
+    *seconds = -1;
+
+    // The first call fills the cache of powers the operation needs.
+    if (tunable->run(sample)) {
+        return -1;
+    }
+
+    for (int trial = 0; trial < TRIALS; trial++) {
+        while (1) {
+            start = now();
+
+            for (size_t i = 0; i < batch; i++) {
+                if (tunable->run(sample)) {
+                    return -1;
+                }
+            }
+
+            if ((elapsed = now() - start) >= min_time) {
+                break;
+            }
+
+            batch *= 2;
+        }
+
+        if (*seconds < 0 || elapsed / (double) batch < *seconds) {
+            *seconds = elapsed / (double) batch;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Find the crossover point of a threshold and set the threshold to it.
+ *
+ * Arguments:
+ * - result: Output pointer for the measured threshold. If the more complex
+ *   algorithm never wins, this is the largest size that was measured.
+ * - tunable: The threshold.
+ * - max_digits: The largest size in digits to measure or 0 to use the range
+ *   of the threshold.
+ * - min_time: The minimum time of a trial in seconds.
+ * - verbose: Value indicating whether each measurement is written to
+ *   standard error.
+ *
+ * Return: 0 if the operation succeeds and -1 if it fails.
+ */
+static int crossover(
+    size_t *result,
+    const tunable_st *tunable,
+    size_t max_digits,
+    double min_time,
+    bool verbose
+)
+{
+    double simple;
+    double split;
+    sample_st sample;
+
+    size_t first = 0;
+    size_t digits = tunable->min_bits / DIGIT_WIDTH;
+    uint64_t state = 0x9e3779b97f4a7c15u;
+    int wins = 0;
+
+    if (!max_digits || max_digits > tunable->max_bits / DIGIT_WIDTH) {
+        max_digits = tunable->max_bits / DIGIT_WIDTH;
+    }
+
+    digits = digits < 2 ? 2 : digits;
+    *result = max_digits;
+
+    while (digits <= max_digits && wins < CONSECUTIVE_WINS) {
+        if (make_sample(&sample, digits, &state)) {
+            return -1;
+        }
+
+        if (
+            bigint_set_threshold(tunable->name, digits) ||
+            measure(&simple, tunable, &sample, min_time) ||
+            bigint_set_threshold(tunable->name, digits - 1) ||
+            measure(&split, tunable, &sample, min_time)
+        ) {
+            free_sample(&sample);
+            return -1;
+        }
+
+        free_sample(&sample);
+
+        if (verbose) {
+            fprintf(
+                stderr, "%s: %zu digits: %.0f ns simple, %.0f ns split\n",
+                tunable->name, digits, simple * 1e9, split * 1e9
+            );
+        }
+
+        if (split >= simple) {
+            wins = 0;
+        } else if (wins++ == 0) {
+            first = digits;
+        }
+
+        digits += digits / 8 ? digits / 8 : 1;
+    }
+
+    if (wins == CONSECUTIVE_WINS) {
+        *result = first - 1;
+    }
+
+    return bigint_set_threshold(tunable->name, *result);
+}
+
+static void usage(FILE *stream, const char *self)
+{
+    fprintf(
+        stream,
+        "Usage: %s [-v] [-m MAX_DIGITS] [-p THREADS] [-t MIN_TIME]\n"
+        "\n"
+        "Measure algorithm thresholds and write them as a C header.\n"
+        "\n"
+        "  -v             Write each measurement to standard error.\n"
+        "  -m MAX_DIGITS  Largest size to measure in digits. Default: 1024\n"
+        "                 for the simpler thresholds and up to a few million\n"
+        "                 bits for the others.\n"
+        "  -p THREADS     Number of threads used by the parallel thresholds.\n"
+        "                 Default: the number of online processors.\n"
+        "  -t MIN_TIME    Minimum seconds per trial. Default: 0.002.\n",
+        self
+    );
+}
+
+int main(int argc, char **argv)
+{
+    int option;
+    size_t value;
+
+    size_t max_digits = 0;
+    double min_time = 0.002;
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned threads = online > 1 ? (unsigned) online : 1;
+    bool verbose = false;
+
+    while ((option = getopt(argc, argv, "hvm:p:t:")) != -1) {
+        switch (option) {
+          case 'h':
+            usage(stdout, argv[0]);
+            return 0;
+
+          case 'v':
+            verbose = true;
+            break;
+
+          case 'm':
+            max_digits = strtoul(optarg, NULL, 10);
+            break;
+
+          case 'p':
+            threads = (unsigned) strtoul(optarg, NULL, 10);
+            break;
+
+          case 't':
+            min_time = strtod(optarg, NULL);
+            break;
+
+          default:
+            usage(stderr, argv[0]);
+            return 1;
+        }
+    }
+
+    if (bigint_init() || bigint_set_threads(threads)) {
+        perror(argv[0]);
+        return 1;
+    }
+
+    printf("#if DIGIT_WIDTH == %d\n", DIGIT_WIDTH);
+
+    for (size_t i = 0; i < sizeof(tunables) / sizeof(tunables[0]); i++) {
+        // Without other threads, the library keeps its defaults.
+        if (tunables[i].parallel && threads < 2) {
+            continue;
+        }
+
+        if (crossover(&value, &tunables[i], max_digits, min_time, verbose)) {
+            fprintf(
+                stderr, "%s: %s: %s\n", argv[0], tunables[i].name,
+                strerror(errno)
+            );
+            return 1;
+        }
+
+        printf("#define %s %zu\n", tunables[i].macro, value);
+        fflush(stdout);
+    }
+
+    puts("#endif");
+    bigint_set_threads(0);
+    bigint_cleanup();
+    return 0;
+}
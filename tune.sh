@@ -0,0 +1,28 @@
+#!/bin/sh
+# Usage: tune.sh [-v] [-m MAX_DIGITS] [-p THREADS] [-t MIN_TIME] > thresholds.h
+#
+# Build the threshold tuner once for every digit width and run it. The
+# thresholds of every width are combined into one header on standard output.
+# A library built with -DTUNED_THRESHOLDS='"thresholds.h"' uses them as its
+# defaults. The options are the same as those of "tune.c". The compiler and
+# its flags can be changed with CC and CFLAGS.
+set -eu
+
+cd "$(dirname "$0")"
+
+CC="${CC:-cc}"
+CFLAGS="${CFLAGS:--O2}"
+
+workspace="$(mktemp -d)"
+trap 'rm -rf "$workspace"' EXIT
+
+for width in 8 16 32 64; do
+    $CC $CFLAGS -std=c11 -DDIGIT_WIDTH="$width" \
+        -o "$workspace/tune$width" tune.c bigint.c -pthread -lm
+done
+
+echo "// Generated by tune.sh. Thresholds are measured in digits."
+
+for width in 8 16 32 64; do
+    "$workspace/tune$width" "$@"
+done